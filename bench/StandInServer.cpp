@@ -0,0 +1,237 @@
+#include "StandInServer.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+const char* const kWords[] = {
+    "engineer", "build", "services", "team", "remote", "python", "c++", "linux",
+    "design", "scale", "data", "platform", "customers", "growth", "cloud", "aws",
+    "docker", "kubernetes", "sql", "react", "testing", "ownership", "latency", "systems"
+};
+
+const std::size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+bool sendAll(int fd, const std::string& data) {
+    std::size_t sent = 0;
+
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+
+        if (n <= 0) {
+            return false;
+        }
+
+        sent += static_cast<std::size_t>(n);
+    }
+
+    return true;
+}
+
+// Page number from "GET /v1/api/jobs/us/search/<page>?... HTTP/1.1".
+int requestedPage(const std::string& request) {
+    std::size_t at = request.find("/search/");
+
+    if (at == std::string::npos) {
+        return 1;
+    }
+
+    return std::atoi(request.c_str() + at + 8);
+}
+
+} // namespace
+
+StandInServer::StandInServer(int last_page, int results_per_page, std::chrono::milliseconds latency)
+    : listen_fd(-1),
+      server_port(0),
+      last_page(last_page),
+      results_per_page(results_per_page),
+      latency(latency),
+      stopping(false),
+      connections_accepted(0),
+      requests_served(0) {}
+
+StandInServer::~StandInServer() {
+    stop();
+}
+
+bool StandInServer::start() {
+    listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+
+    if (listen_fd < 0) {
+        std::cerr << "Stand-in server: socket failed: " << std::strerror(errno) << '\n';
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+
+    socklen_t length = sizeof(address);
+
+    if (::bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listen_fd, 64) != 0 ||
+        ::getsockname(listen_fd, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        std::cerr << "Stand-in server: cannot listen: " << std::strerror(errno) << '\n';
+        ::close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+
+    server_port = ntohs(address.sin_port);
+    acceptor = std::thread([this]() { acceptLoop(); });
+
+    return true;
+}
+
+void StandInServer::stop() {
+    if (stopping.exchange(true)) {
+        return;
+    }
+
+    if (acceptor.joinable()) {
+        acceptor.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex);
+
+        for (int fd : connection_fds) {
+            ::shutdown(fd, SHUT_RDWR);
+        }
+    }
+
+    for (auto& thread : connection_threads) {
+        thread.join();
+    }
+
+    for (int fd : connection_fds) {
+        ::close(fd);
+    }
+
+    if (listen_fd >= 0) {
+        ::close(listen_fd);
+        listen_fd = -1;
+    }
+}
+
+std::string StandInServer::baseUrl() const {
+    return "http://127.0.0.1:" + std::to_string(server_port) + "/v1/api/jobs/us";
+}
+
+void StandInServer::acceptLoop() {
+    pollfd waiting{listen_fd, POLLIN, 0};
+
+    // Polls with a timeout so stop() is noticed without closing the socket
+    // under accept().
+    while (!stopping.load()) {
+        if (::poll(&waiting, 1, 50) <= 0) {
+            continue;
+        }
+
+        int fd = ::accept(listen_fd, nullptr, nullptr);
+
+        if (fd < 0) {
+            continue;
+        }
+
+        connections_accepted++;
+
+        // Without this the tail of a response can sit out the client's
+        // delayed ACK (about 40 ms), which would swamp the latency being
+        // simulated.
+        int no_delay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+
+        std::lock_guard<std::mutex> lock(connections_mutex);
+        connection_fds.push_back(fd);
+        connection_threads.emplace_back([this, fd]() { serve(fd); });
+    }
+}
+
+void StandInServer::serve(int fd) {
+    std::string pending;
+    char buffer[4096];
+
+    while (!stopping.load()) {
+        std::size_t end = pending.find("\r\n\r\n");
+
+        if (end == std::string::npos) {
+            ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+
+            if (n <= 0) {
+                return;
+            }
+
+            pending.append(buffer, static_cast<std::size_t>(n));
+            continue;
+        }
+
+        std::string request = pending.substr(0, end);
+        pending.erase(0, end + 4);
+
+        if (latency.count() > 0) {
+            std::this_thread::sleep_for(latency);
+        }
+
+        int page = requestedPage(request);
+        std::string body = searchPage(page, page > last_page ? 0 : results_per_page);
+
+        std::string response = "HTTP/1.1 200 OK\r\n"
+                               "Content-Type: application/json\r\n"
+                               "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                               "\r\n" + body;
+
+        if (!sendAll(fd, response)) {
+            return;
+        }
+
+        requests_served++;
+    }
+}
+
+std::string StandInServer::searchPage(int page, int results, std::size_t description_words) {
+    std::string body = "{\"count\": 100000, \"mean\": 95000, \"results\": [";
+    std::string p = std::to_string(page);
+
+    for (int i = 0; i < results; i++) {
+        std::string id = p + "-" + std::to_string(i);
+
+        if (i > 0) {
+            body += ',';
+        }
+
+        body += "{\"id\": \"" + id + "\", "
+                "\"title\": \"Senior Software Engineer " + id + "\", "
+                "\"company\": {\"id\": \"c" + std::to_string(i % 97) + "\", \"display_name\": \"Company " + std::to_string(i % 97) + "\", \"__CLASS__\": \"Adzuna::API::Response::Company\"}, "
+                "\"location\": {\"display_name\": \"New York, NY\", \"area\": [\"US\", \"New York\"]}, "
+                "\"salary_min\": " + std::to_string(80000 + (i % 50) * 1000) + ", "
+                "\"salary_max\": " + std::to_string(120000 + (i % 50) * 1000) + ", "
+                "\"category\": {\"label\": \"IT Jobs\", \"tag\": \"it-jobs\"}, "
+                "\"redirect_url\": \"https://www.adzuna.com/land/ad/" + id + "\", "
+                "\"created\": \"2024-03-" + std::string(page % 28 < 9 ? "0" : "") + std::to_string(page % 28 + 1) + "T10:00:00Z\", "
+                "\"description\": \"";
+
+        for (std::size_t w = 0; w < description_words; w++) {
+            body += kWords[(static_cast<std::size_t>(i) * 7 + w * 13 + static_cast<std::size_t>(page)) % kWordCount];
+            body += ' ';
+        }
+
+        body += "\\u2026\"}";
+    }
+
+    return body + "]}";
+}
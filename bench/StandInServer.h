@@ -0,0 +1,67 @@
+#ifndef STANDINSERVER_H
+#define STANDINSERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A local HTTP/1.1 server with keep-alive that answers Adzuna search
+// requests (".../search/<page>?...") with canned pages, so fetch code can be
+// timed and checked without the network. Pages past `last_page` come back
+// with an empty results array; every response waits `latency` first, to
+// stand in for the round trip to the real API.
+class StandInServer {
+private:
+    int listen_fd;
+    int server_port;
+    int last_page;
+    int results_per_page;
+    std::chrono::milliseconds latency;
+
+    std::atomic<bool> stopping;
+    std::atomic<std::size_t> connections_accepted;
+    std::atomic<std::size_t> requests_served;
+
+    std::thread acceptor;
+    std::mutex connections_mutex;
+    std::vector<int> connection_fds;
+    std::vector<std::thread> connection_threads;
+
+    void acceptLoop();
+    void serve(int fd);
+
+public:
+    StandInServer(int last_page,
+                  int results_per_page,
+                  std::chrono::milliseconds latency = std::chrono::milliseconds(0));
+    ~StandInServer();
+
+    StandInServer(const StandInServer&) = delete;
+    StandInServer& operator=(const StandInServer&) = delete;
+
+    // Listens on an ephemeral port of 127.0.0.1.
+    bool start();
+    void stop();
+
+    // The base URL to hand to ApiClient.
+    std::string baseUrl() const;
+
+    std::size_t connectionsAccepted() const {
+        return connections_accepted.load();
+    }
+
+    std::size_t requestsServed() const {
+        return requests_served.load();
+    }
+
+    // Body of search page `page`: `results` jobs whose ids are
+    // "<page>-<index>", each with a description of about
+    // `description_words` words.
+    static std::string searchPage(int page, int results, std::size_t description_words = 60);
+};
+
+#endif
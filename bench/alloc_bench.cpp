@@ -0,0 +1,239 @@
+// Heap allocations per 1k jobs on the parse, store, load and filter paths,
+// counted by replacing the global operator new. Each line compares the
+// copying path with the one that moves jobs or returns positions.
+//
+//   alloc_bench [--smoke] [jobs]
+//
+// --smoke runs a few pages and fails unless the paths agree on their
+// results and the moving / indexing ones allocate no more than the copies.
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "AdzunaResponseParser.h"
+#include "Database.h"
+#include "JobParser.h"
+#include "StandInServer.h"
+
+namespace {
+
+std::atomic<std::size_t> allocations{0};
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+const int kResultsPerPage = 50;
+
+std::vector<std::string> samplePages(int count) {
+    std::vector<std::string> pages;
+
+    for (int first = 0; first < count; first += kResultsPerPage) {
+        int results = count - first < kResultsPerPage ? count - first : kResultsPerPage;
+        pages.push_back(StandInServer::searchPage(first / kResultsPerPage + 1, results));
+    }
+
+    return pages;
+}
+
+// Parses each page into a vector reserved for it, as the fetchers do, and
+// moves the jobs into `jobs`.
+void parsePages(const std::vector<std::string>& pages, std::vector<Job>& jobs) {
+    for (const std::string& body : pages) {
+        std::vector<Job> page_jobs;
+        page_jobs.reserve(kResultsPerPage);
+
+        AdzunaResponseParser parser(page_jobs);
+        parser.feed(body.data(), body.size());
+        parser.finish();
+
+        for (Job& job : page_jobs) {
+            jobs.push_back(std::move(job));
+        }
+    }
+}
+
+void removeDatabase(const std::string& path) {
+    for (const char* suffix : {"", "-wal", "-shm", "-journal"}) {
+        std::error_code ignored;
+        std::filesystem::remove(path + suffix, ignored);
+    }
+}
+
+// A path in the temp directory with no database left over at it.
+std::string databasePath(const char* name) {
+    std::string path = (std::filesystem::temp_directory_path() / name).string();
+    removeDatabase(path);
+    return path;
+}
+
+class AllocationCounter {
+private:
+    std::size_t start;
+    std::size_t jobs;
+
+public:
+    explicit AllocationCounter(std::size_t jobs)
+        : start(allocations.load()), jobs(jobs) {}
+
+    // Allocations since construction, per 1000 jobs.
+    double perThousand() const {
+        return static_cast<double>(allocations.load() - start) * 1000.0 / static_cast<double>(jobs);
+    }
+};
+
+void report(const char* label, double copying, double moving) {
+    std::cout << "  " << std::left << std::setw(40) << label << std::right
+              << std::setw(9) << copying << " -> " << std::setw(7) << moving << '\n';
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool smoke = argc > 1 && std::strcmp(argv[1], "--smoke") == 0;
+    int arg = smoke ? 2 : 1;
+
+    int count = argc > arg ? std::atoi(argv[arg]) : (smoke ? 150 : 1000);
+    std::vector<std::string> pages = samplePages(count);
+
+    std::vector<Job> jobs;
+    jobs.reserve(static_cast<std::size_t>(count));
+
+    AllocationCounter parsing(static_cast<std::size_t>(count));
+    parsePages(pages, jobs);
+    double parse_allocations = parsing.perThousand();
+
+    std::size_t n = jobs.size();
+    bool ok = n == static_cast<std::size_t>(count);
+
+    std::cout << n << " jobs, allocations per 1k jobs\n" << std::fixed << std::setprecision(0);
+    std::cout << "  " << std::left << std::setw(40) << "parse into reserved page vectors:" << std::right
+              << std::setw(9) << parse_allocations << '\n';
+
+    // storeJobs with the cache loaded, so every row also lands in it.
+    std::string copied_path = databasePath("alloc_bench_copied.db");
+    std::string moved_path = databasePath("alloc_bench_moved.db");
+    std::string pending_path = databasePath("alloc_bench_pending.db");
+    double store_copying = 0.0;
+    double store_moving = 0.0;
+
+    {
+        Database db(copied_path);
+        db.loadJobs();
+
+        AllocationCounter counter(n);
+        db.storeJobs(jobs);
+        store_copying = counter.perThousand();
+    }
+
+    {
+        Database db(moved_path);
+        db.loadJobs();
+        std::vector<Job> rows = jobs;
+
+        AllocationCounter counter(n);
+        db.storeJobs(std::move(rows));
+        store_moving = counter.perThousand();
+    }
+
+    report("storeJobs, cache loaded: const& -> &&", store_copying, store_moving);
+
+    // A full reload reads every row; after writes through the same Database
+    // only the new rows are merged into the loaded cache.
+    double full_reload = 0.0;
+    double pending_merge = 0.0;
+    std::size_t reloaded = 0;
+
+    {
+        Database db(copied_path);
+
+        AllocationCounter counter(n);
+        reloaded = db.loadJobs().size();
+        full_reload = counter.perThousand();
+    }
+
+    {
+        Database db(pending_path);
+        db.loadJobs();
+        db.storeJobs(jobs);
+
+        AllocationCounter counter(n);
+        reloaded = reloaded == db.loadJobs().size() ? reloaded : 0;
+        pending_merge = counter.perThousand();
+    }
+
+    report("loadJobs: full reload -> merge pending", full_reload, pending_merge);
+
+    double filter_copying = 0.0;
+    double filter_indexing = 0.0;
+    std::vector<Job> filtered;
+    std::vector<std::size_t> found;
+
+    {
+        AllocationCounter counter(n);
+        filtered = JobParser::filterByTechnology(jobs, "python");
+        filter_copying = counter.perThousand();
+    }
+
+    {
+        AllocationCounter counter(n);
+        found = JobParser::findByTechnology(jobs, "python");
+        filter_indexing = counter.perThousand();
+    }
+
+    report("filterByTechnology -> findByTechnology", filter_copying, filter_indexing);
+
+    if (reloaded != n) {
+        std::cerr << "Reloaded " << reloaded << " of " << n << " rows\n";
+        ok = false;
+    }
+
+    if (filtered.size() != found.size()) {
+        std::cerr << "filterByTechnology and findByTechnology disagree\n";
+        ok = false;
+    } else {
+        for (std::size_t i = 0; i < found.size(); i++) {
+            if (filtered[i].id != jobs[found[i]].id) {
+                std::cerr << "filterByTechnology and findByTechnology disagree\n";
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    if (store_moving > store_copying || pending_merge > full_reload || filter_indexing > filter_copying) {
+        std::cerr << "A moving or indexing path allocated more than its copying one\n";
+        ok = false;
+    }
+
+    for (const std::string& path : {copied_path, moved_path, pending_path}) {
+        removeDatabase(path);
+    }
+
+    return smoke && !ok ? 1 : 0;
+}
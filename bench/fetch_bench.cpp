@@ -0,0 +1,87 @@
+// Wall time of a multi-page search against the local stand-in server,
+// fetched one page after another and with several pages in flight.
+//
+//   fetch_bench [--smoke] [pages] [latency_ms]
+//
+// --smoke runs a small search and fails unless every mode returns the same
+// jobs in page order.
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ApiClient.h"
+#include "StandInServer.h"
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool sameJobs(const std::vector<Job>& a, const std::vector<Job>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < a.size(); i++) {
+        if (a[i].id != b[i].id) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool smoke = argc > 1 && std::strcmp(argv[1], "--smoke") == 0;
+    int arg = smoke ? 2 : 1;
+
+    int pages = argc > arg ? std::atoi(argv[arg]) : (smoke ? 6 : 40);
+    int latency_ms = argc > arg + 1 ? std::atoi(argv[arg + 1]) : (smoke ? 5 : 30);
+    int results_per_page = smoke ? 5 : 50;
+
+    // One page past the last full one comes back empty and ends the search.
+    StandInServer server(pages, results_per_page, std::chrono::milliseconds(latency_ms));
+
+    if (!server.start()) {
+        return 1;
+    }
+
+    ApiClient client("bench", "bench", server.baseUrl());
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Job> sequential = client.fetchFromAdzuna("engineer", "", results_per_page, 0.0, pages + 1);
+    double sequential_seconds = secondsSince(start);
+
+    std::cout << pages << " pages of " << results_per_page << " jobs, "
+              << latency_ms << " ms server latency\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  sequential:      " << sequential_seconds << " s, " << sequential.size() << " jobs\n";
+
+    bool ok = sequential.size() == static_cast<std::size_t>(pages * results_per_page);
+
+    for (int in_flight : {2, 4, 8, 16}) {
+        start = std::chrono::steady_clock::now();
+        std::vector<Job> concurrent = client.fetchFromAdzunaConcurrent("engineer", "", results_per_page, 0.0,
+                                                                       pages + 1, in_flight);
+        double seconds = secondsSince(start);
+
+        std::cout << "  " << std::setw(2) << in_flight << " in flight:    " << seconds << " s, "
+                  << concurrent.size() << " jobs, " << std::setprecision(1)
+                  << sequential_seconds / seconds << "x\n" << std::setprecision(3);
+
+        if (!sameJobs(sequential, concurrent)) {
+            std::cerr << "Concurrent fetch with " << in_flight << " in flight returned different jobs\n";
+            ok = false;
+        }
+    }
+
+    return smoke && !ok ? 1 : 0;
+}
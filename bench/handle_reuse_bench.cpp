@@ -0,0 +1,112 @@
+// Per-request latency of one-page searches against the local stand-in
+// server: a fresh curl handle (and connection) per request, as
+// makeHttpRequest used to do, against ApiClient's pooled handles with
+// shared DNS, TLS-session and connection caches.
+//
+//   handle_reuse_bench [--smoke] [requests]
+//
+// --smoke fails unless both return the same body and the pooled client
+// keeps reusing its connection.
+
+#include <curl/curl.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "ApiClient.h"
+#include "StandInServer.h"
+
+namespace {
+
+size_t appendBody(void* contents, size_t size, size_t nmemb, void* userp) {
+    static_cast<std::string*>(userp)->append(static_cast<const char*>(contents), size * nmemb);
+    return size * nmemb;
+}
+
+// The request path before the pool: a new easy handle per call.
+bool fetchWithFreshHandle(const std::string& url, std::string& body) {
+    CURL* curl = curl_easy_init();
+
+    if (!curl) {
+        return false;
+    }
+
+    body.clear();
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, appendBody);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &body);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 20L);
+
+    CURLcode result = curl_easy_perform(curl);
+    curl_easy_cleanup(curl);
+
+    return result == CURLE_OK;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool smoke = argc > 1 && std::strcmp(argv[1], "--smoke") == 0;
+    int arg = smoke ? 2 : 1;
+    int requests = argc > arg ? std::atoi(argv[arg]) : (smoke ? 20 : 2000);
+
+    StandInServer server(1, 20);
+
+    if (!server.start()) {
+        return 1;
+    }
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    // The same URL ApiClient builds for page 1.
+    std::string url = server.baseUrl() + "/search/1?app_id=bench&app_key=bench&results_per_page=20&what=engineer";
+    std::string fresh_body;
+    bool ok = true;
+
+    std::size_t connections_before = server.connectionsAccepted();
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < requests; i++) {
+        ok = fetchWithFreshHandle(url, fresh_body) && ok;
+    }
+
+    double fresh_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / requests;
+    std::size_t fresh_connections = server.connectionsAccepted() - connections_before;
+
+    ApiClient client("bench", "bench", server.baseUrl());
+    std::string pooled_body;
+
+    connections_before = server.connectionsAccepted();
+    start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < requests; i++) {
+        ok = client.fetchSearchPage("engineer", "", 20, 0.0, 1, pooled_body).ok() && ok;
+    }
+
+    double pooled_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / requests;
+    std::size_t pooled_connections = server.connectionsAccepted() - connections_before;
+
+    std::cout << requests << " requests, " << pooled_body.size() << "-byte responses\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  fresh handle per request: " << fresh_us << " us/request, "
+              << fresh_connections << " connections\n";
+    std::cout << "  pooled handles:           " << pooled_us << " us/request, "
+              << pooled_connections << " connections\n";
+
+    if (fresh_body != pooled_body) {
+        std::cerr << "Pooled and fresh handles returned different bodies\n";
+        ok = false;
+    }
+
+    if (pooled_connections > 1) {
+        std::cerr << "Pooled handles opened " << pooled_connections << " connections\n";
+        ok = false;
+    }
+
+    curl_global_cleanup();
+    return smoke && !ok ? 1 : 0;
+}
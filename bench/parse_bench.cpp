@@ -0,0 +1,162 @@
+// Parse throughput of one large search response: a DOM built with
+// json::parse and walked into Jobs, as fetchFromAdzuna used to do, against
+// AdzunaResponseParser fed the body whole and in the 16 KB chunks libcurl
+// hands over.
+//
+//   parse_bench [--smoke] [jobs] [iterations]
+//
+// --smoke parses a small page and fails unless every mode returns the same
+// jobs.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "AdzunaResponseParser.h"
+#include "StandInServer.h"
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+
+std::vector<Job> parseDom(const std::string& body) {
+    std::vector<Job> jobs;
+    json data = json::parse(body);
+
+    if (!data.contains("results") || !data["results"].is_array()) {
+        return jobs;
+    }
+
+    for (const auto& item : data["results"]) {
+        Job job;
+
+        job.id = item.value("id", "");
+        job.title = item.value("title", "");
+
+        if (item.contains("company") && item["company"].is_object()) {
+            job.company.id = item["company"].value("id", "");
+            job.company.display_name = item["company"].value("display_name", "");
+        }
+
+        if (item.contains("location") && item["location"].is_object()) {
+            const json& location = item["location"];
+            job.location.display_name = location.value("display_name", "");
+
+            if (location.contains("area") && location["area"].is_array() && !location["area"].empty()) {
+                const json& area = location["area"];
+                job.location.country = area[0].get<std::string>();
+
+                if (area.size() > 1) {
+                    job.location.area = area[area.size() - 1].get<std::string>();
+                }
+            }
+        }
+
+        job.salary_min = item.value("salary_min", 0.0);
+        job.salary_max = item.value("salary_max", 0.0);
+        job.description = item.value("description", "");
+        job.redirect_url = item.value("redirect_url", "");
+        job.created = item.value("created", "");
+
+        jobs.push_back(job);
+    }
+
+    return jobs;
+}
+
+std::vector<Job> parseStream(const std::string& body, std::size_t chunk) {
+    std::vector<Job> jobs;
+    AdzunaResponseParser parser(jobs);
+
+    for (std::size_t at = 0; at < body.size(); at += chunk) {
+        if (!parser.feed(body.data() + at, std::min(chunk, body.size() - at))) {
+            break;
+        }
+    }
+
+    parser.finish();
+    return jobs;
+}
+
+bool sameJobs(const std::vector<Job>& a, const std::vector<Job>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < a.size(); i++) {
+        if (a[i].id != b[i].id ||
+            a[i].title != b[i].title ||
+            a[i].company.id != b[i].company.id ||
+            a[i].company.display_name != b[i].company.display_name ||
+            a[i].location.display_name != b[i].location.display_name ||
+            a[i].location.area != b[i].location.area ||
+            a[i].location.country != b[i].location.country ||
+            a[i].salary_min != b[i].salary_min ||
+            a[i].salary_max != b[i].salary_max ||
+            a[i].description != b[i].description ||
+            a[i].redirect_url != b[i].redirect_url ||
+            a[i].created != b[i].created) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool smoke = argc > 1 && std::strcmp(argv[1], "--smoke") == 0;
+    int arg = smoke ? 2 : 1;
+
+    int results = argc > arg ? std::atoi(argv[arg]) : (smoke ? 50 : 4000);
+    int iterations = argc > arg + 1 ? std::atoi(argv[arg + 1]) : (smoke ? 1 : 20);
+
+    std::string body = StandInServer::searchPage(1, results);
+    double megabytes = static_cast<double>(body.size()) / (1024.0 * 1024.0);
+
+    std::cout << results << " jobs, " << std::fixed << std::setprecision(2)
+              << megabytes << " MB body, " << iterations << " iterations\n";
+
+    std::vector<Job> dom;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; i++) {
+        dom = parseDom(body);
+    }
+
+    double dom_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::setprecision(1);
+    std::cout << "  DOM + walk:           " << megabytes * iterations / dom_seconds << " MB/s\n";
+
+    bool ok = dom.size() == static_cast<std::size_t>(results) &&
+              (dom.empty() || (!dom[0].company.id.empty() && !dom[0].location.area.empty()));
+
+    for (std::size_t chunk : {body.size(), static_cast<std::size_t>(16 * 1024)}) {
+        std::vector<Job> streamed;
+        start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < iterations; i++) {
+            streamed = parseStream(body, chunk);
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << (chunk == body.size() ? "  stream, whole body:   " : "  stream, 16 KB chunks: ")
+                  << megabytes * iterations / seconds << " MB/s, "
+                  << dom_seconds / seconds << "x\n";
+
+        if (!sameJobs(dom, streamed)) {
+            std::cerr << "Streaming parser returned different jobs\n";
+            ok = false;
+        }
+    }
+
+    return smoke && !ok ? 1 : 0;
+}
@@ -0,0 +1,145 @@
+// Ranking a result set against a profile: every job scored one at a time
+// with JobParser::relevanceScore and sorted, as rankJobsByRelevance used to
+// do, against a RelevanceIndex built once and asked for the top k.
+//
+//   rank_bench [--smoke] [jobs] [k]
+//
+// --smoke fails unless the index scores every row as relevanceScore does,
+// returns its top k best first, and leaves the input order alone for an
+// empty profile.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "AdzunaResponseParser.h"
+#include "JobParser.h"
+#include "RelevanceIndex.h"
+#include "StandInServer.h"
+
+namespace {
+
+const int kResultsPerPage = 50;
+
+std::vector<Job> sampleJobs(int count) {
+    std::vector<Job> jobs;
+
+    for (int page = 1; static_cast<int>(jobs.size()) < count; page++) {
+        std::string body = StandInServer::searchPage(page, kResultsPerPage);
+        std::vector<Job> page_jobs;
+        AdzunaResponseParser parser(page_jobs);
+
+        parser.feed(body.data(), body.size());
+        parser.finish();
+
+        for (Job& job : page_jobs) {
+            if (static_cast<int>(jobs.size()) < count) {
+                // Spread the salaries and locations so every term varies.
+                job.salary_max += static_cast<double>(jobs.size() % 7) * 15000.0;
+
+                if (jobs.size() % 3 == 0) {
+                    job.location.display_name = "Remote";
+                }
+
+                jobs.push_back(std::move(job));
+            }
+        }
+    }
+
+    return jobs;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool smoke = argc > 1 && std::strcmp(argv[1], "--smoke") == 0;
+    int arg = smoke ? 2 : 1;
+
+    int count = argc > arg ? std::atoi(argv[arg]) : (smoke ? 200 : 20000);
+    std::size_t k = argc > arg + 1 ? static_cast<std::size_t>(std::atoi(argv[arg + 1])) : 10;
+
+    std::vector<Job> jobs = sampleJobs(count);
+
+    RelevanceProfile profile;
+    profile.skills = "python sql aws";
+    profile.preferred_technologies = {"docker", "kubernetes"};
+    profile.location = "remote";
+    profile.desired_salary = 140000;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<double> reference(jobs.size());
+
+    for (std::size_t row = 0; row < jobs.size(); row++) {
+        reference[row] = JobParser::relevanceScore(jobs[row], profile.skills, profile.location,
+                                                   profile.desired_salary, profile.preferred_technologies);
+    }
+
+    std::vector<std::size_t> sorted(jobs.size());
+
+    for (std::size_t row = 0; row < sorted.size(); row++) {
+        sorted[row] = row;
+    }
+
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [&](std::size_t a, std::size_t b) { return reference[a] > reference[b]; });
+    double per_job_seconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    RelevanceIndex index(jobs);
+    double build_seconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<std::size_t> top = index.topK(profile, k);
+    double top_seconds = secondsSince(start);
+
+    std::cout << jobs.size() << " jobs, top " << k << '\n' << std::fixed << std::setprecision(2);
+    std::cout << "  relevanceScore per job + sort: " << per_job_seconds * 1e3 << " ms\n";
+    std::cout << "  RelevanceIndex build:          " << build_seconds * 1e3 << " ms\n";
+    std::cout << "  RelevanceIndex topK:           " << top_seconds * 1e3 << " ms, "
+              << std::setprecision(1) << per_job_seconds / top_seconds << "x\n";
+
+    bool ok = top.size() == std::min(k, jobs.size());
+    std::vector<float> scores = index.scores(profile);
+
+    for (std::size_t row = 0; row < jobs.size(); row++) {
+        if (std::fabs(scores[row] - reference[row]) > 1e-4) {
+            std::cerr << "Row " << row << " scores " << scores[row] << ", relevanceScore " << reference[row] << '\n';
+            ok = false;
+            break;
+        }
+    }
+
+    for (std::size_t i = 0; i < top.size(); i++) {
+        if ((i > 0 && scores[top[i]] > scores[top[i - 1]]) ||
+            std::fabs(reference[top[i]] - reference[sorted[i]]) > 1e-4) {
+            std::cerr << "topK differs from the sorted scores at " << i << '\n';
+            ok = false;
+            break;
+        }
+    }
+
+    // Nothing to weigh: every job scores 0 and the input order stands.
+    std::vector<std::size_t> unranked = index.topK(RelevanceProfile(), jobs.size());
+    std::vector<Job> ranked = JobParser::rankJobsByRelevance(jobs, "");
+
+    for (std::size_t row = 0; row < jobs.size(); row++) {
+        if (unranked.size() != jobs.size() || unranked[row] != row ||
+            ranked.size() != jobs.size() || ranked[row].id != jobs[row].id) {
+            std::cerr << "An empty profile reordered the jobs\n";
+            ok = false;
+            break;
+        }
+    }
+
+    return smoke && !ok ? 1 : 0;
+}
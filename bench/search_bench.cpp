@@ -0,0 +1,134 @@
+// Case-insensitive keyword search over job descriptions: lowercased copies
+// searched with std::string::find, as the filters used to do, against
+// TextSearch's scalar loop and the SIMD kernel it dispatches to.
+//
+//   search_bench [--smoke] [descriptions] [iterations]
+//
+// --smoke searches a small corpus and fails unless every mode finds the
+// same offsets.
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "AdzunaResponseParser.h"
+#include "StandInServer.h"
+#include "TextSearch.h"
+
+namespace {
+
+const char* const kNeedles[] = {
+    "Kubernetes", "PYTHON", "c++", "sql", "rust", "remote-first", "Machine Learning", "latency systems"
+};
+
+std::string lowercase(const std::string& text) {
+    std::string lower = text;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    return lower;
+}
+
+std::size_t findLowercaseCopy(const std::string& haystack, const std::string& needle) {
+    std::size_t at = lowercase(haystack).find(lowercase(needle));
+    return at == std::string::npos ? TextSearch::npos : at;
+}
+
+// Stand-in descriptions are all lowercase; capitalise some words so the
+// searches have mixed case to fold.
+std::vector<std::string> descriptions(int count) {
+    std::vector<Job> jobs;
+    AdzunaResponseParser parser(jobs);
+    std::string body = StandInServer::searchPage(1, count);
+
+    parser.feed(body.data(), body.size());
+    parser.finish();
+
+    std::vector<std::string> texts;
+    texts.reserve(jobs.size());
+
+    for (Job& job : jobs) {
+        std::string& text = job.description;
+
+        for (std::size_t i = 0, word = 0; i < text.size(); i++) {
+            if (i == 0 || text[i - 1] == ' ') {
+                word++;
+
+                if (word % 5 == 0) {
+                    text[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(text[i])));
+                }
+            }
+        }
+
+        texts.push_back(std::move(text));
+    }
+
+    return texts;
+}
+
+template <typename Find>
+double timeSearches(const std::vector<std::string>& texts, int iterations,
+                    std::vector<std::size_t>& offsets, Find find) {
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; i++) {
+        offsets.clear();
+
+        for (const std::string& text : texts) {
+            for (const char* needle : kNeedles) {
+                offsets.push_back(find(text, needle));
+            }
+        }
+    }
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool smoke = argc > 1 && std::strcmp(argv[1], "--smoke") == 0;
+    int arg = smoke ? 2 : 1;
+
+    int count = argc > arg ? std::atoi(argv[arg]) : (smoke ? 100 : 5000);
+    int iterations = argc > arg + 1 ? std::atoi(argv[arg + 1]) : (smoke ? 1 : 20);
+
+    std::vector<std::string> texts = descriptions(count);
+    std::size_t searches = texts.size() * (sizeof(kNeedles) / sizeof(kNeedles[0])) * iterations;
+
+    std::vector<std::size_t> copied;
+    std::vector<std::size_t> scalar;
+    std::vector<std::size_t> dispatched;
+
+    double copy_seconds = timeSearches(texts, iterations, copied, [](const std::string& text, const char* needle) {
+        return findLowercaseCopy(text, needle);
+    });
+    double scalar_seconds = timeSearches(texts, iterations, scalar, [](const std::string& text, const char* needle) {
+        return TextSearch::findIgnoreCaseScalar(text, needle);
+    });
+    double dispatched_seconds = timeSearches(texts, iterations, dispatched, [](const std::string& text, const char* needle) {
+        return TextSearch::findIgnoreCase(text, needle);
+    });
+
+    std::cout << texts.size() << " descriptions, " << searches << " searches\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  lowercase copies + find: " << copy_seconds * 1e9 / searches << " ns/search\n";
+    std::cout << "  scalar:                  " << scalar_seconds * 1e9 / searches << " ns/search, "
+              << copy_seconds / scalar_seconds << "x\n";
+    std::cout << "  " << std::left << std::setw(25) << (std::string(TextSearch::implementationName()) + ":")
+              << dispatched_seconds * 1e9 / searches << " ns/search, "
+              << copy_seconds / dispatched_seconds << "x\n";
+
+    bool ok = copied == scalar && copied == dispatched &&
+              std::count(copied.begin(), copied.end(), TextSearch::npos) < static_cast<long>(copied.size());
+
+    if (!ok) {
+        std::cerr << "Search modes disagree\n";
+    }
+
+    return smoke && !ok ? 1 : 0;
+}
@@ -0,0 +1,132 @@
+// Write throughput into a fresh database file: one storeJob call (and one
+// transaction) per row, as the application used to store results, against
+// storeJobs in batched transactions, with the rollback journal and with
+// write-ahead logging.
+//
+//   store_bench [--smoke] [jobs]
+//
+// --smoke stores a few pages and fails unless every mode leaves the same
+// rows in the file.
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "AdzunaResponseParser.h"
+#include "Database.h"
+#include "StandInServer.h"
+
+namespace {
+
+const int kResultsPerPage = 50;
+
+std::vector<Job> sampleJobs(int count) {
+    std::vector<Job> jobs;
+
+    for (int page = 1; static_cast<int>(jobs.size()) < count; page++) {
+        std::string body = StandInServer::searchPage(page, kResultsPerPage);
+        std::vector<Job> page_jobs;
+        AdzunaResponseParser parser(page_jobs);
+
+        parser.feed(body.data(), body.size());
+        parser.finish();
+
+        for (Job& job : page_jobs) {
+            if (static_cast<int>(jobs.size()) < count) {
+                jobs.push_back(std::move(job));
+            }
+        }
+    }
+
+    return jobs;
+}
+
+void removeDatabase(const std::string& path) {
+    for (const char* suffix : {"", "-wal", "-shm", "-journal"}) {
+        std::error_code ignored;
+        std::filesystem::remove(path + suffix, ignored);
+    }
+}
+
+// Rows found in `path` by a fresh connection.
+std::size_t storedRows(const std::string& path) {
+    Database db(path);
+    return db.loadJobs().size();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool smoke = argc > 1 && std::strcmp(argv[1], "--smoke") == 0;
+    int arg = smoke ? 2 : 1;
+
+    int count = argc > arg ? std::atoi(argv[arg]) : (smoke ? 150 : 2000);
+    std::vector<Job> jobs = sampleJobs(count);
+    std::string directory = std::filesystem::temp_directory_path().string();
+
+    struct Mode {
+        const char* label;
+        bool per_row;
+        bool write_ahead_log;
+    };
+
+    const Mode modes[] = {
+        {"storeJob per row:        ", true, false},
+        {"storeJobs, batched:      ", false, false},
+        {"storeJobs, batched + WAL:", false, true},
+    };
+
+    std::cout << jobs.size() << " jobs\n" << std::fixed << std::setprecision(0);
+
+    bool ok = true;
+    double per_row_seconds = 0.0;
+
+    for (const Mode& mode : modes) {
+        std::string path = directory + "/store_bench_" + std::to_string(&mode - modes) + ".db";
+        removeDatabase(path);
+
+        DatabaseOptions options;
+        options.write_ahead_log = mode.write_ahead_log;
+
+        double seconds = 0.0;
+
+        {
+            Database db(path, options);
+            auto start = std::chrono::steady_clock::now();
+
+            if (mode.per_row) {
+                for (const Job& job : jobs) {
+                    db.storeJob(job);
+                }
+            } else {
+                db.storeJobs(jobs);
+            }
+
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        if (mode.per_row) {
+            per_row_seconds = seconds;
+        }
+
+        std::size_t rows = storedRows(path);
+
+        std::cout << "  " << mode.label << " " << std::setw(8) << jobs.size() / seconds << " rows/s, "
+                  << std::setprecision(1) << per_row_seconds / seconds << "x, " << rows << " rows\n"
+                  << std::setprecision(0);
+
+        if (rows != jobs.size()) {
+            std::cerr << mode.label << " stored " << rows << " of " << jobs.size() << " rows\n";
+            ok = false;
+        }
+
+        removeDatabase(path);
+    }
+
+    return smoke && !ok ? 1 : 0;
+}
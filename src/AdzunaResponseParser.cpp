@@ -0,0 +1,197 @@
+#include "AdzunaResponseParser.h"
+
+#include <utility>
+
+// Depths as seen from inside a search response:
+//   1  top-level object         {"count": ..., "results": [...]}
+//   2  results array
+//   3  one result               {"id": ..., "company": {...}}
+//   4  object nested in result  {"display_name": ...}
+//   5  array nested in that     "area": ["US", "New York"]
+namespace {
+
+constexpr std::size_t kResultsDepth = 2;
+constexpr std::size_t kItemDepth = 3;
+constexpr std::size_t kNestedDepth = 4;
+constexpr std::size_t kAreaDepth = 5;
+
+} // namespace
+
+AdzunaResponseParser::AdzunaResponseParser(std::vector<Job>& output)
+    : jobs(output),
+      first_job(output.size()),
+      parser(this),
+      depth(0),
+      in_results(false),
+      saw_results(false),
+      result_count(0),
+      area_level(0) {}
+
+bool AdzunaResponseParser::feed(const char* data, std::size_t size) {
+    return parser.feed(data, size);
+}
+
+bool AdzunaResponseParser::finish() {
+    return parser.finish();
+}
+
+void AdzunaResponseParser::reset() {
+    jobs.erase(jobs.begin() + static_cast<std::ptrdiff_t>(first_job), jobs.end());
+    parser.reset();
+    keys.clear();
+    depth = 0;
+    in_results = false;
+    saw_results = false;
+    result_count = 0;
+    area_level = 0;
+    current = Job();
+}
+
+const std::string& AdzunaResponseParser::keyAt(std::size_t d) const {
+    static const std::string empty;
+    return d < keys.size() ? keys[d] : empty;
+}
+
+void AdzunaResponseParser::assignString(std::string& value) {
+    if (!in_results) {
+        return;
+    }
+
+    if (depth == kItemDepth) {
+        const std::string& field = keyAt(kItemDepth);
+
+        if (field == "id") current.id = std::move(value);
+        else if (field == "title") current.title = std::move(value);
+        else if (field == "description") current.description = std::move(value);
+        else if (field == "redirect_url") current.redirect_url = std::move(value);
+        else if (field == "created") current.created = std::move(value);
+    } else if (depth == kNestedDepth) {
+        const std::string& parent = keyAt(kItemDepth);
+        const std::string& field = keyAt(kNestedDepth);
+
+        if (field == "display_name") {
+            if (parent == "company") current.company.display_name = std::move(value);
+            else if (parent == "location") current.location.display_name = std::move(value);
+        } else if (parent == "company" && field == "id") {
+            current.company.id = std::move(value);
+        }
+    } else if (depth == kAreaDepth && isArea()) {
+        // The area runs from the country down, e.g. ["UK", "London",
+        // "Camden"]: the first level is the country, the last the area.
+        if (area_level++ == 0) current.location.country = std::move(value);
+        else current.location.area = std::move(value);
+    }
+}
+
+bool AdzunaResponseParser::isArea() const {
+    return keyAt(kItemDepth) == "location" && keyAt(kNestedDepth) == "area";
+}
+
+void AdzunaResponseParser::assignNumber(double value) {
+    if (!in_results || depth != kItemDepth) {
+        return;
+    }
+
+    const std::string& field = keyAt(kItemDepth);
+
+    if (field == "salary_min") current.salary_min = value;
+    else if (field == "salary_max") current.salary_max = value;
+}
+
+bool AdzunaResponseParser::null() {
+    return true;
+}
+
+bool AdzunaResponseParser::boolean(bool) {
+    return true;
+}
+
+bool AdzunaResponseParser::number_integer(number_integer_t val) {
+    assignNumber(static_cast<double>(val));
+    return true;
+}
+
+bool AdzunaResponseParser::number_unsigned(number_unsigned_t val) {
+    // Ids occasionally come back as bare numbers.
+    if (in_results && depth == kItemDepth && keyAt(kItemDepth) == "id") {
+        current.id = std::to_string(val);
+        return true;
+    }
+
+    if (in_results && depth == kNestedDepth && keyAt(kItemDepth) == "company" && keyAt(kNestedDepth) == "id") {
+        current.company.id = std::to_string(val);
+        return true;
+    }
+
+    assignNumber(static_cast<double>(val));
+    return true;
+}
+
+bool AdzunaResponseParser::number_float(number_float_t val, const string_t&) {
+    assignNumber(val);
+    return true;
+}
+
+bool AdzunaResponseParser::string(string_t& val) {
+    assignString(val);
+    return true;
+}
+
+bool AdzunaResponseParser::start_object(std::size_t) {
+    depth++;
+
+    if (in_results && depth == kItemDepth) {
+        current = Job();
+    }
+
+    return true;
+}
+
+bool AdzunaResponseParser::key(string_t& val) {
+    if (keys.size() <= depth) {
+        keys.resize(depth + 1);
+    }
+
+    keys[depth] = std::move(val);
+    return true;
+}
+
+bool AdzunaResponseParser::end_object() {
+    if (in_results && depth == kItemDepth) {
+        jobs.push_back(std::move(current));
+        result_count++;
+    }
+
+    if (depth < keys.size()) {
+        keys[depth].clear();
+    }
+
+    depth--;
+    return true;
+}
+
+bool AdzunaResponseParser::start_array(std::size_t) {
+    depth++;
+
+    if (depth == kResultsDepth && keyAt(1) == "results") {
+        in_results = true;
+        saw_results = true;
+    } else if (in_results && depth == kAreaDepth && isArea()) {
+        area_level = 0;
+    }
+
+    return true;
+}
+
+bool AdzunaResponseParser::end_array() {
+    if (in_results && depth == kResultsDepth) {
+        in_results = false;
+    }
+
+    depth--;
+    return true;
+}
+
+bool AdzunaResponseParser::parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) {
+    return false;
+}
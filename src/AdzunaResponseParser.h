@@ -0,0 +1,75 @@
+#ifndef ADZUNARESPONSEPARSER_H
+#define ADZUNARESPONSEPARSER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "JsonStreamParser.h"
+#include "model/Job.h"
+
+// Builds Job structs straight from the "results" array of an Adzuna search
+// response while the body is still arriving. No DOM is built: each result is
+// appended to the output vector as soon as its closing brace is read.
+class AdzunaResponseParser : public nlohmann::json_sax<nlohmann::json> {
+private:
+    std::vector<Job>& jobs;
+    std::size_t first_job;
+    JsonStreamParser parser;
+
+    // keys[d] is the most recent key read inside the object at depth d.
+    std::vector<std::string> keys;
+    std::size_t depth;
+
+    bool in_results;
+    bool saw_results;
+    std::size_t result_count;
+    Job current;
+
+    // Strings read so far from the current location.area array.
+    std::size_t area_level;
+
+    const std::string& keyAt(std::size_t d) const;
+    bool isArea() const;
+    void assignString(std::string& value);
+    void assignNumber(double value);
+
+public:
+    explicit AdzunaResponseParser(std::vector<Job>& output);
+
+    bool feed(const char* data, std::size_t size);
+    bool finish();
+
+    // Forgets everything parsed so far, including the jobs already appended
+    // to the output, so a retried response can be fed from the start.
+    void reset();
+
+    bool hasResults() const {
+        return saw_results;
+    }
+
+    std::size_t resultCount() const {
+        return result_count;
+    }
+
+    const std::string& error() const {
+        return parser.error();
+    }
+
+    bool null() override;
+    bool boolean(bool val) override;
+    bool number_integer(number_integer_t val) override;
+    bool number_unsigned(number_unsigned_t val) override;
+    bool number_float(number_float_t val, const string_t& s) override;
+    bool string(string_t& val) override;
+    bool start_object(std::size_t elements) override;
+    bool key(string_t& val) override;
+    bool end_object() override;
+    bool start_array(std::size_t elements) override;
+    bool end_array() override;
+    bool parse_error(std::size_t position,
+                     const std::string& last_token,
+                     const nlohmann::detail::exception& ex) override;
+};
+
+#endif
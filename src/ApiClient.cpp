@@ -1,146 +1,727 @@
 #include "ApiClient.h"
 
 #include <curl/curl.h>
+#include <algorithm>
+#include <cctype>
 #include <iostream>
+#include <iterator>
+#include <random>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
 
-#include "json.hpp"
+#include "AdzunaResponseParser.h"
+#include "CurlHandlePool.h"
 
-using json = nlohmann::json;
+namespace {
 
-ApiClient::ApiClient(const std::string& app_id, const std::string& app_key)
-    : adzuna_app_id(app_id), adzuna_app_key(app_key) {
+void configureHandle(CURL* curl,
+                     const std::string& url,
+                     void* write_data,
+                     size_t (*write_callback)(void*, size_t, size_t, void*)) {
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, write_data);
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, "JobMarketExplorer/1.0");
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 20L);
+}
+
+bool startsWithIgnoreCase(const std::string& text, const char* prefix) {
+    std::size_t i = 0;
+
+    for (; prefix[i] != '\0'; i++) {
+        if (i >= text.size() ||
+            std::tolower(static_cast<unsigned char>(text[i])) != static_cast<unsigned char>(prefix[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::string headerValue(const std::string& line, std::size_t name_length) {
+    std::size_t begin = name_length;
+    std::size_t end = line.size();
+
+    while (begin < end && std::isspace(static_cast<unsigned char>(line[begin]))) begin++;
+    while (end > begin && std::isspace(static_cast<unsigned char>(line[end - 1]))) end--;
+
+    return line.substr(begin, end - begin);
+}
+
+// Kept from a non-2xx body for the error message.
+constexpr std::size_t kErrorBodyLimit = 256;
+
+bool isSuccess(long status) {
+    return status >= 200 && status < 300;
+}
+
+std::string describe(const HttpResponse& response) {
+    std::ostringstream out;
+
+    if (response.curl_code != CURLE_OK) {
+        out << response.error;
+    } else {
+        out << "status " << response.status;
+
+        if (!response.error.empty()) {
+            out << ": " << response.error;
+        }
+    }
+
+    return out.str();
+}
+
+} // namespace
+
+ApiClient::Transfer::~Transfer() {
+    curl_slist_free_all(request_headers);
+}
+
+ApiClient::ApiClient(const std::string& app_id,
+                     const std::string& app_key,
+                     const std::string& base_url)
+    : adzuna_app_id(app_id), adzuna_app_key(app_key), api_base_url(base_url) {
     curl_global_init(CURL_GLOBAL_DEFAULT);
+    handle_pool = std::make_unique<CurlHandlePool>();
 }
 
 ApiClient::~ApiClient() {
+    // Pooled handles must be gone before libcurl is torn down.
+    handle_pool.reset();
     curl_global_cleanup();
 }
 
+void ApiClient::enableResponseCache(const std::string& directory,
+                                    std::chrono::seconds ttl,
+                                    std::uintmax_t max_bytes) {
+    response_cache = std::make_unique<ResponseCache>(directory, ttl, max_bytes);
+}
+
+void ApiClient::setRateLimit(double requests_per_second, double burst) {
+    rate_limiter = std::make_unique<RateLimiter>(requests_per_second, burst);
+}
+
+void ApiClient::setRetryPolicy(const RetryPolicy& policy) {
+    retry_policy = policy;
+}
+
 size_t ApiClient::WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
     size_t total_size = size * nmemb;
-    std::string* response = static_cast<std::string*>(userp);
-    response->append(static_cast<char*>(contents), total_size);
+    Transfer* transfer = static_cast<Transfer*>(userp);
+
+    // Error pages (429, 5xx, ...) are not results; keep a little of them for
+    // the message and let the transfer finish so it can be retried.
+    long status = 0;
+    curl_easy_getinfo(transfer->handle, CURLINFO_RESPONSE_CODE, &status);
+
+    if (!isSuccess(status)) {
+        std::size_t room = kErrorBodyLimit - std::min(kErrorBodyLimit, transfer->error_body.size());
+        transfer->error_body.append(static_cast<char*>(contents), std::min(room, total_size));
+        return total_size;
+    }
+
+    // Kept for the response cache; the parser still sees every chunk as it
+    // arrives.
+    if (!transfer->cache_key.empty()) {
+        transfer->body.append(static_cast<char*>(contents), total_size);
+    }
+
+    // Returning less than total_size makes libcurl abort the transfer, which
+    // is what we want once the body is known to be malformed.
+    return deliver(*transfer, static_cast<char*>(contents), total_size) ? total_size : 0;
+}
+
+size_t ApiClient::HeaderCallback(char* buffer, size_t size, size_t nitems, void* userp) {
+    size_t total_size = size * nitems;
+    Transfer* transfer = static_cast<Transfer*>(userp);
+    std::string line(buffer, total_size);
+
+    // A status line starts a new response (e.g. after a redirect).
+    if (startsWithIgnoreCase(line, "http/")) {
+        transfer->etag.clear();
+        transfer->last_modified.clear();
+    } else if (startsWithIgnoreCase(line, "etag:")) {
+        transfer->etag = headerValue(line, 5);
+    } else if (startsWithIgnoreCase(line, "last-modified:")) {
+        transfer->last_modified = headerValue(line, 14);
+    }
+
     return total_size;
 }
 
-std::string ApiClient::makeHttpRequest(const std::string& url) const {
-    CURL* curl = curl_easy_init();
-    std::string response;
+bool ApiClient::beginTransfer(Transfer& transfer, const std::string& url) const {
+    if (!response_cache) {
+        return false;
+    }
+
+    transfer.cache_key = ResponseCache::normalizeKey(url);
+    transfer.have_cached = response_cache->lookup(transfer.cache_key, transfer.cached);
 
-    if (!curl) {
-        throw std::runtime_error("Failed to init CURL");
+    if (!transfer.have_cached || !transfer.cached.fresh) {
+        return false;
     }
 
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "JobMarketExplorer/1.0");
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 20L);
+    deliver(transfer, transfer.cached.body.data(), transfer.cached.body.size());
+    return true;
+}
+
+void ApiClient::prepareHandle(void* curl, Transfer& transfer, const std::string& url) const {
+    configureHandle(curl, url, &transfer, WriteCallback);
+    transfer.handle = curl;
+
+    if (transfer.cache_key.empty()) {
+        return;
+    }
+
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, HeaderCallback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &transfer);
+
+    if (transfer.have_cached) {
+        if (!transfer.cached.etag.empty()) {
+            std::string header = "If-None-Match: " + transfer.cached.etag;
+            transfer.request_headers = curl_slist_append(transfer.request_headers, header.c_str());
+        }
+
+        if (!transfer.cached.last_modified.empty()) {
+            std::string header = "If-Modified-Since: " + transfer.cached.last_modified;
+            transfer.request_headers = curl_slist_append(transfer.request_headers, header.c_str());
+        }
+
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transfer.request_headers);
+    }
+}
 
-    CURLcode res = curl_easy_perform(curl);
+HttpResponse ApiClient::finishTransfer(Transfer& transfer, void* curl, int curl_code) const {
+    HttpResponse response;
+    response.curl_code = curl_code;
 
-    if (res != CURLE_OK) {
-        std::cerr << "HTTP error: " << curl_easy_strerror(res) << std::endl;
+    if (curl_code != CURLE_OK) {
+        response.error = curl_easy_strerror(static_cast<CURLcode>(curl_code));
+        return response;
+    }
+
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
+
+    if (!isSuccess(response.status) && response.status != 304) {
+        response.error = transfer.error_body;
+        return response;
+    }
+
+    if (transfer.cache_key.empty()) {
+        return response;
+    }
+
+    if (response.status == 304 && transfer.have_cached) {
+        // Unchanged on the server: parse the stored copy and restart its TTL.
+        deliver(transfer, transfer.cached.body.data(), transfer.cached.body.size());
+        response_cache->refresh(transfer.cache_key);
+        response.from_cache = true;
+    } else if (response.status == 200 && completeBody(transfer)) {
+        CachedResponse cached;
+        cached.body = std::move(transfer.body);
+        cached.etag = transfer.etag;
+        cached.last_modified = transfer.last_modified;
+        response_cache->store(transfer.cache_key, cached);
     }
 
-    curl_easy_cleanup(curl);
     return response;
 }
 
-std::string ApiClient::urlEncode(const std::string& value) {
-    CURL* curl = curl_easy_init();
-    if (!curl) return value;
+bool ApiClient::shouldRetry(const HttpResponse& response) const {
+    if (response.ok() || response.attempts >= retry_policy.max_attempts) {
+        return false;
+    }
+
+    switch (response.curl_code) {
+        case CURLE_OK:
+            break;
+        case CURLE_COULDNT_RESOLVE_HOST:
+        case CURLE_COULDNT_CONNECT:
+        case CURLE_OPERATION_TIMEDOUT:
+        case CURLE_SEND_ERROR:
+        case CURLE_RECV_ERROR:
+        case CURLE_GOT_NOTHING:
+        case CURLE_PARTIAL_FILE:
+        case CURLE_SSL_CONNECT_ERROR:
+        case CURLE_HTTP2:
+        case CURLE_HTTP2_STREAM:
+            return true;
+        default:
+            // Includes CURLE_WRITE_ERROR, i.e. a body the parser rejected.
+            return false;
+    }
 
-    char* output = curl_easy_escape(curl, value.c_str(), static_cast<int>(value.length()));
-    std::string encoded = output ? output : value;
+    long status = response.status;
+    return status == 408 || status == 429 || status == 500 ||
+           status == 502 || status == 503 || status == 504;
+}
+
+std::chrono::milliseconds ApiClient::retryDelay(const HttpResponse& response,
+                                                long retry_after_seconds) const {
+    thread_local std::mt19937 random(std::random_device{}());
+
+    std::chrono::milliseconds delay;
+
+    if (retry_after_seconds > 0) {
+        delay = std::chrono::seconds(retry_after_seconds);
+    } else {
+        int doublings = std::min(response.attempts - 1, 20);
+        long long ceiling = std::min<long long>(retry_policy.max_delay.count(),
+                                                retry_policy.base_delay.count() << doublings);
+        std::uniform_int_distribution<long long> jitter(ceiling / 2, ceiling);
+        delay = std::chrono::milliseconds(jitter(random));
+    }
+
+    // A 429 is about the whole client, not this page: hold everyone back.
+    if (response.status == 429 && rate_limiter) {
+        rate_limiter->pause(delay);
+    }
+
+    return delay;
+}
+
+bool ApiClient::completeBody(Transfer& transfer) {
+    // finish() can be called again by whoever consumes the parser and gives
+    // the same answer.
+    if (transfer.parser) {
+        return transfer.parser->finish();
+    }
+
+    return nlohmann::json::accept(transfer.body);
+}
 
-    if (output) curl_free(output);
-    curl_easy_cleanup(curl);
+bool ApiClient::deliver(Transfer& transfer, const char* data, std::size_t size) {
+    if (transfer.parser) {
+        return transfer.parser->feed(data, size);
+    }
+
+    transfer.raw_body->append(data, size);
+    return true;
+}
+
+HttpResponse ApiClient::makeHttpRequest(const std::string& url, AdzunaResponseParser& parser) const {
+    return performRequest(url, &parser, nullptr);
+}
+
+HttpResponse ApiClient::fetchSearchPage(const std::string& query,
+                                        const std::string& location,
+                                        int results_per_page,
+                                        double min_salary,
+                                        int page,
+                                        std::string& body,
+                                        bool newest_first) const {
+    body.clear();
+
+    HttpResponse response =
+        performRequest(buildSearchUrl(query, location, results_per_page, min_salary, page, newest_first),
+                       nullptr, &body);
+    response.page = page;
+
+    return response;
+}
+
+HttpResponse ApiClient::performRequest(const std::string& url,
+                                       AdzunaResponseParser* parser,
+                                       std::string* body) const {
+    HttpResponse response;
+
+    for (int attempt = 1; ; attempt++) {
+        Transfer transfer;
+        transfer.parser = parser;
+        transfer.raw_body = body;
+
+        if (beginTransfer(transfer, url)) {
+            response = HttpResponse();
+            response.status = 200;
+            response.from_cache = true;
+            response.attempts = attempt;
+            return response;
+        }
+
+        if (rate_limiter) {
+            rate_limiter->acquire();
+        }
+
+        CurlHandlePool::Handle curl = handle_pool->acquire();
+
+        prepareHandle(curl.get(), transfer, url);
+
+        CURLcode res = curl_easy_perform(curl.get());
+
+        response = finishTransfer(transfer, curl.get(), res);
+        response.attempts = attempt;
+
+        if (response.ok()) {
+            return response;
+        }
+
+        if (!shouldRetry(response)) {
+            std::cerr << "HTTP error: " << describe(response) << std::endl;
+            return response;
+        }
+
+        curl_off_t retry_after = 0;
+        curl_easy_getinfo(curl.get(), CURLINFO_RETRY_AFTER, &retry_after);
+
+        auto delay = retryDelay(response, static_cast<long>(retry_after));
+        std::cerr << "HTTP error: " << describe(response) << "; retrying in "
+                  << delay.count() << " ms" << std::endl;
+
+        if (parser) {
+            parser->reset();
+        } else {
+            body->clear();
+        }
+
+        std::this_thread::sleep_for(delay);
+    }
+}
+
+std::string ApiClient::urlEncode(const std::string& value) {
+    // Same output as curl_easy_escape: RFC 3986 unreserved characters pass
+    // through, everything else becomes %XX.
+    static const char hex[] = "0123456789ABCDEF";
+
+    std::string encoded;
+    encoded.reserve(value.size() * 3);
+
+    for (unsigned char c : value) {
+        if (std::isalnum(c) || c == '-' || c == '.' || c == '_' || c == '~') {
+            encoded += static_cast<char>(c);
+        } else {
+            encoded += '%';
+            encoded += hex[c >> 4];
+            encoded += hex[c & 0x0F];
+        }
+    }
 
     return encoded;
 }
 
+std::string ApiClient::buildSearchUrl(const std::string& query,
+                                      const std::string& location,
+                                      int results_per_page,
+                                      double min_salary,
+                                      int page,
+                                      bool newest_first) const {
+    std::stringstream url;
+    url << api_base_url << "/search/" << page << "?"
+        << "app_id=" << adzuna_app_id
+        << "&app_key=" << adzuna_app_key
+        << "&results_per_page=" << results_per_page;
+
+    if (!query.empty()) {
+        url << "&what=" << urlEncode(query);
+    }
+
+    if (!location.empty()) {
+        url << "&where=" << urlEncode(location);
+    }
+
+    if (min_salary > 0) {
+        url << "&salary_min=" << static_cast<int>(min_salary);
+    }
+
+    if (newest_first) {
+        url << "&sort_by=date";
+    }
+
+    return url.str();
+}
+
+bool ApiClient::completePage(AdzunaResponseParser& parser) {
+    if (!parser.finish()) {
+        std::cerr << "JSON parse error: " << parser.error() << std::endl;
+        return false;
+    }
+
+    return parser.hasResults() && parser.resultCount() > 0;
+}
+
 std::vector<Job> ApiClient::fetchFromAdzuna(const std::string& query,
                                             const std::string& location,
                                             int results_per_page,
                                             double min_salary,
-                                            int max_pages) const {
+                                            int max_pages,
+                                            std::vector<HttpResponse>* responses) const {
     std::vector<Job> jobs;
 
     if (max_pages < 1) {
         max_pages = 1;
     }
 
+    // Room for the first page; later pages grow the vector geometrically.
+    jobs.reserve(static_cast<std::size_t>(std::max(0, results_per_page)));
+
     for (int page = 1; page <= max_pages; page++) {
-        std::stringstream url;
-        url << "https://api.adzuna.com/v1/api/jobs/us/search/" << page << "?"
-            << "app_id=" << adzuna_app_id
-            << "&app_key=" << adzuna_app_key
-            << "&results_per_page=" << results_per_page;
+        std::size_t page_start = jobs.size();
+        AdzunaResponseParser parser(jobs);
+
+        HttpResponse response =
+            makeHttpRequest(buildSearchUrl(query, location, results_per_page, min_salary, page),
+                            parser);
+        response.page = page;
 
-        if (!query.empty()) {
-            url << "&what=" << urlEncode(query);
+        if (responses) {
+            responses->push_back(response);
         }
 
-        if (!location.empty()) {
-            url << "&where=" << urlEncode(location);
+        if (!response.ok() || !completePage(parser)) {
+            // Drop whatever a truncated or malformed page managed to emit.
+            jobs.erase(jobs.begin() + static_cast<std::ptrdiff_t>(page_start), jobs.end());
+            break;
         }
+    }
+
+    return jobs;
+}
+
+std::vector<Job> ApiClient::fetchFromAdzunaConcurrent(const std::string& query,
+                                                      const std::string& location,
+                                                      int results_per_page,
+                                                      double min_salary,
+                                                      int max_pages,
+                                                      int max_in_flight,
+                                                      std::vector<HttpResponse>* responses) const {
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<Job> jobs;
+
+    if (max_pages < 1) {
+        max_pages = 1;
+    }
 
-        if (min_salary > 0) {
-            url << "&salary_min=" << static_cast<int>(min_salary);
+    if (max_in_flight < 1) {
+        max_in_flight = 1;
+    }
+
+    CURLM* multi = curl_multi_init();
+
+    if (!multi) {
+        throw std::runtime_error("Failed to init CURL multi");
+    }
+
+    // Slot i belongs to page i + 1. Each page streams into its own parser
+    // and job list, because pages can finish in any order.
+    std::vector<std::vector<Job>> page_jobs(max_pages);
+    std::vector<std::unique_ptr<AdzunaResponseParser>> parsers(max_pages);
+    std::vector<std::unique_ptr<Transfer>> transfers(max_pages);
+    std::vector<CurlHandlePool::Handle> handles(max_pages);
+    std::vector<HttpResponse> results(max_pages);
+    std::vector<bool> completed(max_pages, false);
+
+    // A failed page waits here until its backoff has passed.
+    std::vector<bool> retry_pending(max_pages, false);
+    std::vector<Clock::time_point> retry_at(max_pages);
+
+    int next_to_start = 1;
+    int next_to_parse = 1;
+    bool stopped = false;
+
+    // Serves page slot + 1 from the cache or, given a rate token, starts
+    // its request. Cache hits are free, as in performRequest, so the cache
+    // is checked before a token is taken. False, with nothing started,
+    // while no token is available.
+    auto launch = [&](std::size_t slot) {
+        int page = static_cast<int>(slot) + 1;
+        std::string url = buildSearchUrl(query, location, results_per_page, min_salary, page);
+
+        transfers[slot] = std::make_unique<Transfer>();
+        transfers[slot]->parser = parsers[slot].get();
+
+        if (beginTransfer(*transfers[slot], url)) {
+            results[slot].page = page;
+            results[slot].attempts++;
+            results[slot].status = 200;
+            results[slot].from_cache = true;
+            completed[slot] = true;
+            return true;
         }
 
-        std::string response = makeHttpRequest(url.str());
+        if (rate_limiter && !rate_limiter->tryAcquire()) {
+            return false;
+        }
 
-        try {
-            json data = json::parse(response);
+        results[slot].page = page;
+        results[slot].attempts++;
 
-            if (!data.contains("results") || !data["results"].is_array()) {
-                break;
+        CurlHandlePool::Handle curl = handle_pool->acquire();
+        prepareHandle(curl.get(), *transfers[slot], url);
+        curl_easy_setopt(curl.get(), CURLOPT_PRIVATE, reinterpret_cast<char*>(slot));
+
+        curl_multi_add_handle(multi, curl.get());
+        handles[slot] = std::move(curl);
+        return true;
+    };
+
+    while (!stopped && next_to_parse <= max_pages) {
+        Clock::time_point now = Clock::now();
+        bool waiting_for_token = false;
+
+        // Retries go first: the pages behind them cannot be consumed anyway.
+        for (int page = next_to_parse; page < next_to_start; page++) {
+            std::size_t slot = static_cast<std::size_t>(page - 1);
+
+            if (retry_pending[slot] && retry_at[slot] <= now) {
+                if (!launch(slot)) {
+                    waiting_for_token = true;
+                    break;
+                }
+
+                retry_pending[slot] = false;
             }
+        }
 
-            if (data["results"].empty()) {
+        // The window counts pages that are started but not yet consumed, so
+        // finished pages waiting on an earlier slow page also hold a slot.
+        while (!waiting_for_token && next_to_start <= max_pages &&
+               next_to_start - next_to_parse < max_in_flight) {
+            std::size_t slot = static_cast<std::size_t>(next_to_start - 1);
+
+            if (!parsers[slot]) {
+                page_jobs[slot].reserve(static_cast<std::size_t>(std::max(0, results_per_page)));
+                parsers[slot] = std::make_unique<AdzunaResponseParser>(page_jobs[slot]);
+            }
+
+            if (!launch(slot)) {
+                waiting_for_token = true;
                 break;
             }
 
-            for (const auto& item : data["results"]) {
-                Job job;
+            next_to_start++;
+        }
 
-                job.id = item.value("id", "");
-                job.title = item.value("title", "");
+        int running = 0;
+        CURLMcode mc = curl_multi_perform(multi, &running);
 
-                if (item.contains("company") && item["company"].is_object()) {
-                    job.company.display_name = item["company"].value("display_name", "");
-                }
+        if (mc != CURLM_OK) {
+            std::cerr << "HTTP error: " << curl_multi_strerror(mc) << std::endl;
+            break;
+        }
+
+        CURLMsg* msg = nullptr;
+        int queued = 0;
+
+        while ((msg = curl_multi_info_read(multi, &queued))) {
+            if (msg->msg != CURLMSG_DONE) {
+                continue;
+            }
 
-                if (item.contains("location") && item["location"].is_object()) {
-                    job.location.display_name = item["location"].value("display_name", "");
+            char* private_data = nullptr;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &private_data);
+            std::size_t slot = reinterpret_cast<std::size_t>(private_data);
+
+            HttpResponse response = finishTransfer(*transfers[slot], msg->easy_handle, msg->data.result);
+            response.page = results[slot].page;
+            response.attempts = results[slot].attempts;
+            results[slot] = response;
+
+            if (shouldRetry(response)) {
+                curl_off_t retry_after = 0;
+                curl_easy_getinfo(msg->easy_handle, CURLINFO_RETRY_AFTER, &retry_after);
+
+                auto delay = retryDelay(response, static_cast<long>(retry_after));
+                std::cerr << "HTTP error on page " << response.page << ": " << describe(response)
+                          << "; retrying in " << delay.count() << " ms" << std::endl;
+
+                parsers[slot]->reset();
+                retry_pending[slot] = true;
+                retry_at[slot] = Clock::now() + delay;
+            } else {
+                if (!response.ok()) {
+                    std::cerr << "HTTP error on page " << response.page << ": "
+                              << describe(response) << std::endl;
                 }
 
-                job.salary_min = item.value("salary_min", 0.0);
-                job.salary_max = item.value("salary_max", 0.0);
-                job.description = item.value("description", "");
-                job.redirect_url = item.value("redirect_url", "");
-                job.created = item.value("created", "");
+                completed[slot] = true;
+            }
 
-                jobs.push_back(job);
+            curl_multi_remove_handle(multi, msg->easy_handle);
+            handles[slot].reset();
+        }
+
+        while (next_to_parse <= max_pages && completed[next_to_parse - 1]) {
+            std::size_t slot = static_cast<std::size_t>(next_to_parse - 1);
+
+            if (responses) {
+                responses->push_back(results[slot]);
+            }
+
+            if (!results[slot].ok() || !completePage(*parsers[slot])) {
+                stopped = true;
+                break;
             }
 
-        } catch (const std::exception& e) {
-            std::cerr << "JSON parse error: " << e.what() << std::endl;
+            jobs.insert(jobs.end(), std::make_move_iterator(page_jobs[slot].begin()),
+                        std::make_move_iterator(page_jobs[slot].end()));
+
+            parsers[slot].reset();
+            transfers[slot].reset();
+            std::vector<Job>().swap(page_jobs[slot]);
+            next_to_parse++;
+        }
+
+        if (stopped) {
             break;
         }
+
+        // Sleep until a transfer makes progress, a backoff expires or a
+        // token frees up, whichever comes first. With none of those pending
+        // (every page so far came from the cache) there is nothing to wait
+        // for.
+        Clock::duration timeout = std::chrono::seconds(1);
+        bool pending = running > 0 || waiting_for_token;
+        now = Clock::now();
+
+        for (int page = next_to_parse; page < next_to_start; page++) {
+            std::size_t slot = static_cast<std::size_t>(page - 1);
+
+            if (retry_pending[slot]) {
+                timeout = std::min(timeout, std::max(Clock::duration::zero(), retry_at[slot] - now));
+                pending = true;
+            }
+        }
+
+        if (waiting_for_token) {
+            timeout = std::min(timeout, rate_limiter->timeUntilAvailable());
+        }
+
+        // Rounded up: a wait under a millisecond truncated to 0 would skip
+        // the poll and spin until it is over.
+        auto timeout_ms = std::chrono::ceil<std::chrono::milliseconds>(timeout).count();
+
+        // Pages consumed above may have opened the window; start the next
+        // ones first rather than after the running transfers next stir.
+        bool can_start = !waiting_for_token && next_to_start <= max_pages &&
+                         next_to_start - next_to_parse < max_in_flight;
+
+        if (pending && !can_start && (running > 0 || timeout_ms > 0)) {
+            curl_multi_poll(multi, nullptr, 0, static_cast<int>(timeout_ms), nullptr);
+        }
+    }
+
+    // Anything still attached is past the end of the results; cancel it.
+    for (auto& curl : handles) {
+        if (curl) {
+            curl_multi_remove_handle(multi, curl.get());
+            curl.reset();
+        }
     }
 
+    curl_multi_cleanup(multi);
     return jobs;
 }
 
 std::vector<Job> ApiClient::searchJobs(const std::string& query,
                                        const std::string& location,
                                        double min_salary,
-                                       int max_pages) const {
-    return fetchFromAdzuna(query, location, 50, min_salary, max_pages);
+                                       int max_pages,
+                                       std::vector<HttpResponse>* responses) const {
+    if (max_pages > 1) {
+        return fetchFromAdzunaConcurrent(query, location, 50, min_salary, max_pages, 4, responses);
+    }
+
+    return fetchFromAdzuna(query, location, 50, min_salary, max_pages, responses);
 }
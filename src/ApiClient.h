@@ -1,47 +1,193 @@
 #ifndef APICLIENT_H
 #define APICLIENT_H
 
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "RateLimiter.h"
+#include "ResponseCache.h"
 #include "model/Job.h"
 
+class AdzunaResponseParser;
+class CurlHandlePool;
+struct curl_slist;
+
+// Outcome of one page request, after retries.
+struct HttpResponse {
+    int page = 0;
+    long status = 0;        // HTTP status; 0 if no response arrived
+    int curl_code = 0;      // CURLcode of the last attempt
+    std::string error;      // transport error, or the start of an error body
+    int attempts = 0;
+    bool from_cache = false;
+
+    bool ok() const {
+        return curl_code == 0 && ((status >= 200 && status < 300) || from_cache);
+    }
+};
+
+// Retries transport failures, 408, 429 and 5xx. The delay before attempt
+// n + 1 is drawn from [d / 2, d] with d = min(max_delay, base_delay * 2^(n-1)),
+// unless the server sent Retry-After, which is used instead.
+struct RetryPolicy {
+    int max_attempts = 4;
+    std::chrono::milliseconds base_delay = std::chrono::milliseconds(500);
+    std::chrono::milliseconds max_delay = std::chrono::milliseconds(30000);
+};
+
 class ApiClient {
 private:
     std::string adzuna_app_id;
     std::string adzuna_app_key;
+    std::string api_base_url;
+
+    std::unique_ptr<CurlHandlePool> handle_pool;
+    std::unique_ptr<ResponseCache> response_cache;
+    std::unique_ptr<RateLimiter> rate_limiter;
+    RetryPolicy retry_policy;
+
+    // One page request: the parser the body streams into, plus what the
+    // response cache needs to store or revalidate it.
+    struct Transfer {
+        // The body goes to `parser` if set, else it is appended to raw_body.
+        AdzunaResponseParser* parser = nullptr;
+        std::string* raw_body = nullptr;
+        void* handle = nullptr;
+        std::string error_body;
+        std::string cache_key;
+        CachedResponse cached;
+        bool have_cached = false;
+        std::string body;
+        std::string etag;
+        std::string last_modified;
+        curl_slist* request_headers = nullptr;
+
+        Transfer() = default;
+        ~Transfer();
+
+        Transfer(const Transfer&) = delete;
+        Transfer& operator=(const Transfer&) = delete;
+    };
 
     static size_t WriteCallback(void* contents,
                                 size_t size,
                                 size_t nmemb,
                                 void* userp);
 
-    std::string makeHttpRequest(const std::string& url) const;
+    static size_t HeaderCallback(char* buffer,
+                                 size_t size,
+                                 size_t nitems,
+                                 void* userp);
+
+    static bool deliver(Transfer& transfer, const char* data, std::size_t size);
+
+    // True if the body that arrived is whole, valid JSON, and so worth
+    // caching.
+    static bool completeBody(Transfer& transfer);
+
+    // Returns true if a fresh cache entry was fed to the parser, in which
+    // case no request is needed.
+    bool beginTransfer(Transfer& transfer, const std::string& url) const;
+    void prepareHandle(void* curl, Transfer& transfer, const std::string& url) const;
+    HttpResponse finishTransfer(Transfer& transfer, void* curl, int curl_code) const;
+
+    bool shouldRetry(const HttpResponse& response) const;
+
+    // Delay before the next attempt; also pauses the rate limiter on 429.
+    std::chrono::milliseconds retryDelay(const HttpResponse& response,
+                                         long retry_after_seconds) const;
+
+    // Sends `url` (or answers it from the cache), retrying per
+    // retry_policy. A 2xx body streams into `parser`, or into `body` when
+    // parser is null; either is reset before each retry.
+    HttpResponse performRequest(const std::string& url,
+                                AdzunaResponseParser* parser,
+                                std::string* body) const;
+
+    HttpResponse makeHttpRequest(const std::string& url, AdzunaResponseParser& parser) const;
+
+    std::string buildSearchUrl(const std::string& query,
+                               const std::string& location,
+                               int results_per_page,
+                               double min_salary,
+                               int page,
+                               bool newest_first = false) const;
+
+    // Returns false when the page ends the result set (empty, missing or
+    // unparseable results).
+    static bool completePage(AdzunaResponseParser& parser);
 
     static std::string urlEncode(const std::string& value);
 
 public:
     ApiClient(const std::string& app_id,
-              const std::string& app_key);
+              const std::string& app_key,
+              const std::string& base_url = "https://api.adzuna.com/v1/api/jobs/us");
 
     ~ApiClient();
 
     ApiClient(const ApiClient&) = delete;
     ApiClient& operator=(const ApiClient&) = delete;
 
+    // Keeps search responses on disk under `directory`. Within `ttl` a
+    // repeated request is answered locally; after that it is revalidated
+    // with If-None-Match / If-Modified-Since when the server sent a
+    // validator.
+    void enableResponseCache(const std::string& directory,
+                             std::chrono::seconds ttl = std::chrono::minutes(15),
+                             std::uintmax_t max_bytes = 64 * 1024 * 1024);
+
+    // Caps outgoing requests (cache hits are free). Without a limit,
+    // requests go out as fast as the window allows.
+    void setRateLimit(double requests_per_second, double burst = 1.0);
+
+    void setRetryPolicy(const RetryPolicy& policy);
+
+    // `responses`, if given, receives one entry per page requested, in page
+    // order, so callers can tell the end of the results from a failure.
     std::vector<Job> fetchFromAdzuna(
         const std::string& query = "",
         const std::string& location = "",
         int results_per_page = 50,
         double min_salary = 0.0,
-        int max_pages = 1
+        int max_pages = 1,
+        std::vector<HttpResponse>* responses = nullptr
     ) const;
 
+    // Same results as fetchFromAdzuna, but keeps up to `max_in_flight` page
+    // requests running at once through a curl multi handle. Pages are
+    // returned in page order; the first empty page cancels everything after it.
+    std::vector<Job> fetchFromAdzunaConcurrent(
+        const std::string& query = "",
+        const std::string& location = "",
+        int results_per_page = 50,
+        double min_salary = 0.0,
+        int max_pages = 1,
+        int max_in_flight = 4,
+        std::vector<HttpResponse>* responses = nullptr
+    ) const;
+
+    // One search page, unparsed, with the same caching, rate limiting and
+    // retries as the fetch functions. For callers that parse elsewhere, such
+    // as IngestPipeline. `newest_first` sorts by posting date instead of
+    // relevance.
+    HttpResponse fetchSearchPage(const std::string& query,
+                                 const std::string& location,
+                                 int results_per_page,
+                                 double min_salary,
+                                 int page,
+                                 std::string& body,
+                                 bool newest_first = false) const;
+
     std::vector<Job> searchJobs(
         const std::string& query,
         const std::string& location,
         double min_salary = 0.0,
-        int max_pages = 1
+        int max_pages = 1,
+        std::vector<HttpResponse>* responses = nullptr
     ) const;
 };
 
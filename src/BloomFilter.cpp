@@ -0,0 +1,72 @@
+#include "BloomFilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+BloomFilter::BloomFilter(std::size_t expected_items, double false_positive_rate)
+    : capacity(std::max<std::size_t>(expected_items, 64)), item_count(0) {
+    if (false_positive_rate <= 0.0 || false_positive_rate >= 1.0) {
+        false_positive_rate = 0.01;
+    }
+
+    // m = -n ln p / (ln 2)^2 bits and k = (m / n) ln 2 probes minimize the
+    // false-positive rate for n keys.
+    const double ln2 = std::log(2.0);
+    double bits_needed = -static_cast<double>(capacity) * std::log(false_positive_rate) / (ln2 * ln2);
+
+    bit_count = static_cast<std::size_t>(std::ceil(bits_needed / 64.0)) * 64;
+    hash_count = std::max(1, static_cast<int>(std::lround(bits_needed / capacity * ln2)));
+    bits.assign(bit_count / 64, 0);
+}
+
+void BloomFilter::hash(std::string_view key, std::uint64_t& h1, std::uint64_t& h2) {
+    // FNV-1a, then a splitmix64 finalizer of it for the second hash.
+    std::uint64_t h = 1469598103934665603ULL;
+
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+
+    std::uint64_t z = h + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+
+    h1 = h;
+    h2 = z | 1;
+}
+
+void BloomFilter::add(std::string_view key) {
+    std::uint64_t h1;
+    std::uint64_t h2;
+    hash(key, h1, h2);
+
+    for (int i = 0; i < hash_count; i++) {
+        std::size_t bit = static_cast<std::size_t>((h1 + static_cast<std::uint64_t>(i) * h2) % bit_count);
+        bits[bit / 64] |= std::uint64_t(1) << (bit % 64);
+    }
+
+    item_count++;
+}
+
+bool BloomFilter::mightContain(std::string_view key) const {
+    std::uint64_t h1;
+    std::uint64_t h2;
+    hash(key, h1, h2);
+
+    for (int i = 0; i < hash_count; i++) {
+        std::size_t bit = static_cast<std::size_t>((h1 + static_cast<std::uint64_t>(i) * h2) % bit_count);
+
+        if ((bits[bit / 64] & (std::uint64_t(1) << (bit % 64))) == 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void BloomFilter::clear() {
+    std::fill(bits.begin(), bits.end(), 0);
+    item_count = 0;
+}
@@ -0,0 +1,40 @@
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Set membership with false positives but no false negatives: mightContain
+// is false only for keys that were never added. Sized up front for
+// `expected_items` at roughly `false_positive_rate`; adding more keys than
+// that raises the rate, which saturated() reports.
+class BloomFilter {
+private:
+    std::vector<std::uint64_t> bits;
+    std::size_t bit_count;
+    int hash_count;
+    std::size_t capacity;
+    std::size_t item_count;
+
+    // Two independent 64-bit hashes; probe i is h1 + i * h2.
+    static void hash(std::string_view key, std::uint64_t& h1, std::uint64_t& h2);
+
+public:
+    explicit BloomFilter(std::size_t expected_items = 0, double false_positive_rate = 0.01);
+
+    void add(std::string_view key);
+    bool mightContain(std::string_view key) const;
+    void clear();
+
+    std::size_t size() const {
+        return item_count;
+    }
+
+    bool saturated() const {
+        return item_count > capacity;
+    }
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+// FIFO handing items between threads. push blocks while `capacity` items are
+// waiting, which is what throttles a fast producer to its consumer's pace.
+// After close(), push fails and pop drains what is left, then fails.
+template<typename T>
+class BoundedQueue {
+private:
+    std::deque<T> items;
+    std::size_t capacity;
+    bool closed;
+
+    std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+
+public:
+    explicit BoundedQueue(std::size_t max_items)
+        : capacity(max_items > 0 ? max_items : 1), closed(false) {}
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this]() { return closed || items.size() < capacity; });
+
+        if (closed) {
+            return false;
+        }
+
+        items.push_back(std::move(item));
+        lock.unlock();
+        not_empty.notify_one();
+        return true;
+    }
+
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this]() { return closed || !items.empty(); });
+
+        if (items.empty()) {
+            return false;
+        }
+
+        item = std::move(items.front());
+        items.pop_front();
+        lock.unlock();
+        not_full.notify_one();
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
+};
+
+#endif
@@ -0,0 +1,63 @@
+#include "CountMinSketch.h"
+
+#include <algorithm>
+#include <limits>
+
+CountMinSketch::CountMinSketch() : width(0), depth(0) {}
+
+CountMinSketch::CountMinSketch(std::size_t requested_width, std::size_t requested_depth)
+    : width(1), depth(std::max<std::size_t>(requested_depth, 1)) {
+    while (width < requested_width) {
+        width <<= 1;
+    }
+
+    cells.assign(width * depth, 0);
+}
+
+std::uint64_t CountMinSketch::step(std::uint64_t hash) {
+    // Row i probes hash + i * step, with the step an odd splitmix64 mix of
+    // the hash, like BloomFilter's second hash.
+    std::uint64_t z = hash + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+
+    return z | 1;
+}
+
+void CountMinSketch::add(std::uint64_t hash, std::uint64_t count) {
+    std::uint64_t probe = hash;
+    std::uint64_t stride = step(hash);
+
+    for (std::size_t row = 0; row < depth; row++, probe += stride) {
+        cells[row * width + static_cast<std::size_t>(probe & (width - 1))] += count;
+    }
+}
+
+std::uint64_t CountMinSketch::estimate(std::uint64_t hash) const {
+    if (cells.empty()) {
+        return 0;
+    }
+
+    std::uint64_t probe = hash;
+    std::uint64_t stride = step(hash);
+    std::uint64_t smallest = std::numeric_limits<std::uint64_t>::max();
+
+    for (std::size_t row = 0; row < depth; row++, probe += stride) {
+        smallest = std::min(smallest, cells[row * width + static_cast<std::size_t>(probe & (width - 1))]);
+    }
+
+    return smallest;
+}
+
+bool CountMinSketch::merge(const CountMinSketch& other) {
+    if (width != other.width || depth != other.depth) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < cells.size(); i++) {
+        cells[i] += other.cells[i];
+    }
+
+    return true;
+}
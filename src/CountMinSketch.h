@@ -0,0 +1,40 @@
+#ifndef COUNTMINSKETCH_H
+#define COUNTMINSKETCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Approximate counts for a stream of keys in fixed memory: `depth` rows of
+// `width` counters, one counter per row for each key. estimate() is never
+// below the key's true count, and exceeds it by more than e / width of the
+// stream total with probability at most e^-depth.
+//
+// Keys are passed as 64-bit hashes, so callers that already hash a key for
+// their own lookups do not hash it twice. Sketches of equal dimensions
+// merge by adding their counters.
+class CountMinSketch {
+private:
+    std::size_t width;   // a power of two
+    std::size_t depth;
+    std::vector<std::uint64_t> cells;
+
+    static std::uint64_t step(std::uint64_t hash);
+
+public:
+    // An empty (0 x 0) sketch, which counts nothing, until assigned.
+    CountMinSketch();
+    CountMinSketch(std::size_t width, std::size_t depth);
+
+    void add(std::uint64_t hash, std::uint64_t count = 1);
+    std::uint64_t estimate(std::uint64_t hash) const;
+
+    // False (and nothing merged) if the dimensions differ.
+    bool merge(const CountMinSketch& other);
+
+    bool empty() const {
+        return cells.empty();
+    }
+};
+
+#endif
@@ -0,0 +1,80 @@
+#include "CurlHandlePool.h"
+
+#include <stdexcept>
+
+CurlHandlePool::CurlHandlePool(std::size_t max_idle_handles)
+    : share(curl_share_init()), max_idle(max_idle_handles) {
+    if (!share) {
+        throw std::runtime_error("Failed to init CURL share");
+    }
+
+    curl_share_setopt(share, CURLSHOPT_LOCKFUNC, lockShare);
+    curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, unlockShare);
+    curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+}
+
+CurlHandlePool::~CurlHandlePool() {
+    for (CURL* curl : idle_handles) {
+        curl_easy_cleanup(curl);
+    }
+
+    curl_share_cleanup(share);
+}
+
+void CurlHandlePool::lockShare(CURL*, curl_lock_data data, curl_lock_access, void* userptr) {
+    static_cast<CurlHandlePool*>(userptr)->share_locks[data].lock();
+}
+
+void CurlHandlePool::unlockShare(CURL*, curl_lock_data data, void* userptr) {
+    static_cast<CurlHandlePool*>(userptr)->share_locks[data].unlock();
+}
+
+CurlHandlePool::Handle CurlHandlePool::acquire() {
+    CURL* curl = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+
+        if (!idle_handles.empty()) {
+            curl = idle_handles.back();
+            idle_handles.pop_back();
+        }
+    }
+
+    if (curl) {
+        // Clears options only; live connections and caches are kept.
+        curl_easy_reset(curl);
+    } else {
+        curl = curl_easy_init();
+
+        if (!curl) {
+            throw std::runtime_error("Failed to init CURL");
+        }
+    }
+
+    curl_easy_setopt(curl, CURLOPT_SHARE, share);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+
+    return Handle(curl, HandleReturner{this});
+}
+
+void CurlHandlePool::release(CURL* curl) {
+    if (!curl) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+
+        if (idle_handles.size() < max_idle) {
+            idle_handles.push_back(curl);
+            return;
+        }
+    }
+
+    curl_easy_cleanup(curl);
+}
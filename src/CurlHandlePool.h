@@ -0,0 +1,56 @@
+#ifndef CURLHANDLEPOOL_H
+#define CURLHANDLEPOOL_H
+
+#include <curl/curl.h>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Keeps finished easy handles around for reuse and ties every handle to one
+// CURLSH, so DNS results, TLS sessions and open keep-alive connections
+// survive from one request to the next. acquire/release are thread-safe.
+class CurlHandlePool {
+private:
+    struct HandleReturner {
+        CurlHandlePool* pool;
+
+        void operator()(CURL* curl) const {
+            pool->release(curl);
+        }
+    };
+
+    CURLSH* share;
+    std::mutex share_locks[CURL_LOCK_DATA_LAST];
+
+    std::mutex pool_mutex;
+    std::vector<CURL*> idle_handles;
+    std::size_t max_idle;
+
+    static void lockShare(CURL* curl,
+                          curl_lock_data data,
+                          curl_lock_access access,
+                          void* userptr);
+
+    static void unlockShare(CURL* curl,
+                            curl_lock_data data,
+                            void* userptr);
+
+public:
+    using Handle = std::unique_ptr<CURL, HandleReturner>;
+
+    explicit CurlHandlePool(std::size_t max_idle_handles = 16);
+    ~CurlHandlePool();
+
+    CurlHandlePool(const CurlHandlePool&) = delete;
+    CurlHandlePool& operator=(const CurlHandlePool&) = delete;
+
+    // Returns a handle with default options plus the shared caches attached.
+    // The handle goes back to the pool when the returned pointer is reset.
+    Handle acquire();
+
+    void release(CURL* curl);
+};
+
+#endif
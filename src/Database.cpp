@@ -1,280 +1,2028 @@
 #include "Database.h"
 
+#include <algorithm>
 #include <iostream>
+#include <memory_resource>
+#include <set>
+#include <string_view>
+#include <unordered_set>
 
 #include <sqlite3.h>
 
 #include "JobParser.h"
+#include "JobSnapshot.h"
+#include "JsonStreamParser.h"
+#include "MinHash.h"
+#include "SimHash.h"
 #include "json.hpp"
 
 using json = nlohmann::json;
 
-Database::Database(const std::string& path)
-    : database_path(path), cache_dirty(true) {
+namespace {
+
+const char* const kInsertJobSql = R"(
+    INSERT OR REPLACE INTO jobs
+    (
+        id,
+        title,
+        company_name,
+        company_id,
+        location_display,
+        location_area,
+        location_country,
+        salary_min,
+        salary_max,
+        description,
+        redirect_url,
+        category,
+        created,
+        minhash,
+        simhash,
+        duplicate_of,
+        last_updated
+    )
+    VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, CURRENT_TIMESTAMP);
+)";
+
+// One row per technology of a job; the jobs delete trigger removes them
+// together with the job.
+const char* const kInsertTechnologySql =
+    "INSERT OR IGNORE INTO job_technologies (job_id, technology) VALUES (?, ?);";
+
+const char* const kSelectJobsSql = R"(
+    SELECT
+        id,
+        title,
+        company_name,
+        company_id,
+        location_display,
+        location_area,
+        location_country,
+        salary_min,
+        salary_max,
+        description,
+        redirect_url,
+        (SELECT json_group_array(technology) FROM job_technologies WHERE job_id = jobs.id),
+        category,
+        created,
+        minhash,
+        simhash,
+        duplicate_of
+    FROM jobs
+    ORDER BY created DESC;
+)";
+
+const char* const kJobExistsSql = "SELECT 1 FROM jobs WHERE id = ? LIMIT 1;";
+
+// Ids per findExistingJobs query.
+constexpr int kExistingJobsBatch = 64;
+
+// "SELECT id FROM jobs WHERE id IN (?, ?, ...)" with kExistingJobsBatch
+// placeholders.
+const std::string& existingJobsSql() {
+    static const std::string sql = []() {
+        std::string text = "SELECT id FROM jobs WHERE id IN (?";
+
+        for (int i = 1; i < kExistingJobsBatch; i++) {
+            text += ", ?";
+        }
+
+        return text + ");";
+    }();
+
+    return sql;
+}
+
+const char* const kLoadCheckpointSql =
+    "SELECT newest_created, newest_ids FROM crawl_checkpoints WHERE search_key = ?;";
+
+// Originals only: rows flagged as duplicates are never matched against.
+// Rows stored before the simhash column existed have NULL there and are
+// fingerprinted from their text.
+const char* const kLoadFingerprintsSql = R"(
+    SELECT id, simhash, title, company_name, location_display, description
+    FROM jobs
+    WHERE duplicate_of IS NULL;
+)";
+
+const char* const kLoadSalaryStatsSql = "SELECT slice, sketch FROM salary_stats;";
+
+const char* const kSaveSalaryStatsSql = R"(
+    INSERT OR REPLACE INTO salary_stats (slice, sketch, updated_at)
+    VALUES (?, ?, CURRENT_TIMESTAMP);
+)";
+
+// Only the columns SalaryStatistics::add reads.
+const char* const kSalaryRowsSql = R"(
+    SELECT salary_min, salary_max, category, location_display,
+           (SELECT json_group_array(technology) FROM job_technologies WHERE job_id = jobs.id)
+    FROM jobs
+    WHERE duplicate_of IS NULL;
+)";
+
+const char* const kSaveCheckpointSql = R"(
+    INSERT OR REPLACE INTO crawl_checkpoints (search_key, newest_created, newest_ids, updated_at)
+    VALUES (?, ?, ?, CURRENT_TIMESTAMP);
+)";
+
+// Bloom filter sizing: room for the stored ids to double before it is
+// rebuilt, at about 1% false positives.
+constexpr std::size_t kMinKnownIds = 1024;
+constexpr double kKnownIdsFalsePositiveRate = 0.01;
+
+// External-content FTS5 index over jobs(title, description): the text is not
+// stored twice, and the triggers keep the index in step with every write.
+const char* const kFullTextSql = R"(
+    CREATE VIRTUAL TABLE IF NOT EXISTS jobs_fts USING fts5(
+        title,
+        description,
+        content = 'jobs',
+        content_rowid = 'rowid',
+        tokenize = 'unicode61 remove_diacritics 2'
+    );
+
+    CREATE TRIGGER IF NOT EXISTS jobs_fts_insert AFTER INSERT ON jobs BEGIN
+        INSERT INTO jobs_fts (rowid, title, description)
+        VALUES (new.rowid, new.title, new.description);
+    END;
+
+    CREATE TRIGGER IF NOT EXISTS jobs_fts_delete AFTER DELETE ON jobs BEGIN
+        INSERT INTO jobs_fts (jobs_fts, rowid, title, description)
+        VALUES ('delete', old.rowid, old.title, old.description);
+    END;
+
+    CREATE TRIGGER IF NOT EXISTS jobs_fts_update AFTER UPDATE ON jobs BEGIN
+        INSERT INTO jobs_fts (jobs_fts, rowid, title, description)
+        VALUES ('delete', old.rowid, old.title, old.description);
+        INSERT INTO jobs_fts (rowid, title, description)
+        VALUES (new.rowid, new.title, new.description);
+    END;
+)";
+
+// Pre-aggregated statistics. job_rollups holds one row per (day, category,
+// location, technology) with technology '' counting each job once; company
+// rollups use the same keys with the company in place of the technology.
+// Only originals are counted.
+//
+// Database adds the jobs it stores in batches (kAddJobRollupSql), at each
+// commit. The trigger takes away rows that are deleted or replaced (the
+// delete half of INSERT OR REPLACE fires with recursive triggers on) and
+// their technologies. A row replaced before its own batch was added can
+// leave a key at zero, so queries skip keys without jobs.
+const char* const kRollupSql = R"(
+    CREATE TABLE IF NOT EXISTS job_rollups (
+        day TEXT NOT NULL,
+        category TEXT NOT NULL,
+        location TEXT NOT NULL,
+        technology TEXT NOT NULL,
+        job_count INTEGER NOT NULL,
+        salaried INTEGER NOT NULL,
+        salary_min_sum REAL NOT NULL,
+        salary_max_sum REAL NOT NULL,
+        PRIMARY KEY (day, category, location, technology)
+    ) WITHOUT ROWID;
+
+    CREATE TABLE IF NOT EXISTS company_rollups (
+        day TEXT NOT NULL,
+        category TEXT NOT NULL,
+        location TEXT NOT NULL,
+        company TEXT NOT NULL,
+        job_count INTEGER NOT NULL,
+        salaried INTEGER NOT NULL,
+        salary_min_sum REAL NOT NULL,
+        salary_max_sum REAL NOT NULL,
+        PRIMARY KEY (day, category, location, company)
+    ) WITHOUT ROWID;
+
+    CREATE TRIGGER IF NOT EXISTS jobs_rollup_delete AFTER DELETE ON jobs BEGIN
+        INSERT INTO job_rollups
+        SELECT coalesce(substr(old.created, 1, 10), ''), coalesce(old.category, ''),
+               coalesce(old.location_display, ''), technology, -1,
+               -(coalesce(old.salary_min, 0) > 0),
+               -(CASE WHEN old.salary_min > 0 THEN old.salary_min ELSE 0 END),
+               -(CASE WHEN old.salary_min > 0 THEN coalesce(old.salary_max, 0) ELSE 0 END)
+        FROM (SELECT '' AS technology
+              UNION ALL
+              SELECT technology FROM job_technologies WHERE job_id = old.id)
+        WHERE old.duplicate_of IS NULL
+        ON CONFLICT DO UPDATE SET
+            job_count = job_count + excluded.job_count,
+            salaried = salaried + excluded.salaried,
+            salary_min_sum = salary_min_sum + excluded.salary_min_sum,
+            salary_max_sum = salary_max_sum + excluded.salary_max_sum;
+
+        INSERT INTO company_rollups
+        SELECT coalesce(substr(old.created, 1, 10), ''), coalesce(old.category, ''),
+               coalesce(old.location_display, ''), coalesce(old.company_name, ''), -1,
+               -(coalesce(old.salary_min, 0) > 0),
+               -(CASE WHEN old.salary_min > 0 THEN old.salary_min ELSE 0 END),
+               -(CASE WHEN old.salary_min > 0 THEN coalesce(old.salary_max, 0) ELSE 0 END)
+        WHERE old.duplicate_of IS NULL
+        ON CONFLICT DO UPDATE SET
+            job_count = job_count + excluded.job_count,
+            salaried = salaried + excluded.salaried,
+            salary_min_sum = salary_min_sum + excluded.salary_min_sum,
+            salary_max_sum = salary_max_sum + excluded.salary_max_sum;
+
+        DELETE FROM job_technologies WHERE job_id = old.id;
+    END;
+)";
+
+const char* const kAddJobRollupSql = R"(
+    INSERT INTO job_rollups VALUES (?, ?, ?, ?, ?, ?, ?, ?)
+    ON CONFLICT DO UPDATE SET
+        job_count = job_count + excluded.job_count,
+        salaried = salaried + excluded.salaried,
+        salary_min_sum = salary_min_sum + excluded.salary_min_sum,
+        salary_max_sum = salary_max_sum + excluded.salary_max_sum;
+)";
+
+const char* const kAddCompanyRollupSql = R"(
+    INSERT INTO company_rollups VALUES (?, ?, ?, ?, ?, ?, ?, ?)
+    ON CONFLICT DO UPDATE SET
+        job_count = job_count + excluded.job_count,
+        salaried = salaried + excluded.salaried,
+        salary_min_sum = salary_min_sum + excluded.salary_min_sum,
+        salary_max_sum = salary_max_sum + excluded.salary_max_sum;
+)";
+
+// Recomputes both rollup tables from jobs and job_technologies.
+const char* const kRebuildRollupsSql = R"(
+    DELETE FROM job_rollups;
+    DELETE FROM company_rollups;
+
+    INSERT INTO job_rollups
+    SELECT coalesce(substr(created, 1, 10), ''), coalesce(category, ''),
+           coalesce(location_display, ''), '', COUNT(*),
+           SUM(coalesce(salary_min, 0) > 0),
+           SUM(CASE WHEN salary_min > 0 THEN salary_min ELSE 0 END),
+           SUM(CASE WHEN salary_min > 0 THEN coalesce(salary_max, 0) ELSE 0 END)
+    FROM jobs
+    WHERE duplicate_of IS NULL
+    GROUP BY 1, 2, 3;
+
+    INSERT INTO job_rollups
+    SELECT coalesce(substr(j.created, 1, 10), ''), coalesce(j.category, ''),
+           coalesce(j.location_display, ''), t.technology, COUNT(*),
+           SUM(coalesce(j.salary_min, 0) > 0),
+           SUM(CASE WHEN j.salary_min > 0 THEN j.salary_min ELSE 0 END),
+           SUM(CASE WHEN j.salary_min > 0 THEN coalesce(j.salary_max, 0) ELSE 0 END)
+    FROM job_technologies t
+    JOIN jobs j ON j.id = t.job_id
+    WHERE j.duplicate_of IS NULL
+    GROUP BY 1, 2, 3, 4;
+
+    INSERT INTO company_rollups
+    SELECT coalesce(substr(created, 1, 10), ''), coalesce(category, ''),
+           coalesce(location_display, ''), coalesce(company_name, ''), COUNT(*),
+           SUM(coalesce(salary_min, 0) > 0),
+           SUM(CASE WHEN salary_min > 0 THEN salary_min ELSE 0 END),
+           SUM(CASE WHEN salary_min > 0 THEN coalesce(salary_max, 0) ELSE 0 END)
+    FROM jobs
+    WHERE duplicate_of IS NULL
+    GROUP BY 1, 2, 3, 4;
+)";
+
+// Files from before job_technologies kept each job's technologies as a JSON
+// array in jobs.technologies.
+const char* const kMigrateTechnologiesSql = R"(
+    INSERT OR IGNORE INTO job_technologies (job_id, technology)
+    SELECT j.id, t.value
+    FROM jobs j, json_each(j.technologies) t
+    WHERE json_valid(j.technologies) AND t.type = 'text';
+)";
+
+// DROP COLUMN needs SQLite 3.35.
+const char* const kDropTechnologiesSql = "ALTER TABLE jobs DROP COLUMN technologies;";
+
+// Older SQLite rebuilds jobs without the column instead. Rowids are kept so
+// jobs_fts still points at the right rows; the triggers go with the old
+// table and are recreated after the migration.
+const char* const kRebuildJobsSql = R"(
+    CREATE TABLE jobs_rebuilt (
+        id TEXT PRIMARY KEY,
+        title TEXT,
+        company_name TEXT,
+        company_id TEXT,
+        location_display TEXT,
+        location_area TEXT,
+        location_country TEXT,
+        salary_min REAL,
+        salary_max REAL,
+        description TEXT,
+        redirect_url TEXT,
+        category TEXT,
+        created TEXT,
+        minhash BLOB,
+        simhash INTEGER,
+        duplicate_of TEXT,
+        last_updated TEXT DEFAULT CURRENT_TIMESTAMP
+    );
+
+    INSERT INTO jobs_rebuilt (rowid, id, title, company_name, company_id, location_display,
+                              location_area, location_country, salary_min, salary_max,
+                              description, redirect_url, category, created, minhash, simhash,
+                              duplicate_of, last_updated)
+    SELECT rowid, id, title, company_name, company_id, location_display,
+           location_area, location_country, salary_min, salary_max,
+           description, redirect_url, category, created, minhash, simhash,
+           duplicate_of, last_updated
+    FROM jobs;
+
+    DROP TABLE jobs;
+    ALTER TABLE jobs_rebuilt RENAME TO jobs;
+
+    CREATE INDEX idx_jobs_title ON jobs(title);
+    CREATE INDEX idx_jobs_company ON jobs(company_name);
+    CREATE INDEX idx_jobs_location ON jobs(location_display);
+    CREATE INDEX idx_jobs_salary ON jobs(salary_min, salary_max);
+)";
+
+const char* const kJobColumnsSql = R"(
+        j.id,
+        j.title,
+        j.company_name,
+        j.company_id,
+        j.location_display,
+        j.location_area,
+        j.location_country,
+        j.salary_min,
+        j.salary_max,
+        j.description,
+        j.redirect_url,
+        (SELECT json_group_array(technology) FROM job_technologies WHERE job_id = j.id),
+        j.category,
+        j.created,
+        j.minhash,
+        j.simhash,
+        j.duplicate_of
+)";
+
+// Columns of kJobColumnsSql, which readJob reads.
+const int kJobColumnCount = 17;
+
+// Signatures are stored as little-endian 32-bit values, so files move
+// between hosts. An empty signature is stored as an empty blob.
+void writeSignature(const std::vector<std::uint32_t>& signature, std::string& out) {
+    out.resize(signature.size() * 4);
+
+    for (std::size_t i = 0; i < signature.size(); i++) {
+        for (int byte = 0; byte < 4; byte++) {
+            out[i * 4 + byte] = static_cast<char>((signature[i] >> (8 * byte)) & 0xFF);
+        }
+    }
+}
+
+// Leaves `signature` empty unless the column holds a full one.
+void readSignature(sqlite3_stmt* stmt, int col, std::vector<std::uint32_t>& signature) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(sqlite3_column_blob(stmt, col));
+    std::size_t size = static_cast<std::size_t>(sqlite3_column_bytes(stmt, col));
+
+    signature.clear();
+
+    if (!bytes || size != MinHash::kHashes * 4) {
+        return;
+    }
+
+    signature.resize(MinHash::kHashes);
+
+    for (std::size_t i = 0; i < MinHash::kHashes; i++) {
+        signature[i] = static_cast<std::uint32_t>(bytes[i * 4]) |
+                       static_cast<std::uint32_t>(bytes[i * 4 + 1]) << 8 |
+                       static_cast<std::uint32_t>(bytes[i * 4 + 2]) << 16 |
+                       static_cast<std::uint32_t>(bytes[i * 4 + 3]) << 24;
+    }
+}
+
+// Reads a JSON array of strings, such as the technologies column, straight
+// into a vector without building a json value. One instance per thread is
+// reused, so a read only allocates for the strings it keeps.
+class StringArrayReader : public nlohmann::json_sax<json> {
+private:
+    JsonStreamParser parser;
+    std::vector<std::string>* values;
+    int depth;
+
+public:
+    StringArrayReader() : parser(this), values(nullptr), depth(0) {}
+
+    bool read(const char* text, std::size_t size, std::vector<std::string>& output) {
+        parser.reset();
+        values = &output;
+        depth = 0;
+
+        bool ok = parser.feed(text, size) && parser.finish();
+        values = nullptr;
+
+        return ok;
+    }
+
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t) override { return true; }
+    bool number_unsigned(number_unsigned_t) override { return true; }
+    bool number_float(number_float_t, const string_t&) override { return true; }
+    bool key(string_t&) override { return true; }
+
+    bool string(string_t& val) override {
+        // Copied, not moved: the parser keeps its token buffer for the next
+        // string.
+        if (depth == 1) {
+            values->push_back(val);
+        }
+        return true;
+    }
+
+    bool start_object(std::size_t) override { depth++; return true; }
+    bool end_object() override { depth--; return true; }
+    bool start_array(std::size_t) override { depth++; return true; }
+    bool end_array() override { depth--; return true; }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override {
+        return false;
+    }
+};
+
+// Replacements located one by one below this count; above it, one pass over
+// the whole cache is cheaper.
+constexpr std::size_t kPointUpdateLimit = 16;
+
+// Initial arena size per pending change in applyPendingChanges: enough for
+// a hash node plus its share of the bucket array, so the arena rarely grows.
+constexpr std::size_t kArenaBytesPerChange = 64;
+
+// " AND ..." for each RollupFilters field that is set; bound in field
+// order by bindRollupFilters.
+std::string rollupConditions(const RollupFilters& filters) {
+    std::string sql;
+
+    if (!filters.first_day.empty()) sql += " AND day >= ?";
+    if (!filters.last_day.empty()) sql += " AND day <= ?";
+    if (!filters.category.empty()) sql += " AND category = ?";
+    if (!filters.location.empty()) sql += " AND location = ?";
+
+    return sql;
+}
+
+void bindRollupFilters(sqlite3_stmt* stmt, const RollupFilters& filters) {
+    int index = 1;
+
+    for (const std::string* value : {&filters.first_day, &filters.last_day,
+                                     &filters.category, &filters.location}) {
+        if (!value->empty()) {
+            sqlite3_bind_text(stmt, index++, value->data(), static_cast<int>(value->size()), SQLITE_STATIC);
+        }
+    }
+}
+
+bool newerFirst(const Job& a, const Job& b) {
+    return a.created > b.created;
+}
+
+// `text` as a LIKE pattern matching it anywhere. Its own '%', '_' and
+// backslashes are escaped, for LIKE ... ESCAPE '\'.
+std::string containsPattern(const std::string& text) {
+    std::string pattern = "%";
+
+    for (char c : text) {
+        if (c == '%' || c == '_' || c == '\\') {
+            pattern += '\\';
+        }
+
+        pattern += c;
+    }
+
+    pattern += '%';
+    return pattern;
+}
+
+// Each whitespace-separated term of `query` as an FTS5 string, so that
+// punctuation ("c++", "node.js") and keywords ("OR", "NOT") are searched
+// for rather than parsed. A trailing * stays outside the quotes and still
+// matches a prefix.
+std::string quotedTerms(const std::string& query) {
+    std::string match;
+    std::size_t at = 0;
+
+    while ((at = query.find_first_not_of(" \t\r\n", at)) != std::string::npos) {
+        std::size_t end = query.find_first_of(" \t\r\n", at);
+        std::string_view term(query.data() + at, (end == std::string::npos ? query.size() : end) - at);
+        bool prefix = term.size() > 1 && term.back() == '*';
+
+        if (prefix) {
+            term.remove_suffix(1);
+        }
+
+        match += match.empty() ? "\"" : " \"";
+
+        for (char c : term) {
+            match += c;
+
+            if (c == '"') {
+                match += '"';
+            }
+        }
+
+        match += prefix ? "\"*" : "\"";
+        at = end;
+    }
+
+    return match;
+}
+
+} // namespace
+
+Database::Database(const std::string& path, const DatabaseOptions& opts)
+    : database_path(path),
+      options(opts),
+      job_cache(std::make_shared<std::vector<Job>>()),
+      cache_dirty(true),
+      full_text_search(false),
+      known_ids_loaded(false),
+      fingerprints_loaded(false),
+      near_duplicate_count(0),
+      salary_statistics_loaded(false),
+      market_rollups(false),
+      batch_near_duplicates(0) {
+    if (options.batch_size == 0) {
+        options.batch_size = 1;
+    }
+
     initializeDatabase();
 }
 
-Database::~Database() = default;
+Database::~Database() = default;
+
+void Database::initializeDatabase() {
+    if (!options.per_thread_connections) {
+        shared_connection = openConnection();
+    }
+
+    createTables();
+}
+
+SqliteConnection& Database::connection() {
+    if (!options.per_thread_connections) {
+        return *shared_connection;
+    }
+
+    std::lock_guard<std::mutex> lock(thread_connections_mutex);
+    auto& slot = thread_connections[std::this_thread::get_id()];
+
+    if (!slot) {
+        slot = openConnection();
+    }
+
+    return *slot;
+}
+
+std::unique_ptr<SqliteConnection> Database::openConnection() const {
+    auto db = std::make_unique<SqliteConnection>(database_path, options.write_ahead_log);
+
+    // INSERT OR REPLACE only fires the DELETE triggers for the row it
+    // replaces with recursive triggers on; without them the full-text index
+    // would keep the old text.
+    if (db->isOpen()) {
+        db->execute("PRAGMA recursive_triggers = ON;");
+    }
+
+    return db;
+}
+
+Job Database::readJob(sqlite3_stmt* stmt) {
+    Job job;
+
+    auto assignText = [&](std::string& field, int col) {
+        const unsigned char* text = sqlite3_column_text(stmt, col);
+
+        if (text) {
+            field.assign(reinterpret_cast<const char*>(text),
+                         static_cast<std::size_t>(sqlite3_column_bytes(stmt, col)));
+        }
+    };
+
+    assignText(job.id, 0);
+    assignText(job.title, 1);
+    assignText(job.company.display_name, 2);
+    assignText(job.company.id, 3);
+    assignText(job.location.display_name, 4);
+    assignText(job.location.area, 5);
+    assignText(job.location.country, 6);
+    job.salary_min = sqlite3_column_double(stmt, 7);
+    job.salary_max = sqlite3_column_double(stmt, 8);
+    assignText(job.description, 9);
+    assignText(job.redirect_url, 10);
+
+    const unsigned char* technologies = sqlite3_column_text(stmt, 11);
+
+    if (technologies) {
+        thread_local StringArrayReader reader;
+
+        if (!reader.read(reinterpret_cast<const char*>(technologies),
+                         static_cast<std::size_t>(sqlite3_column_bytes(stmt, 11)),
+                         job.technologies)) {
+            job.technologies.clear();
+        }
+    }
+
+    assignText(job.category, 12);
+    assignText(job.created, 13);
+    readSignature(stmt, 14, job.minhash);
+    job.simhash = static_cast<std::uint64_t>(sqlite3_column_int64(stmt, 15));
+    assignText(job.duplicate_of, 16);
+
+    return job;
+}
+
+bool Database::isEnriched(const Job& job) {
+    return !job.technologies.empty() && !job.category.empty() &&
+           job.minhash.size() == MinHash::kHashes && job.simhash != 0;
+}
+
+void Database::enrichJob(Job& job) {
+    // Jobs enriched upstream (e.g. by IngestPipeline) already carry these.
+    if (job.technologies.empty()) {
+        job.technologies = JobParser::extractTechnologies(job.description);
+    }
+
+    if (job.category.empty()) {
+        job.category = JobParser::categorizeJob(job);
+    }
+
+    if (job.minhash.size() != MinHash::kHashes) {
+        job.minhash = MinHash::signature(job);
+    }
+
+    if (job.simhash == 0) {
+        job.simhash = SimHash::fingerprint(job);
+    }
+}
+
+void Database::bindJob(sqlite3_stmt* stmt, const Job& job) {
+    auto bindText = [&](int index, const std::string& value) {
+        sqlite3_bind_text(stmt, index, value.data(), static_cast<int>(value.size()), SQLITE_STATIC);
+    };
+
+    bindText(1, job.id);
+    bindText(2, job.title);
+    bindText(3, job.company.display_name);
+    bindText(4, job.company.id);
+    bindText(5, job.location.display_name);
+    bindText(6, job.location.area);
+    bindText(7, job.location.country);
+    sqlite3_bind_double(stmt, 8, job.salary_min);
+    sqlite3_bind_double(stmt, 9, job.salary_max);
+    bindText(10, job.description);
+    bindText(11, job.redirect_url);
+    bindText(12, job.category);
+    bindText(13, job.created);
+
+    // Written into a per-thread buffer that stays alive (and bound) until
+    // the caller unbinds after the step.
+    thread_local std::string minhash_blob;
+    writeSignature(job.minhash, minhash_blob);
+    sqlite3_bind_blob(stmt, 14, minhash_blob.data(), static_cast<int>(minhash_blob.size()), SQLITE_STATIC);
+
+    if (job.simhash != 0) {
+        sqlite3_bind_int64(stmt, 15, static_cast<sqlite3_int64>(job.simhash));
+    } else {
+        sqlite3_bind_null(stmt, 15);
+    }
+
+    // NULL rather than '' for originals, so "duplicate_of IS NULL" selects
+    // them.
+    if (!job.duplicate_of.empty()) {
+        bindText(16, job.duplicate_of);
+    } else {
+        sqlite3_bind_null(stmt, 16);
+    }
+}
+
+bool Database::insertTechnologies(SqliteConnection& db, const Job& job) {
+    if (job.technologies.empty()) {
+        return true;
+    }
+
+    SqliteConnection::Statement stmt = db.prepare(kInsertTechnologySql);
+
+    if (!stmt) {
+        return false;
+    }
+
+    sqlite3_bind_text(stmt.get(), 1, job.id.data(), static_cast<int>(job.id.size()), SQLITE_STATIC);
+
+    for (const auto& technology : job.technologies) {
+        sqlite3_bind_text(stmt.get(), 2, technology.data(), static_cast<int>(technology.size()), SQLITE_STATIC);
+
+        bool stored = sqlite3_step(stmt.get()) == SQLITE_DONE;
+        sqlite3_reset(stmt.get());
+
+        if (!stored) {
+            std::cerr << "Storing technologies failed: " << db.errorMessage() << '\n';
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Database::insertJob(SqliteConnection& db, sqlite3_stmt* stmt, const Job& job) {
+    if (!isEnriched(job)) {
+        return insertJob(db, stmt, Job(job));
+    }
+
+    // Near-duplicates are rare; they take the copying path, which flags or
+    // drops them.
+    const std::string* original = nearDuplicateOf(job);
+    bool reflag = options.near_duplicates != NearDuplicatePolicy::Keep &&
+                  (!job.duplicate_of.empty() || original);
+
+    if (reflag) {
+        return insertEnrichedJob(db, stmt, Job(job), original);
+    }
+
+    bool counted = countsSalary(db, job);
+    bindJob(stmt, job);
+
+    bool success = sqlite3_step(stmt) == SQLITE_DONE;
+
+    if (!success) {
+        std::cerr << "Insert failed: " << db.errorMessage() << '\n';
+    }
+
+    // The bindings point into `job` (SQLITE_STATIC); drop them right away.
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    success = success && insertTechnologies(db, job);
+
+    if (success) {
+        rememberFingerprint(job);
+        if (counted) {
+            recordSalary(job);
+        }
+        recordRollup(job);
+        recordChange(job);
+    }
+
+    return success;
+}
+
+bool Database::insertJob(SqliteConnection& db, sqlite3_stmt* stmt, Job&& job) {
+    enrichJob(job);
+    const std::string* original = nearDuplicateOf(job);
+
+    return insertEnrichedJob(db, stmt, std::move(job), original);
+}
+
+bool Database::insertEnrichedJob(SqliteConnection& db, sqlite3_stmt* stmt, Job&& job, const std::string* original) {
+    if (options.near_duplicates != NearDuplicatePolicy::Keep) {
+        if (original) {
+            batch_near_duplicates++;
+
+            if (options.near_duplicates == NearDuplicatePolicy::Merge) {
+                return true;
+            }
+
+            job.duplicate_of = *original;
+        } else {
+            job.duplicate_of.clear();
+        }
+    }
+
+    bool counted = countsSalary(db, job);
+    bindJob(stmt, job);
+
+    bool success = sqlite3_step(stmt) == SQLITE_DONE;
+
+    if (!success) {
+        std::cerr << "Insert failed: " << db.errorMessage() << '\n';
+    }
+
+    // Unbind before `job` is moved from: short strings live inside the
+    // object, so their bytes move with it.
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    success = success && insertTechnologies(db, job);
+
+    if (success) {
+        rememberFingerprint(job);
+        if (counted) {
+            recordSalary(job);
+        }
+        recordRollup(job);
+        recordChange(std::move(job));
+    }
+
+    return success;
+}
+
+void Database::createTables() {
+    SqliteConnection& db = connection();
+
+    if (!db.isOpen()) {
+        return;
+    }
+
+    const char* sql = R"(
+        CREATE TABLE IF NOT EXISTS jobs (
+            id TEXT PRIMARY KEY,
+            title TEXT,
+            company_name TEXT,
+            company_id TEXT,
+            location_display TEXT,
+            location_area TEXT,
+            location_country TEXT,
+            salary_min REAL,
+            salary_max REAL,
+            description TEXT,
+            redirect_url TEXT,
+            category TEXT,
+            created TEXT,
+            minhash BLOB,
+            simhash INTEGER,
+            duplicate_of TEXT,
+            last_updated TEXT DEFAULT CURRENT_TIMESTAMP
+        );
+
+        CREATE INDEX IF NOT EXISTS idx_jobs_title ON jobs(title);
+        CREATE INDEX IF NOT EXISTS idx_jobs_company ON jobs(company_name);
+        CREATE INDEX IF NOT EXISTS idx_jobs_location ON jobs(location_display);
+        CREATE INDEX IF NOT EXISTS idx_jobs_salary ON jobs(salary_min, salary_max);
+
+        CREATE TABLE IF NOT EXISTS job_technologies (
+            job_id TEXT NOT NULL,
+            technology TEXT NOT NULL,
+            PRIMARY KEY (job_id, technology)
+        ) WITHOUT ROWID;
+
+        CREATE TABLE IF NOT EXISTS crawl_checkpoints (
+            search_key TEXT PRIMARY KEY,
+            newest_created TEXT,
+            newest_ids TEXT,
+            updated_at TEXT DEFAULT CURRENT_TIMESTAMP
+        );
+
+        CREATE TABLE IF NOT EXISTS salary_stats (
+            slice TEXT PRIMARY KEY,
+            sketch BLOB NOT NULL,
+            updated_at TEXT DEFAULT CURRENT_TIMESTAMP
+        );
+    )";
+
+    db.execute(sql);
+
+    // Columns added after the first release; older files get them here.
+    addColumnIfMissing(db, "minhash", "BLOB");
+    addColumnIfMissing(db, "simhash", "INTEGER");
+    addColumnIfMissing(db, "duplicate_of", "TEXT");
+
+    // The JSON technologies column was replaced by job_technologies.
+    if (hasColumn(db, "technologies")) {
+        const char* drop = sqlite3_libversion_number() >= 3035000 ? kDropTechnologiesSql : kRebuildJobsSql;
+        bool migrated = db.execute("BEGIN") && db.execute(kMigrateTechnologiesSql) && db.execute(drop);
+
+        if (!db.execute(migrated ? "COMMIT" : "ROLLBACK") || !migrated) {
+            std::cerr << "Moving technologies into job_technologies failed.\n";
+        }
+    }
+
+    createFullTextIndex(db);
+    createRollups(db);
+}
+
+bool Database::hasColumn(SqliteConnection& db, const std::string& column) {
+    SqliteConnection::Statement columns = db.prepare("PRAGMA table_info(jobs);");
+
+    if (!columns) {
+        return false;
+    }
+
+    while (sqlite3_step(columns.get()) == SQLITE_ROW) {
+        const unsigned char* name = sqlite3_column_text(columns.get(), 1);
+
+        if (name && column == reinterpret_cast<const char*>(name)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Database::addColumnIfMissing(SqliteConnection& db, const std::string& column, const std::string& type) {
+    if (!hasColumn(db, column)) {
+        db.execute(("ALTER TABLE jobs ADD COLUMN " + column + " " + type + ";").c_str());
+    }
+}
+
+void Database::createFullTextIndex(SqliteConnection& db) {
+    bool existed = false;
+
+    {
+        SqliteConnection::Statement check =
+            db.prepare("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'jobs_fts';");
+
+        if (!check) {
+            return;
+        }
+
+        existed = sqlite3_step(check.get()) == SQLITE_ROW;
+    }
+
+    full_text_search = db.execute(kFullTextSql);
+
+    if (!full_text_search) {
+        std::cerr << "Full-text search unavailable; search() will scan.\n";
+        return;
+    }
+
+    // Index rows stored before the index existed.
+    if (!existed) {
+        db.execute("INSERT INTO jobs_fts (jobs_fts) VALUES ('rebuild');");
+    }
+}
+
+void Database::createRollups(SqliteConnection& db) {
+    bool existed = false;
+
+    {
+        SqliteConnection::Statement check =
+            db.prepare("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'job_rollups';");
+
+        if (!check) {
+            return;
+        }
+
+        existed = sqlite3_step(check.get()) == SQLITE_ROW;
+    }
+
+    market_rollups = db.execute(kRollupSql);
+
+    if (!market_rollups) {
+        std::cerr << "Market rollups unavailable.\n";
+        return;
+    }
+
+    // Summarize rows stored before the rollups existed.
+    if (!existed) {
+        rebuildRollups();
+    }
+}
+
+bool Database::rebuildRollups() {
+    if (!market_rollups) {
+        return false;
+    }
+
+    SqliteConnection& db = connection();
+    pending_job_rollups.clear();
+    pending_company_rollups.clear();
+
+    bool ok = db.execute("BEGIN") && db.execute(kRebuildRollupsSql);
+    return db.execute(ok ? "COMMIT" : "ROLLBACK") && ok;
+}
+
+void Database::recordRollup(const Job& job) {
+    if (!market_rollups || !job.duplicate_of.empty()) {
+        return;
+    }
+
+    std::string day = job.created.substr(0, 10);
+    bool salaried = job.salary_min > 0;
+
+    auto add = [&](std::map<RollupKey, RollupDelta>& pending, const std::string& last) {
+        RollupDelta& delta = pending[RollupKey(day, job.category, job.location.display_name, last)];
+        delta.job_count++;
+
+        if (salaried) {
+            delta.salaried++;
+            delta.salary_min_sum += job.salary_min;
+            delta.salary_max_sum += job.salary_max;
+        }
+    };
+
+    add(pending_job_rollups, "");
+    add(pending_company_rollups, job.company.display_name);
+
+    for (auto it = job.technologies.begin(); it != job.technologies.end(); ++it) {
+        // job_technologies keeps one row per name; count it once too.
+        if (std::find(job.technologies.begin(), it, *it) == it) {
+            add(pending_job_rollups, *it);
+        }
+    }
+}
+
+bool Database::saveRollups(SqliteConnection& db) {
+    return addRollups(db, kAddJobRollupSql, pending_job_rollups) &&
+           addRollups(db, kAddCompanyRollupSql, pending_company_rollups);
+}
+
+bool Database::addRollups(SqliteConnection& db, const char* sql, std::map<RollupKey, RollupDelta>& pending) {
+    if (pending.empty()) {
+        return true;
+    }
+
+    SqliteConnection::Statement stmt = db.prepare(sql);
+
+    if (!stmt) {
+        return false;
+    }
+
+    for (const auto& [key, delta] : pending) {
+        auto bindText = [&](int index, const std::string& value) {
+            sqlite3_bind_text(stmt.get(), index, value.data(), static_cast<int>(value.size()), SQLITE_STATIC);
+        };
+
+        bindText(1, std::get<0>(key));
+        bindText(2, std::get<1>(key));
+        bindText(3, std::get<2>(key));
+        bindText(4, std::get<3>(key));
+        sqlite3_bind_int64(stmt.get(), 5, delta.job_count);
+        sqlite3_bind_int64(stmt.get(), 6, delta.salaried);
+        sqlite3_bind_double(stmt.get(), 7, delta.salary_min_sum);
+        sqlite3_bind_double(stmt.get(), 8, delta.salary_max_sum);
+
+        bool stored = sqlite3_step(stmt.get()) == SQLITE_DONE;
+        sqlite3_reset(stmt.get());
+
+        if (!stored) {
+            std::cerr << "Saving rollups failed: " << db.errorMessage() << '\n';
+            return false;
+        }
+    }
+
+    pending.clear();
+    return true;
+}
+
+bool Database::storeJob(const Job& job) {
+    SqliteConnection& db = connection();
+    SqliteConnection::Statement stmt = db.prepare(kInsertJobSql);
+
+    if (!stmt) {
+        return false;
+    }
+
+    loadSalaryStatistics();
+
+    // The row, its technologies and the aggregates it changed commit
+    // together, or not at all.
+    if (!db.execute("BEGIN")) {
+        return false;
+    }
+
+    return finishBatch(db, insertJob(db, stmt.get(), job));
+}
+
+bool Database::storeJobs(const std::vector<Job>& jobs) {
+    return storeRows(jobs.begin(), jobs.end());
+}
+
+bool Database::storeJobs(std::vector<Job>&& jobs) {
+    bool success = storeRows(std::make_move_iterator(jobs.begin()), std::make_move_iterator(jobs.end()));
+    jobs.clear();
+    return success;
+}
+
+template<typename Iterator>
+bool Database::storeRows(Iterator first, Iterator last) {
+    if (first == last) {
+        return true;
+    }
+
+    SqliteConnection& db = connection();
+    SqliteConnection::Statement stmt = db.prepare(kInsertJobSql);
+
+    if (!stmt) {
+        return false;
+    }
+
+    // Loaded before the transaction, so a first-time rebuild from the jobs
+    // table does not see the rows being written.
+    loadSalaryStatistics();
+
+    // One prepared statement for every row, and one commit (one journal
+    // sync) per batch instead of per row. Changed salary sketches and
+    // rollups are written in the same transaction as the rows they
+    // summarize.
+    if (!db.execute("BEGIN")) {
+        return false;
+    }
+
+    std::size_t in_batch = 0;
+
+    for (; first != last; ++first) {
+        if (!insertJob(db, stmt.get(), *first)) {
+            return finishBatch(db, false);
+        }
+
+        if (++in_batch == options.batch_size) {
+            if (!finishBatch(db, true) || !db.execute("BEGIN")) {
+                return false;
+            }
+
+            in_batch = 0;
+        }
+    }
+
+    return finishBatch(db, true);
+}
+
+bool Database::finishBatch(SqliteConnection& db, bool success) {
+    success = success && saveBatchSalaries(db) && saveRollups(db) && db.execute("COMMIT");
+
+    if (success) {
+        applyBatch();
+        return true;
+    }
+
+    // A failed COMMIT can leave the transaction open (e.g. SQLITE_BUSY);
+    // some errors have already rolled it back.
+    if (!sqlite3_get_autocommit(db.handle())) {
+        db.execute("ROLLBACK");
+    }
+
+    discardBatch();
+    return false;
+}
+
+void Database::applyBatch() {
+    for (const auto& id : batch_ids) {
+        rememberId(id);
+    }
+
+    if (!cache_dirty) {
+        for (auto& row : batch_changes) {
+            pending_changes.push_back(std::move(row));
+        }
+    }
+
+    if (fingerprints_loaded) {
+        fingerprints.addAll(batch_fingerprints);
+    }
+
+    if (salary_statistics_loaded) {
+        salary_statistics.merge(batch_salaries);
+
+        // Already written by saveBatchSalaries.
+        salary_statistics.takeChanged();
+    }
+
+    near_duplicate_count += batch_near_duplicates;
+    discardBatch();
+}
+
+void Database::discardBatch() {
+    batch_changes.clear();
+    batch_ids.clear();
+    batch_fingerprints.clear();
+    batch_salaries.clear();
+    batch_near_duplicates = 0;
+    pending_job_rollups.clear();
+    pending_company_rollups.clear();
+}
+
+void Database::rememberId(const std::string& job_id) {
+    if (!known_ids_loaded) {
+        return;
+    }
+
+    known_ids.add(job_id);
+
+    // Past its capacity the filter lets too much through; size it anew on
+    // the next lookup.
+    if (known_ids.saturated()) {
+        known_ids_loaded = false;
+    }
+}
+
+void Database::recordChange(const Job& row) {
+    if (known_ids_loaded) {
+        batch_ids.insert(row.id);
+    }
+
+    // Nothing to patch until the cache has been loaded once.
+    if (!cache_dirty) {
+        batch_changes.push_back(row);
+    }
+}
+
+void Database::recordChange(Job&& row) {
+    if (known_ids_loaded) {
+        batch_ids.insert(row.id);
+    }
+
+    if (!cache_dirty) {
+        batch_changes.push_back(std::move(row));
+    }
+}
+
+const std::vector<Job>& Database::loadJobs() {
+    if (cache_dirty) {
+        updateCache();
+    } else {
+        applyPendingChanges();
+    }
+
+    return *job_cache;
+}
+
+std::shared_ptr<const std::vector<Job>> Database::snapshot() {
+    loadJobs();
+    return job_cache;
+}
+
+void Database::applyPendingChanges() {
+    if (pending_changes.empty()) {
+        return;
+    }
+
+    // Scratch sets for this batch: views of ids, all nodes carved from one
+    // arena and released together on return.
+    std::pmr::monotonic_buffer_resource arena(pending_changes.size() * kArenaBytesPerChange);
+
+    // Last write wins when an id was stored more than once: walking
+    // backwards, the first sighting of an id is its latest write.
+    std::vector<bool> latest(pending_changes.size(), false);
+    std::size_t latest_count = 0;
+
+    {
+        std::pmr::unordered_set<std::string_view> seen(&arena);
+        seen.reserve(pending_changes.size());
+
+        for (std::size_t i = pending_changes.size(); i-- > 0;) {
+            if (seen.insert(pending_changes[i].id).second) {
+                latest[i] = true;
+                latest_count++;
+            }
+        }
+    }
+
+    std::vector<Job> added;
+    added.reserve(latest_count);
+
+    for (std::size_t i = 0; i < pending_changes.size(); i++) {
+        if (latest[i]) {
+            added.push_back(std::move(pending_changes[i]));
+        }
+    }
+
+    pending_changes.clear();
+
+    if (job_cache.use_count() > 1) {
+        job_cache = std::make_shared<std::vector<Job>>(*job_cache);
+    }
+
+    std::vector<Job>& cache = *job_cache;
+
+    // Drop the rows that were replaced.
+    std::vector<const Job*> replaced;
+
+    for (const auto& job : added) {
+        if (cached_created.count(job.id) > 0) {
+            replaced.push_back(&job);
+        }
+    }
+
+    if (replaced.size() > kPointUpdateLimit) {
+        std::pmr::unordered_set<std::string_view> replaced_ids(&arena);
+        replaced_ids.reserve(replaced.size());
+
+        for (const Job* job : replaced) {
+            replaced_ids.insert(job->id);
+        }
+
+        cache.erase(std::remove_if(cache.begin(), cache.end(),
+                                   [&](const Job& job) { return replaced_ids.count(job.id) > 0; }),
+                    cache.end());
+    } else {
+        for (const Job* job : replaced) {
+            Job probe;
+            probe.created = cached_created[job->id];
+
+            auto range = std::equal_range(cache.begin(), cache.end(), probe, newerFirst);
+            auto it = std::find_if(range.first, range.second,
+                                   [&](const Job& row) { return row.id == job->id; });
+
+            if (it != range.second) {
+                cache.erase(it);
+            }
+        }
+    }
+
+    // Insert the new rows in created order.
+    std::stable_sort(added.begin(), added.end(), newerFirst);
+
+    for (const auto& job : added) {
+        cached_created[job.id] = job.created;
+    }
+
+    if (added.size() > kPointUpdateLimit) {
+        std::vector<Job> merged;
+        merged.reserve(cache.size() + added.size());
+        std::merge(std::make_move_iterator(cache.begin()), std::make_move_iterator(cache.end()),
+                   std::make_move_iterator(added.begin()), std::make_move_iterator(added.end()),
+                   std::back_inserter(merged), newerFirst);
+        cache.swap(merged);
+    } else {
+        for (auto& job : added) {
+            auto position = std::upper_bound(cache.begin(), cache.end(), job, newerFirst);
+            cache.insert(position, std::move(job));
+        }
+    }
+}
+
+void Database::updateCache() {
+    // A fresh vector, so snapshots handed out earlier stay untouched.
+    job_cache = std::make_shared<std::vector<Job>>();
+    cached_created.clear();
+    pending_changes.clear();
+
+    SqliteConnection& db = connection();
+
+    // Size the cache up front rather than regrowing it while reading.
+    {
+        SqliteConnection::Statement count = db.prepare("SELECT COUNT(*) FROM jobs;");
+
+        if (count && sqlite3_step(count.get()) == SQLITE_ROW) {
+            std::size_t rows = static_cast<std::size_t>(sqlite3_column_int64(count.get(), 0));
+            job_cache->reserve(rows);
+            cached_created.reserve(rows);
+        }
+    }
+
+    SqliteConnection::Statement select = db.prepare(kSelectJobsSql);
+
+    if (!select) {
+        return;
+    }
+
+    sqlite3_stmt* stmt = select.get();
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        Job job = readJob(stmt);
+
+        cached_created[job.id] = job.created;
+        job_cache->push_back(std::move(job));
+    }
+
+    cache_dirty = false;
+}
+
+bool Database::exportSnapshot(const std::string& path) {
+    return JobSnapshot::write(path, loadJobs());
+}
+
+bool Database::importSnapshot(const std::string& path) {
+    JobSnapshot archive;
+
+    if (!archive.open(path)) {
+        return false;
+    }
+
+    // A bounded batch at a time, so a large archive is never all in memory.
+    // Rows are newest first; storing them oldest first puts each original
+    // in the near-duplicate index before the reposts checked against it.
+    const std::size_t batch_rows = 10000;
+    std::vector<Job> batch;
+
+    for (std::size_t done = 0; done < archive.size(); done += batch_rows) {
+        std::size_t count = std::min(batch_rows, archive.size() - done);
+        batch.clear();
+        batch.reserve(count);
+
+        for (std::size_t i = 0; i < count; i++) {
+            batch.push_back(archive.job(archive.size() - 1 - done - i));
+        }
+
+        if (!storeJobs(std::move(batch))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Database::clearCache() {
+    job_cache = std::make_shared<std::vector<Job>>();
+    cached_created.clear();
+    pending_changes.clear();
+    cache_dirty = true;
+}
+
+void Database::refreshCache() {
+    cache_dirty = true;
+    known_ids_loaded = false;
+    fingerprints_loaded = false;
+    salary_statistics_loaded = false;
+    updateCache();
+}
 
-void Database::initializeDatabase() {
-    createTables();
+bool Database::isJobExists(const std::string& job_id) {
+    SqliteConnection::Statement stmt = connection().prepare(kJobExistsSql);
+
+    if (!stmt) {
+        return false;
+    }
+
+    sqlite3_bind_text(stmt.get(), 1, job_id.c_str(), -1, SQLITE_TRANSIENT);
+
+    return sqlite3_step(stmt.get()) == SQLITE_ROW;
 }
 
-void Database::createTables() {
-    sqlite3* db = nullptr;
+const std::string* Database::nearDuplicateOf(const Job& job) {
+    if (options.near_duplicates == NearDuplicatePolicy::Keep || job.simhash == 0) {
+        return nullptr;
+    }
+
+    if (!fingerprints_loaded) {
+        loadFingerprints();
+    }
+
+    // Committed originals first: they are older than this transaction's.
+    const std::string* original = fingerprints.find(job.simhash, job.id);
+    return original ? original : batch_fingerprints.find(job.simhash, job.id);
+}
+
+void Database::rememberFingerprint(const Job& job) {
+    if (fingerprints_loaded && job.simhash != 0 && job.duplicate_of.empty()) {
+        batch_fingerprints.add(job.simhash, job.id);
+    }
+}
+
+void Database::loadFingerprints() {
+    fingerprints.clear();
+    addFingerprints(fingerprints);
+    fingerprints_loaded = true;
+}
 
-    if (sqlite3_open(database_path.c_str(), &db) != SQLITE_OK) {
-        std::cerr << "Cannot open database: " << sqlite3_errmsg(db) << '\n';
-        sqlite3_close(db);
+void Database::addFingerprints(NearDuplicateIndex& index) {
+    SqliteConnection::Statement select = connection().prepare(kLoadFingerprintsSql);
+
+    if (!select) {
         return;
     }
 
-    const char* sql = R"(
-        CREATE TABLE IF NOT EXISTS jobs (
-            id TEXT PRIMARY KEY,
-            title TEXT,
-            company_name TEXT,
-            company_id TEXT,
-            location_display TEXT,
-            location_area TEXT,
-            location_country TEXT,
-            salary_min REAL,
-            salary_max REAL,
-            description TEXT,
-            redirect_url TEXT,
-            technologies TEXT,
-            category TEXT,
-            created TEXT,
-            last_updated TEXT DEFAULT CURRENT_TIMESTAMP
-        );
+    sqlite3_stmt* stmt = select.get();
 
-        CREATE INDEX IF NOT EXISTS idx_jobs_title ON jobs(title);
-        CREATE INDEX IF NOT EXISTS idx_jobs_company ON jobs(company_name);
-        CREATE INDEX IF NOT EXISTS idx_jobs_location ON jobs(location_display);
-        CREATE INDEX IF NOT EXISTS idx_jobs_salary ON jobs(salary_min, salary_max);
-    )";
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const unsigned char* id = sqlite3_column_text(stmt, 0);
+
+        if (!id) {
+            continue;
+        }
+
+        std::uint64_t fingerprint = static_cast<std::uint64_t>(sqlite3_column_int64(stmt, 1));
+
+        if (sqlite3_column_type(stmt, 1) == SQLITE_NULL) {
+            Job job;
+            auto text = [&](int col) {
+                const unsigned char* value = sqlite3_column_text(stmt, col);
+                return value ? std::string(reinterpret_cast<const char*>(value)) : std::string();
+            };
+
+            job.title = text(2);
+            job.company.display_name = text(3);
+            job.location.display_name = text(4);
+            job.description = text(5);
+            fingerprint = SimHash::fingerprint(job);
+        }
+
+        if (fingerprint != 0) {
+            index.add(fingerprint, reinterpret_cast<const char*>(id));
+        }
+    }
+}
+
+void Database::loadKnownIds() {
+    SqliteConnection& db = connection();
+    std::size_t row_count = 0;
+
+    {
+        SqliteConnection::Statement count = db.prepare("SELECT COUNT(*) FROM jobs;");
+
+        if (count && sqlite3_step(count.get()) == SQLITE_ROW) {
+            row_count = static_cast<std::size_t>(sqlite3_column_int64(count.get(), 0));
+        }
+    }
+
+    known_ids = BloomFilter(std::max(kMinKnownIds, row_count * 2), kKnownIdsFalsePositiveRate);
 
-    char* error_message = nullptr;
+    SqliteConnection::Statement select = db.prepare("SELECT id FROM jobs;");
 
-    if (sqlite3_exec(db, sql, nullptr, nullptr, &error_message) != SQLITE_OK) {
-        std::cerr << "SQL error: " << error_message << '\n';
-        sqlite3_free(error_message);
+    if (!select) {
+        return;
+    }
+
+    while (sqlite3_step(select.get()) == SQLITE_ROW) {
+        const unsigned char* id = sqlite3_column_text(select.get(), 0);
+
+        if (id) {
+            known_ids.add(reinterpret_cast<const char*>(id));
+        }
     }
 
-    sqlite3_close(db);
+    known_ids_loaded = true;
 }
 
-bool Database::storeJob(const Job& job) {
-    sqlite3* db = nullptr;
+std::unordered_set<std::string> Database::findExistingJobs(const std::vector<std::string>& job_ids) {
+    std::unordered_set<std::string> existing;
+
+    if (job_ids.empty()) {
+        return existing;
+    }
+
+    if (!known_ids_loaded) {
+        loadKnownIds();
+    }
+
+    // Candidates are bound kExistingJobsBatch at a time; the unused
+    // placeholders of the last batch stay NULL and match nothing.
+    SqliteConnection::Statement select = connection().prepare(existingJobsSql());
+
+    if (!select) {
+        return existing;
+    }
+
+    sqlite3_stmt* stmt = select.get();
+    int bound = 0;
+
+    auto run = [&]() {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const unsigned char* id = sqlite3_column_text(stmt, 0);
+
+            if (id) {
+                existing.insert(reinterpret_cast<const char*>(id));
+            }
+        }
+
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        bound = 0;
+    };
+
+    for (const auto& id : job_ids) {
+        if (known_ids_loaded && !known_ids.mightContain(id)) {
+            continue;
+        }
+
+        sqlite3_bind_text(stmt, ++bound, id.data(), static_cast<int>(id.size()), SQLITE_STATIC);
+
+        if (bound == kExistingJobsBatch) {
+            run();
+        }
+    }
+
+    if (bound > 0) {
+        run();
+    }
+
+    return existing;
+}
 
-    if (sqlite3_open(database_path.c_str(), &db) != SQLITE_OK) {
-        std::cerr << "Cannot open database: " << sqlite3_errmsg(db) << '\n';
-        sqlite3_close(db);
+bool Database::countsSalary(SqliteConnection& db, const Job& job) {
+    if (!salary_statistics_loaded || !job.duplicate_of.empty() || SalaryStatistics::salaryOf(job) <= 0) {
         return false;
     }
 
-    const char* sql = R"(
-        INSERT OR REPLACE INTO jobs
-        (
-            id,
-            title,
-            company_name,
-            company_id,
-            location_display,
-            location_area,
-            location_country,
-            salary_min,
-            salary_max,
-            description,
-            redirect_url,
-            technologies,
-            category,
-            created,
-            last_updated
-        )
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, CURRENT_TIMESTAMP);
-    )";
+    // The filter only learns this transaction's ids once it commits.
+    if (known_ids_loaded && !known_ids.mightContain(job.id) && batch_ids.count(job.id) == 0) {
+        return true;
+    }
 
-    sqlite3_stmt* stmt = nullptr;
+    SqliteConnection::Statement stmt = db.prepare(kJobExistsSql);
 
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
-        std::cerr << "Prepare failed: " << sqlite3_errmsg(db) << '\n';
-        sqlite3_close(db);
+    if (!stmt) {
         return false;
     }
 
-    auto technologies = JobParser::extractTechnologies(job.description);
-    std::string technologies_json = json(technologies).dump();
-    std::string category = JobParser::categorizeJob(job);
+    sqlite3_bind_text(stmt.get(), 1, job.id.data(), static_cast<int>(job.id.size()), SQLITE_STATIC);
 
-    sqlite3_bind_text(stmt, 1, job.id.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, job.title.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 3, job.company.display_name.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 4, job.company.id.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 5, job.location.display_name.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 6, job.location.area.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 7, job.location.country.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_double(stmt, 8, job.salary_min);
-    sqlite3_bind_double(stmt, 9, job.salary_max);
-    sqlite3_bind_text(stmt, 10, job.description.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 11, job.redirect_url.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 12, technologies_json.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 13, category.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 14, job.created.c_str(), -1, SQLITE_TRANSIENT);
+    return sqlite3_step(stmt.get()) != SQLITE_ROW;
+}
 
-    bool success = sqlite3_step(stmt) == SQLITE_DONE;
+void Database::recordSalary(const Job& job) {
+    if (salary_statistics_loaded && job.duplicate_of.empty()) {
+        batch_salaries.add(job);
+    }
+}
 
-    if (!success) {
-        std::cerr << "Insert failed: " << sqlite3_errmsg(db) << '\n';
+void Database::loadSalaryStatistics() {
+    if (salary_statistics_loaded) {
+        return;
     }
 
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
+    SqliteConnection& db = connection();
+    SqliteConnection::Statement select = db.prepare(kLoadSalaryStatsSql);
 
-    cache_dirty = true;
-    return success;
-}
+    if (!select) {
+        return;
+    }
 
-bool Database::storeJobs(const std::vector<Job>& jobs) {
-    bool all_success = true;
+    salary_statistics.clear();
+    bool any = false;
+
+    while (sqlite3_step(select.get()) == SQLITE_ROW) {
+        const unsigned char* slice = sqlite3_column_text(select.get(), 0);
+        const char* blob = static_cast<const char*>(sqlite3_column_blob(select.get(), 1));
+        std::size_t size = static_cast<std::size_t>(sqlite3_column_bytes(select.get(), 1));
+        SalarySketch sketch;
+
+        if (!slice || !sketch.deserialize(blob, size)) {
+            std::cerr << "Discarding unreadable salary statistics; rebuilding.\n";
 
-    for (const auto& job : jobs) {
-        if (!storeJob(job)) {
-            all_success = false;
+            // The rebuild rewrites salary_stats, which this statement is
+            // still reading.
+            sqlite3_reset(select.get());
+            rebuildSalaryStatistics();
+            return;
         }
+
+        salary_statistics.setSlice(reinterpret_cast<const char*>(slice), std::move(sketch));
+        any = true;
     }
 
-    return all_success;
+    salary_statistics_loaded = true;
+
+    // A database from before the table existed: summarize its rows once.
+    if (!any) {
+        rebuildSalaryStatistics();
+    }
 }
 
-std::vector<Job> Database::loadJobs() {
-    if (!cache_dirty) {
-        return job_cache;
+bool Database::saveSalaryStatistics(SqliteConnection& db) {
+    std::set<std::string> changed = salary_statistics.takeChanged();
+
+    if (changed.empty()) {
+        return true;
     }
 
-    updateCache();
-    return job_cache;
-}
+    SqliteConnection::Statement stmt = db.prepare(kSaveSalaryStatsSql);
 
-void Database::updateCache() {
-    job_cache.clear();
+    if (!stmt) {
+        return false;
+    }
 
-    sqlite3* db = nullptr;
+    std::string blob;
 
-    if (sqlite3_open(database_path.c_str(), &db) != SQLITE_OK) {
-        std::cerr << "Cannot open database: " << sqlite3_errmsg(db) << '\n';
-        sqlite3_close(db);
-        return;
+    for (const auto& key : changed) {
+        auto it = salary_statistics.allSlices().find(key);
+
+        if (it == salary_statistics.allSlices().end()) {
+            continue;
+        }
+
+        it->second.serialize(blob);
+
+        sqlite3_bind_text(stmt.get(), 1, key.data(), static_cast<int>(key.size()), SQLITE_STATIC);
+        sqlite3_bind_blob(stmt.get(), 2, blob.data(), static_cast<int>(blob.size()), SQLITE_STATIC);
+
+        bool stored = sqlite3_step(stmt.get()) == SQLITE_DONE;
+        sqlite3_reset(stmt.get());
+        sqlite3_clear_bindings(stmt.get());
+
+        if (!stored) {
+            std::cerr << "Saving salary statistics failed: " << db.errorMessage() << '\n';
+            return false;
+        }
     }
 
-    const char* sql = R"(
-        SELECT
-            id,
-            title,
-            company_name,
-            company_id,
-            location_display,
-            location_area,
-            location_country,
-            salary_min,
-            salary_max,
-            description,
-            redirect_url,
-            technologies,
-            category,
-            created
-        FROM jobs
-        ORDER BY created DESC;
-    )";
+    return true;
+}
 
-    sqlite3_stmt* stmt = nullptr;
+bool Database::rebuildSalaryStatistics() {
+    SqliteConnection& db = connection();
+    SqliteConnection::Statement select = db.prepare(kSalaryRowsSql);
 
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
-        std::cerr << "Prepare failed: " << sqlite3_errmsg(db) << '\n';
-        sqlite3_close(db);
-        return;
+    if (!select) {
+        return false;
     }
 
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        Job job;
+    salary_statistics.clear();
+
+    sqlite3_stmt* stmt = select.get();
+    Job job;
 
-        auto textAt = [&](int col) -> std::string {
-            const unsigned char* text = sqlite3_column_text(stmt, col);
-            return text ? reinterpret_cast<const char*>(text) : "";
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        auto text = [&](int col, std::string& field) {
+            const unsigned char* value = sqlite3_column_text(stmt, col);
+            field.assign(value ? reinterpret_cast<const char*>(value) : "");
         };
 
-        job.id = textAt(0);
-        job.title = textAt(1);
-        job.company.display_name = textAt(2);
-        job.company.id = textAt(3);
-        job.location.display_name = textAt(4);
-        job.location.area = textAt(5);
-        job.location.country = textAt(6);
-        job.salary_min = sqlite3_column_double(stmt, 7);
-        job.salary_max = sqlite3_column_double(stmt, 8);
-        job.description = textAt(9);
-        job.redirect_url = textAt(10);
-
-        try {
-            json technologies = json::parse(textAt(11));
-
-            if (technologies.is_array()) {
-                for (const auto& tech : technologies) {
-                    if (tech.is_string()) {
-                        job.technologies.push_back(tech.get<std::string>());
-                    }
-                }
+        job.salary_min = sqlite3_column_double(stmt, 0);
+        job.salary_max = sqlite3_column_double(stmt, 1);
+
+        if (SalaryStatistics::salaryOf(job) <= 0) {
+            continue;
+        }
+
+        text(2, job.category);
+        text(3, job.location.display_name);
+        job.technologies.clear();
+
+        const unsigned char* technologies = sqlite3_column_text(stmt, 4);
+
+        if (technologies) {
+            thread_local StringArrayReader reader;
+
+            if (!reader.read(reinterpret_cast<const char*>(technologies),
+                             static_cast<std::size_t>(sqlite3_column_bytes(stmt, 4)),
+                             job.technologies)) {
+                job.technologies.clear();
             }
-        } catch (...) {
-            job.technologies.clear();
         }
 
-        job.created = textAt(13);
+        salary_statistics.add(job);
+    }
+
+    salary_statistics_loaded = true;
 
-        job_cache.push_back(job);
+    // Replace the stored slices wholesale: slices with no rows left go too.
+    bool ok = db.execute("BEGIN") && db.execute("DELETE FROM salary_stats;");
+    ok = saveSalaryStatistics(db) && ok;
+    return db.execute(ok ? "COMMIT" : "ROLLBACK") && ok;
+}
+
+bool Database::saveBatchSalaries(SqliteConnection& db) {
+    std::set<std::string> changed = batch_salaries.takeChanged();
+
+    if (changed.empty()) {
+        return true;
     }
 
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
+    SqliteConnection::Statement stmt = db.prepare(kSaveSalaryStatsSql);
 
-    cache_dirty = false;
+    if (!stmt) {
+        return false;
+    }
+
+    std::string blob;
+
+    for (const auto& key : changed) {
+        auto added = batch_salaries.allSlices().find(key);
+
+        if (added == batch_salaries.allSlices().end()) {
+            continue;
+        }
+
+        // The same merge applyBatch does once this commits.
+        auto committed = salary_statistics.allSlices().find(key);
+        SalarySketch merged = committed != salary_statistics.allSlices().end() ? committed->second : SalarySketch();
+        merged.merge(added->second);
+        merged.serialize(blob);
+
+        sqlite3_bind_text(stmt.get(), 1, key.data(), static_cast<int>(key.size()), SQLITE_STATIC);
+        sqlite3_bind_blob(stmt.get(), 2, blob.data(), static_cast<int>(blob.size()), SQLITE_STATIC);
+
+        bool stored = sqlite3_step(stmt.get()) == SQLITE_DONE;
+        sqlite3_reset(stmt.get());
+        sqlite3_clear_bindings(stmt.get());
+
+        if (!stored) {
+            std::cerr << "Saving salary statistics failed: " << db.errorMessage() << '\n';
+            return false;
+        }
+    }
+
+    return true;
 }
 
-void Database::clearCache() {
-    job_cache.clear();
-    cache_dirty = true;
+const SalaryStatistics& Database::salaryStatistics() {
+    loadSalaryStatistics();
+    return salary_statistics;
 }
 
-void Database::refreshCache() {
-    cache_dirty = true;
-    updateCache();
+std::map<std::string, MarketTotals> Database::dailyTotals(const RollupFilters& filters) {
+    std::map<std::string, MarketTotals> totals;
+
+    if (!market_rollups) {
+        return totals;
+    }
+
+    // The technology = '' rows count every job exactly once.
+    std::string sql = "SELECT day, SUM(job_count), SUM(salaried), SUM(salary_min_sum), SUM(salary_max_sum)"
+                      " FROM job_rollups WHERE technology = ''" +
+                      rollupConditions(filters) + " GROUP BY day HAVING SUM(job_count) > 0;";
+
+    SqliteConnection::Statement select = connection().prepare(sql);
+
+    if (!select) {
+        return totals;
+    }
+
+    sqlite3_stmt* stmt = select.get();
+    bindRollupFilters(stmt, filters);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const unsigned char* day = sqlite3_column_text(stmt, 0);
+        MarketTotals& day_totals = totals[day ? reinterpret_cast<const char*>(day) : ""];
+
+        day_totals.jobs = static_cast<std::size_t>(sqlite3_column_int64(stmt, 1));
+        day_totals.salaried = static_cast<std::size_t>(sqlite3_column_int64(stmt, 2));
+
+        if (day_totals.salaried > 0) {
+            day_totals.average_salary_min = sqlite3_column_double(stmt, 3) / static_cast<double>(day_totals.salaried);
+            day_totals.average_salary_max = sqlite3_column_double(stmt, 4) / static_cast<double>(day_totals.salaried);
+        }
+    }
+
+    return totals;
 }
 
-bool Database::isJobExists(const std::string& job_id) {
-    sqlite3* db = nullptr;
+std::map<std::string, int> Database::technologyCounts(const RollupFilters& filters) {
+    return rollupCounts("SELECT technology, SUM(job_count) FROM job_rollups WHERE technology <> ''" +
+                            rollupConditions(filters) + " GROUP BY technology HAVING SUM(job_count) > 0;",
+                        filters);
+}
+
+std::map<std::string, int> Database::companyCounts(const RollupFilters& filters) {
+    return rollupCounts("SELECT company, SUM(job_count) FROM company_rollups WHERE company <> ''" +
+                            rollupConditions(filters) + " GROUP BY company HAVING SUM(job_count) > 0;",
+                        filters);
+}
+
+std::map<std::string, int> Database::rollupCounts(const std::string& sql, const RollupFilters& filters) {
+    std::map<std::string, int> counts;
+
+    if (!market_rollups) {
+        return counts;
+    }
+
+    SqliteConnection::Statement select = connection().prepare(sql);
 
-    if (sqlite3_open(database_path.c_str(), &db) != SQLITE_OK) {
-        std::cerr << "Cannot open database: " << sqlite3_errmsg(db) << '\n';
-        sqlite3_close(db);
+    if (!select) {
+        return counts;
+    }
+
+    sqlite3_stmt* stmt = select.get();
+    bindRollupFilters(stmt, filters);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const unsigned char* key = sqlite3_column_text(stmt, 0);
+
+        if (key) {
+            counts[reinterpret_cast<const char*>(key)] = sqlite3_column_int(stmt, 1);
+        }
+    }
+
+    return counts;
+}
+
+bool Database::loadCheckpoint(const std::string& search_key, CrawlCheckpoint& checkpoint) {
+    SqliteConnection::Statement select = connection().prepare(kLoadCheckpointSql);
+
+    if (!select) {
+        return false;
+    }
+
+    sqlite3_bind_text(select.get(), 1, search_key.c_str(), -1, SQLITE_TRANSIENT);
+
+    if (sqlite3_step(select.get()) != SQLITE_ROW) {
+        return false;
+    }
+
+    const unsigned char* created = sqlite3_column_text(select.get(), 0);
+    const unsigned char* ids = sqlite3_column_text(select.get(), 1);
+
+    checkpoint = CrawlCheckpoint();
+    checkpoint.newest_created = created ? reinterpret_cast<const char*>(created) : "";
+
+    try {
+        json parsed = json::parse(ids ? reinterpret_cast<const char*>(ids) : "[]");
+
+        for (const auto& id : parsed) {
+            if (id.is_string()) {
+                checkpoint.newest_ids.push_back(id.get<std::string>());
+            }
+        }
+    } catch (...) {
+        checkpoint.newest_ids.clear();
+    }
+
+    return true;
+}
+
+bool Database::saveCheckpoint(const std::string& search_key, const CrawlCheckpoint& checkpoint) {
+    SqliteConnection& db = connection();
+    SqliteConnection::Statement stmt = db.prepare(kSaveCheckpointSql);
+
+    if (!stmt) {
         return false;
     }
 
-    const char* sql = "SELECT 1 FROM jobs WHERE id = ? LIMIT 1;";
+    std::string ids_json = json(checkpoint.newest_ids).dump();
 
-    sqlite3_stmt* stmt = nullptr;
+    sqlite3_bind_text(stmt.get(), 1, search_key.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 2, checkpoint.newest_created.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 3, ids_json.c_str(), -1, SQLITE_TRANSIENT);
 
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
-        std::cerr << "Prepare failed: " << sqlite3_errmsg(db) << '\n';
-        sqlite3_close(db);
+    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+        std::cerr << "Saving crawl checkpoint failed: " << db.errorMessage() << '\n';
         return false;
     }
 
-    sqlite3_bind_text(stmt, 1, job_id.c_str(), -1, SQLITE_TRANSIENT);
+    return true;
+}
+
+std::vector<Job> Database::search(const std::string& query,
+                                  const SearchFilters& filters,
+                                  int limit,
+                                  std::vector<double>* scores) {
+    std::vector<Job> results;
+
+    if (scores) {
+        scores->clear();
+    }
+
+    SqliteConnection& db = connection();
+
+    if (!db.isOpen() || limit <= 0) {
+        return results;
+    }
+
+    // The SQL text only depends on which filters are set, so each shape is
+    // prepared once and then served from the statement cache.
+    bool use_index = full_text_search && !query.empty();
+    std::string sql = std::string("SELECT") + kJobColumnsSql;
+
+    if (use_index) {
+        sql += ", bm25(jobs_fts, 10.0, 1.0) FROM jobs_fts JOIN jobs j ON j.rowid = jobs_fts.rowid WHERE jobs_fts MATCH ?";
+    } else if (!query.empty()) {
+        sql += "FROM jobs j WHERE (j.title LIKE ? ESCAPE '\\' OR j.description LIKE ? ESCAPE '\\')";
+    } else {
+        sql += "FROM jobs j WHERE 1";
+    }
+
+    if (filters.min_salary > 0) sql += " AND j.salary_min >= ?";
+    if (filters.max_salary > 0) sql += " AND j.salary_max <= ?";
+    if (!filters.location.empty()) sql += " AND j.location_display LIKE ? ESCAPE '\\'";
+    if (!filters.category.empty()) sql += " AND j.category = ?";
+    if (!filters.created_after.empty()) sql += " AND j.created > ?";
+    if (!filters.include_duplicates) sql += " AND j.duplicate_of IS NULL";
+
+    sql += use_index ? " ORDER BY bm25(jobs_fts, 10.0, 1.0)" : " ORDER BY j.created DESC";
+    sql += " LIMIT ?;";
+
+    SqliteConnection::Statement select = db.prepare(sql);
+
+    if (!select) {
+        return results;
+    }
+
+    sqlite3_stmt* stmt = select.get();
+    int index = 1;
+
+    if (use_index) {
+        std::string match = filters.raw_query ? query : quotedTerms(query);
+        sqlite3_bind_text(stmt, index++, match.c_str(), -1, SQLITE_TRANSIENT);
+    } else if (!query.empty()) {
+        std::string pattern = containsPattern(query);
+        sqlite3_bind_text(stmt, index++, pattern.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, index++, pattern.c_str(), -1, SQLITE_TRANSIENT);
+    }
+
+    if (filters.min_salary > 0) {
+        sqlite3_bind_double(stmt, index++, filters.min_salary);
+    }
+
+    if (filters.max_salary > 0) {
+        sqlite3_bind_double(stmt, index++, filters.max_salary);
+    }
+
+    if (!filters.location.empty()) {
+        std::string pattern = containsPattern(filters.location);
+        sqlite3_bind_text(stmt, index++, pattern.c_str(), -1, SQLITE_TRANSIENT);
+    }
+
+    if (!filters.category.empty()) {
+        sqlite3_bind_text(stmt, index++, filters.category.c_str(), -1, SQLITE_TRANSIENT);
+    }
+
+    if (!filters.created_after.empty()) {
+        sqlite3_bind_text(stmt, index++, filters.created_after.c_str(), -1, SQLITE_TRANSIENT);
+    }
+
+    sqlite3_bind_int(stmt, index, limit);
+
+    int rc;
+
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        results.push_back(readJob(stmt));
+
+        if (use_index && scores) {
+            scores->push_back(sqlite3_column_double(stmt, kJobColumnCount));
+        }
+    }
 
-    bool exists = sqlite3_step(stmt) == SQLITE_ROW;
+    if (rc != SQLITE_DONE) {
+        std::cerr << "Search failed: " << db.errorMessage() << '\n';
+        results.clear();
 
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
+        if (scores) {
+            scores->clear();
+        }
+    }
 
-    return exists;
+    return results;
 }
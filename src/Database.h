@@ -1,34 +1,329 @@
 #ifndef DATABASE_H
 #define DATABASE_H
 
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "BloomFilter.h"
+#include "NearDuplicateIndex.h"
+#include "SalarySketch.h"
+#include "SqliteConnection.h"
 #include "model/Job.h"
 
+// What storeJob(s) does with a job whose SimHash is within
+// NearDuplicateIndex::kMaxDistance bits of an already stored one under a
+// different id.
+enum class NearDuplicatePolicy {
+    Keep,   // store it like any other job
+    Flag,   // store it with duplicate_of set to the original's id
+    Merge   // do not store it
+};
+
+struct DatabaseOptions {
+    // Rows per transaction in storeJobs; each commit costs one journal sync.
+    std::size_t batch_size = 500;
+
+    // journal_mode=WAL plus synchronous=NORMAL: commits no longer fsync the
+    // database file, at the cost of possibly losing the last transactions
+    // (but never corrupting the file) on power loss.
+    bool write_ahead_log = false;
+
+    // Give every calling thread its own connection (and statement cache)
+    // instead of sharing one. Then, and only then, isJobExists, search,
+    // loadCheckpoint, dailyTotals, technologyCounts and companyCounts may
+    // run on several threads at once: they touch nothing but their own
+    // connection. Every other method reads or updates the caches and
+    // indexes below and must still be serialized by the caller, against
+    // each other and against those readers.
+    bool per_thread_connections = false;
+
+    NearDuplicatePolicy near_duplicates = NearDuplicatePolicy::Flag;
+};
+
+// Optional predicates for Database::search, applied in SQL. Zero / empty
+// means "no constraint".
+struct SearchFilters {
+    double min_salary = 0.0;     // salary_min at least this
+    double max_salary = 0.0;     // salary_max at most this
+    std::string location;        // substring of the location, any case
+    std::string category;        // exact category, e.g. "Backend"
+    std::string created_after;   // ISO date/time, compared as text
+    bool include_duplicates = false; // also return flagged near-duplicates
+    bool raw_query = false;      // pass the query to FTS5 MATCH unquoted
+};
+
+// Restricts the rollup queries; empty fields match everything. Days are
+// the date part of Job::created ("YYYY-MM-DD"), both ends inclusive.
+struct RollupFilters {
+    std::string first_day;
+    std::string last_day;
+    std::string category;   // exact category, e.g. "Backend"
+    std::string location;   // exact location display name
+};
+
+// Job count and salary averages of one slice of the rollups. The averages
+// cover the `salaried` jobs, those with a minimum salary.
+struct MarketTotals {
+    std::size_t jobs = 0;
+    std::size_t salaried = 0;
+    double average_salary_min = 0.0;
+    double average_salary_max = 0.0;
+};
+
+// How far an incremental crawl of one search got: the newest posting date
+// it saw, and the ids posted at exactly that time (several postings can
+// share a timestamp, so the date alone cannot tell which were seen).
+struct CrawlCheckpoint {
+    std::string newest_created;
+    std::vector<std::string> newest_ids;
+};
+
 class Database {
 private:
     std::string database_path;
-    std::vector<Job> job_cache;
+    DatabaseOptions options;
+    // Rows ordered by created DESC. Shared with callers of snapshot(), so a
+    // held snapshot is never modified: changes are applied copy-on-write.
+    std::shared_ptr<std::vector<Job>> job_cache;
+    std::unordered_map<std::string, std::string> cached_created;
+    std::vector<Job> pending_changes;
     bool cache_dirty;
 
+    // False if this SQLite build lacks FTS5; search() then falls back to
+    // LIKE scans.
+    bool full_text_search;
+
+    // Ids of every stored job, built on first use by findExistingJobs and
+    // kept up to date by storeJob(s).
+    BloomFilter known_ids;
+    bool known_ids_loaded;
+
+    // Fingerprints of the stored originals (rows not flagged as duplicates),
+    // built on the first write and kept up to date after. Rows later
+    // replaced under the same id keep their first fingerprint here.
+    NearDuplicateIndex fingerprints;
+    bool fingerprints_loaded;
+    std::size_t near_duplicate_count;
+
+    // Salary sketches of the stored originals, mirrored in the salary_stats
+    // table and loaded before the first write. Sketches cannot take a row
+    // back out, so a row replaced under the same id keeps the salary it was
+    // first counted with until the next rebuildSalaryStatistics().
+    SalaryStatistics salary_statistics;
+    bool salary_statistics_loaded;
+
+    // False if the rollup tables could not be created; the rollup queries
+    // then return nothing.
+    bool market_rollups;
+
+    // Rollup changes of the rows stored since the last commit, keyed by
+    // (day, category, location, technology or company) and added to the
+    // rollup tables in the same transaction as the rows.
+    struct RollupDelta {
+        std::int64_t job_count = 0;
+        std::int64_t salaried = 0;
+        double salary_min_sum = 0.0;
+        double salary_max_sum = 0.0;
+    };
+
+    using RollupKey = std::tuple<std::string, std::string, std::string, std::string>;
+
+    std::map<RollupKey, RollupDelta> pending_job_rollups;
+    std::map<RollupKey, RollupDelta> pending_company_rollups;
+
+    // What the rows of the open transaction add to the cache, known ids,
+    // fingerprints, salary sketches and near-duplicate count. Applied once
+    // it commits and dropped if it rolls back, so the members above always
+    // describe committed rows. Later rows of the same transaction are still
+    // checked against these.
+    std::vector<Job> batch_changes;
+    std::unordered_set<std::string> batch_ids;
+    NearDuplicateIndex batch_fingerprints;
+    SalaryStatistics batch_salaries;
+    std::size_t batch_near_duplicates;
+
+    // Opened by the constructor unless per_thread_connections is set, so
+    // connection() never creates it lazily.
+    std::unique_ptr<SqliteConnection> shared_connection;
+    std::mutex thread_connections_mutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<SqliteConnection>> thread_connections;
+
     void initializeDatabase();
     void createTables();
     void updateCache();
+    void createFullTextIndex(SqliteConnection& db);
+    void createRollups(SqliteConnection& db);
+    bool hasColumn(SqliteConnection& db, const std::string& column);
+    void addColumnIfMissing(SqliteConnection& db, const std::string& column, const std::string& type);
+    void applyPendingChanges();
+    void recordChange(const Job& row);
+    void recordChange(Job&& row);
+    void rememberId(const std::string& job_id);
+    void loadKnownIds();
+    void loadFingerprints();
+    void rememberFingerprint(const Job& job);
+    // Whether storing `job` adds it to the salary sketches: an original
+    // with a salary whose id is not stored yet. Checked before the insert.
+    bool countsSalary(SqliteConnection& db, const Job& job);
+    void recordSalary(const Job& job);
+    void loadSalaryStatistics();
+    bool saveSalaryStatistics(SqliteConnection& db);
+    // Writes the slices batch_salaries changed, merged into the committed
+    // ones, without touching salary_statistics.
+    bool saveBatchSalaries(SqliteConnection& db);
+    void recordRollup(const Job& job);
+    bool saveRollups(SqliteConnection& db);
+    static bool addRollups(SqliteConnection& db, const char* sql, std::map<RollupKey, RollupDelta>& pending);
+
+    // The stored original `job` near-duplicates, or null; always null under
+    // NearDuplicatePolicy::Keep.
+    const std::string* nearDuplicateOf(const Job& job);
+
+    // The connection for the calling thread; opened on first use and kept
+    // until the Database is destroyed.
+    SqliteConnection& connection();
+    std::unique_ptr<SqliteConnection> openConnection() const;
+
+    // Bind, step and record one row of kInsertJobSql; the caller resets the
+    // statement. The const overload only copies the job when it has to be
+    // enriched or the cache needs it; the rvalue one never copies.
+    bool insertJob(SqliteConnection& db, sqlite3_stmt* stmt, const Job& job);
+    bool insertJob(SqliteConnection& db, sqlite3_stmt* stmt, Job&& job);
+
+    // The rvalue path once `job` is enriched and nearDuplicateOf(job) is
+    // known, so the const overload does not look it up twice.
+    bool insertEnrichedJob(SqliteConnection& db, sqlite3_stmt* stmt, Job&& job, const std::string* original);
+
+    // Fills in technologies, category, MinHash signature and SimHash where
+    // the job lacks them.
+    static void enrichJob(Job& job);
+    static bool isEnriched(const Job& job);
+
+    static void bindJob(sqlite3_stmt* stmt, const Job& job);
+
+    // One job_technologies row per technology of the just-inserted `job`.
+    bool insertTechnologies(SqliteConnection& db, const Job& job);
+
+    // Runs a "key, count" rollup query whose parameters are `filters`.
+    std::map<std::string, int> rollupCounts(const std::string& sql, const RollupFilters& filters);
+
+    template<typename Iterator>
+    bool storeRows(Iterator first, Iterator last);
+
+    // Ends the open transaction. If `success`, writes the changed salary
+    // sketches and rollups and commits, then applies the batch_* state;
+    // otherwise, or if any of that fails, rolls back and drops it.
+    bool finishBatch(SqliteConnection& db, bool success);
+    void applyBatch();
+    void discardBatch();
+
+    // Reads the columns of kSelectJobsSql starting at column 0.
+    static Job readJob(sqlite3_stmt* stmt);
 
 public:
-    explicit Database(const std::string& path = "job_market.db");
+    explicit Database(const std::string& path = "job_market.db",
+                      const DatabaseOptions& options = DatabaseOptions());
     ~Database();
 
+    Database(const Database&) = delete;
+    Database& operator=(const Database&) = delete;
+
+    // Rows are written options.batch_size to a transaction. A row that
+    // fails (the job, or one of its technologies) rolls its whole batch
+    // back and ends the call with false; batches committed before it stay.
     bool storeJob(const Job& job);
     bool storeJobs(const std::vector<Job>& jobs);
 
-    std::vector<Job> loadJobs();
+    // Same, but the rows are moved into the cache instead of copied.
+    bool storeJobs(std::vector<Job>&& jobs);
+
+    // Rows written through this Database since the last load are merged into
+    // the cache instead of reloading the table. The reference stays valid
+    // until the next call that writes or reloads.
+    const std::vector<Job>& loadJobs();
+
+    // Same rows as loadJobs, as an immutable snapshot that later writes do
+    // not affect.
+    std::shared_ptr<const std::vector<Job>> snapshot();
 
     void clearCache();
     void refreshCache();
 
     bool isJobExists(const std::string& job_id);
+
+    // Near-duplicates flagged or merged by this Database since it was
+    // opened.
+    std::size_t nearDuplicateCount() const {
+        return near_duplicate_count;
+    }
+
+    // Adds the SimHash of every stored original (row not flagged as a
+    // duplicate) to `index`, for checks across several databases.
+    void addFingerprints(NearDuplicateIndex& index);
+
+    // The subset of `job_ids` already stored. Ids the Bloom filter rules out
+    // never reach SQLite; the rest are confirmed in a single query.
+    std::unordered_set<std::string> findExistingJobs(const std::vector<std::string>& job_ids);
+
+    // Salary sketches, overall and per category / location / technology,
+    // kept current by every write and persisted alongside the rows, so
+    // percentiles and outlier checks never rescan the table.
+    const SalaryStatistics& salaryStatistics();
+
+    // Recomputes the sketches from the stored rows, e.g. after rows were
+    // replaced or deleted.
+    bool rebuildSalaryStatistics();
+
+    // Market statistics read from rollup tables kept current by every
+    // write, so a query touches one row per (day, category, location,
+    // technology or company) rather than one per job. Flagged
+    // near-duplicates are not counted.
+    std::map<std::string, MarketTotals> dailyTotals(const RollupFilters& filters = RollupFilters());
+    std::map<std::string, int> technologyCounts(const RollupFilters& filters = RollupFilters());
+    std::map<std::string, int> companyCounts(const RollupFilters& filters = RollupFilters());
+
+    // Recomputes the rollups from the stored rows, e.g. after jobs were
+    // inserted by something other than this class.
+    bool rebuildRollups();
+
+    // Writes the rows of loadJobs() to a JobSnapshot file, which read-only
+    // analytics can map with JobSnapshot::open instead of loading the table.
+    bool exportSnapshot(const std::string& path);
+
+    // Stores every row of the snapshot at `path`, replacing rows with the
+    // same id. Flags of reposts go through the near-duplicate policy like
+    // any other stored job.
+    bool importSnapshot(const std::string& path);
+
+    // Per-search state for incremental crawls, keyed by a caller-chosen
+    // string. loadCheckpoint returns false when there is none yet.
+    bool loadCheckpoint(const std::string& search_key, CrawlCheckpoint& checkpoint);
+    bool saveCheckpoint(const std::string& search_key, const CrawlCheckpoint& checkpoint);
+
+    // Full-text search over title and description, best matches first
+    // (title hits weigh more). Every whitespace-separated word of `query`
+    // must occur, punctuation and all ("c++", "node.js"), and `kube*`
+    // matches a prefix. With filters.raw_query set the query is FTS5 syntax
+    // instead: "quoted phrases", OR, NOT, NEAR. An empty query returns the
+    // newest jobs that pass the filters. Errors, such as a malformed raw
+    // query, are reported and yield no results.
+    //
+    // When `scores` is given it receives each result's bm25 rank (lower is
+    // better) if the results were ranked by relevance, and is left empty if
+    // they are ordered by date.
+    std::vector<Job> search(const std::string& query,
+                            const SearchFilters& filters = SearchFilters(),
+                            int limit = 50,
+                            std::vector<double>* scores = nullptr);
 };
 
 #endif
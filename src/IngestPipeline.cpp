@@ -0,0 +1,407 @@
+#include "IngestPipeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+
+#include "AdzunaResponseParser.h"
+#include "BoundedQueue.h"
+#include "JobParser.h"
+#include "MinHash.h"
+#include "SimHash.h"
+
+namespace {
+
+struct RawPage {
+    int page = 0;
+    std::string body;
+};
+
+struct PageJobs {
+    int page = 0;
+    std::vector<Job> jobs;
+};
+
+// Lowers `last_page` to `page` unless it is already lower.
+void stopAfter(std::atomic<int>& last_page, int page) {
+    int current = last_page.load();
+
+    while (page < current && !last_page.compare_exchange_weak(current, page)) {
+    }
+}
+
+std::string checkpointKey(const std::string& query, const std::string& location, double min_salary) {
+    return query + '\x1f' + location + '\x1f' + std::to_string(static_cast<long long>(min_salary));
+}
+
+// Folds `job` into the newest-postings boundary of `checkpoint`.
+void advanceCheckpoint(CrawlCheckpoint& checkpoint, const Job& job) {
+    if (job.created > checkpoint.newest_created) {
+        checkpoint.newest_created = job.created;
+        checkpoint.newest_ids.assign(1, job.id);
+    } else if (job.created == checkpoint.newest_created &&
+               std::find(checkpoint.newest_ids.begin(), checkpoint.newest_ids.end(), job.id) ==
+                   checkpoint.newest_ids.end()) {
+        checkpoint.newest_ids.push_back(job.id);
+    }
+}
+
+} // namespace
+
+IngestPipeline::IngestPipeline(const ApiClient& api_client,
+                               Database& db,
+                               const IngestOptions& ingest_options)
+    : client(api_client), database(&db), sharded_database(nullptr), options(ingest_options) {}
+
+IngestPipeline::IngestPipeline(const ApiClient& api_client,
+                               ShardedDatabase& db,
+                               const IngestOptions& ingest_options)
+    : client(api_client), database(nullptr), sharded_database(&db), options(ingest_options) {}
+
+bool IngestPipeline::storeJobs(std::vector<Job>&& jobs) {
+    return database ? database->storeJobs(std::move(jobs)) : sharded_database->storeJobs(std::move(jobs));
+}
+
+std::size_t IngestPipeline::nearDuplicateCount() const {
+    return database ? database->nearDuplicateCount() : sharded_database->nearDuplicateCount();
+}
+
+std::unordered_set<std::string> IngestPipeline::findExistingJobs(const std::vector<std::string>& job_ids) {
+    return database ? database->findExistingJobs(job_ids) : sharded_database->findExistingJobs(job_ids);
+}
+
+bool IngestPipeline::loadCheckpoint(const std::string& search_key, CrawlCheckpoint& checkpoint) {
+    return database ? database->loadCheckpoint(search_key, checkpoint)
+                    : sharded_database->loadCheckpoint(search_key, checkpoint);
+}
+
+bool IngestPipeline::saveCheckpoint(const std::string& search_key, const CrawlCheckpoint& checkpoint) {
+    return database ? database->saveCheckpoint(search_key, checkpoint)
+                    : sharded_database->saveCheckpoint(search_key, checkpoint);
+}
+
+IngestStats IngestPipeline::run(const std::string& query,
+                                const std::string& location,
+                                double min_salary,
+                                int max_pages) {
+    IngestStats stats;
+    std::mutex stats_mutex;
+
+    BoundedQueue<RawPage> raw_pages(options.queue_depth);
+    BoundedQueue<PageJobs> parsed_pages(options.queue_depth);
+    BoundedQueue<PageJobs> enriched_pages(options.queue_depth);
+
+    // Pages are claimed from a shared counter; later stages lower last_page
+    // once they see the end of the results (or a failure).
+    std::atomic<int> next_page(1);
+    std::atomic<int> last_page(max_pages);
+
+    // Incremental state. The checkpoint is read here and written after the
+    // stages have finished, so only the writer thread touches the database
+    // while they run.
+    const bool incremental = options.incremental;
+    const std::string search_key = checkpointKey(query, location, min_salary);
+    CrawlCheckpoint checkpoint;
+    bool have_checkpoint = incremental && loadCheckpoint(search_key, checkpoint);
+    std::unordered_set<std::string> checkpoint_ids(checkpoint.newest_ids.begin(),
+                                                   checkpoint.newest_ids.end());
+    CrawlCheckpoint next_checkpoint = checkpoint;
+    std::atomic<bool> caught_up(false);
+
+    // With a checkpoint, page N is only requested once page N-1 has been
+    // parsed, so a refresh stops without speculative requests.
+    std::mutex progress_mutex;
+    std::condition_variable progress;
+    int parsed_through = 0;
+
+    auto markParsed = [&](int page) {
+        {
+            std::lock_guard<std::mutex> lock(progress_mutex);
+            parsed_through = std::max(parsed_through, page);
+        }
+        progress.notify_all();
+    };
+
+    auto recordFailure = [&](const HttpResponse& response) {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        stats.failures.push_back(response);
+    };
+
+    auto fetch = [&]() {
+        while (true) {
+            int page = next_page.fetch_add(1);
+
+            if (have_checkpoint) {
+                std::unique_lock<std::mutex> lock(progress_mutex);
+                progress.wait(lock, [&]() { return parsed_through >= page - 1 || page > last_page.load(); });
+            }
+
+            if (page > last_page.load()) {
+                return;
+            }
+
+            RawPage raw;
+            raw.page = page;
+
+            HttpResponse response = client.fetchSearchPage(query, location, options.results_per_page,
+                                                           min_salary, page, raw.body, incremental);
+
+            if (!response.ok()) {
+                stopAfter(last_page, page - 1);
+                recordFailure(response);
+                markParsed(page);
+                continue;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(stats_mutex);
+                stats.pages_fetched++;
+            }
+
+            if (!raw_pages.push(std::move(raw))) {
+                return;
+            }
+        }
+    };
+
+    auto parse = [&]() {
+        RawPage raw;
+
+        while (raw_pages.pop(raw)) {
+            PageJobs parsed;
+            parsed.page = raw.page;
+            parsed.jobs.reserve(static_cast<std::size_t>(std::max(0, options.results_per_page)));
+
+            AdzunaResponseParser parser(parsed.jobs);
+
+            bool ok = parser.feed(raw.body.data(), raw.body.size()) && parser.finish();
+            std::string().swap(raw.body);
+
+            if (!ok) {
+                std::cerr << "JSON parse error on page " << raw.page << ": " << parser.error() << '\n';
+
+                HttpResponse failure;
+                failure.page = raw.page;
+                failure.status = 200;
+                failure.error = parser.error();
+                stopAfter(last_page, raw.page - 1);
+                recordFailure(failure);
+                markParsed(raw.page);
+                continue;
+            }
+
+            if (!parser.hasResults() || parsed.jobs.empty()) {
+                stopAfter(last_page, raw.page - 1);
+                caught_up = true;
+                markParsed(raw.page);
+                continue;
+            }
+
+            if (incremental) {
+                for (const auto& job : parsed.jobs) {
+                    bool seen = have_checkpoint &&
+                                (job.created < checkpoint.newest_created ||
+                                 checkpoint_ids.count(job.id) > 0);
+
+                    if (seen) {
+                        stopAfter(last_page, raw.page);
+                        caught_up = true;
+                    }
+
+                    advanceCheckpoint(next_checkpoint, job);
+                }
+            }
+
+            markParsed(raw.page);
+
+            {
+                std::lock_guard<std::mutex> lock(stats_mutex);
+                stats.jobs_parsed += parsed.jobs.size();
+            }
+
+            // Fetched speculatively, past a page that has since failed or
+            // come back empty: storing it would leave a gap below it.
+            if (raw.page > last_page.load()) {
+                continue;
+            }
+
+            parsed_pages.push(std::move(parsed));
+        }
+    };
+
+    auto enrich = [&]() {
+        PageJobs page;
+
+        while (parsed_pages.pop(page)) {
+            for (auto& job : page.jobs) {
+                job.technologies = JobParser::extractTechnologies(job.description);
+                job.category = JobParser::categorizeJob(job);
+                job.minhash = MinHash::signature(job);
+                job.simhash = SimHash::fingerprint(job);
+            }
+
+            enriched_pages.push(std::move(page));
+        }
+    };
+
+    bool writes_ok = true;
+
+    auto write = [&]() {
+        std::vector<Job> batch;
+        std::vector<int> batch_pages;  // the page of each batch row
+        PageJobs page;
+
+        // Tallied here and handed over once the stage is done, so other
+        // stages never wait on them.
+        TopK companies;
+        TopK locations;
+        TopK technologies;
+
+        auto flush = [&]() {
+            // A page that failed since these rows were batched caps the run
+            // below some of them.
+            int last = last_page.load();
+            std::size_t kept = 0;
+
+            for (std::size_t i = 0; i < batch.size(); i++) {
+                if (batch_pages[i] <= last) {
+                    if (kept != i) {
+                        batch[kept] = std::move(batch[i]);
+                    }
+                    kept++;
+                }
+            }
+
+            batch.resize(kept);
+            batch_pages.clear();
+
+            if (batch.empty()) {
+                return;
+            }
+
+            for (const auto& job : batch) {
+                if (!job.company.display_name.empty()) {
+                    companies.add(job.company.display_name);
+                }
+
+                if (!job.location.display_name.empty()) {
+                    locations.add(job.location.display_name);
+                }
+
+                for (const auto& technology : job.technologies) {
+                    technologies.add(technology);
+                }
+            }
+
+            std::size_t batch_size = batch.size();
+            std::size_t duplicates_before = nearDuplicateCount();
+            bool stored = storeJobs(std::move(batch));
+
+            {
+                std::lock_guard<std::mutex> lock(stats_mutex);
+                stats.near_duplicates += nearDuplicateCount() - duplicates_before;
+
+                if (stored) {
+                    stats.jobs_stored += batch_size;
+                } else {
+                    writes_ok = false;
+                }
+            }
+
+            batch.clear();
+        };
+
+        while (enriched_pages.pop(page)) {
+            if (page.page > last_page.load()) {
+                continue;
+            }
+
+            if (incremental) {
+                std::vector<std::string> ids;
+                ids.reserve(page.jobs.size());
+
+                for (const auto& job : page.jobs) {
+                    ids.push_back(job.id);
+                }
+
+                std::unordered_set<std::string> existing = findExistingJobs(ids);
+
+                if (!existing.empty()) {
+                    // Newest-first order: everything past this page is
+                    // older still, and so already stored too.
+                    stopAfter(last_page, page.page);
+                    caught_up = true;
+
+                    page.jobs.erase(std::remove_if(page.jobs.begin(), page.jobs.end(),
+                                                   [&](const Job& job) { return existing.count(job.id) > 0; }),
+                                    page.jobs.end());
+
+                    std::lock_guard<std::mutex> lock(stats_mutex);
+                    stats.jobs_skipped += existing.size();
+                }
+            }
+
+            batch_pages.insert(batch_pages.end(), page.jobs.size(), page.page);
+            std::move(page.jobs.begin(), page.jobs.end(), std::back_inserter(batch));
+
+            if (batch.size() >= options.write_batch) {
+                flush();
+            }
+        }
+
+        flush();
+
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        stats.companies = std::move(companies);
+        stats.locations = std::move(locations);
+        stats.technologies = std::move(technologies);
+    };
+
+    // Stages block on their queues most of the time, so they get dedicated
+    // threads rather than ThreadPool tasks.
+    std::vector<std::thread> fetchers;
+    std::vector<std::thread> enrichers;
+
+    for (int i = 0; i < std::max(1, options.fetch_threads); i++) {
+        fetchers.emplace_back(fetch);
+    }
+
+    std::thread parser(parse);
+
+    for (int i = 0; i < std::max(1, options.enrich_threads); i++) {
+        enrichers.emplace_back(enrich);
+    }
+
+    std::thread writer(write);
+
+    // Shut down front to back: each queue closes once everything feeding it
+    // has finished, and the next stage drains it before exiting.
+    for (auto& thread : fetchers) {
+        thread.join();
+    }
+
+    raw_pages.close();
+    parser.join();
+    parsed_pages.close();
+
+    for (auto& thread : enrichers) {
+        thread.join();
+    }
+
+    enriched_pages.close();
+    writer.join();
+
+    std::sort(stats.failures.begin(), stats.failures.end(),
+              [](const HttpResponse& a, const HttpResponse& b) { return a.page < b.page; });
+
+    if (incremental && caught_up && writes_ok && stats.complete() && !next_checkpoint.newest_created.empty()) {
+        saveCheckpoint(search_key, next_checkpoint);
+    }
+
+    return stats;
+}
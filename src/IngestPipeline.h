@@ -0,0 +1,104 @@
+#ifndef INGESTPIPELINE_H
+#define INGESTPIPELINE_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "ApiClient.h"
+#include "Database.h"
+#include "ShardedDatabase.h"
+#include "TopK.h"
+
+struct IngestOptions {
+    int results_per_page = 50;
+    int fetch_threads = 2;
+    int enrich_threads = 2;
+
+    // Pages buffered between two stages. Together with write_batch this
+    // bounds memory, however many pages the run covers.
+    std::size_t queue_depth = 4;
+
+    // Jobs handed to Database::storeJobs at a time.
+    std::size_t write_batch = 500;
+
+    // Fetch newest postings first and stop at the first page that reaches
+    // postings already ingested (per the search's checkpoint or the jobs
+    // table). Jobs already stored are skipped rather than rewritten.
+    bool incremental = false;
+};
+
+struct IngestStats {
+    int pages_fetched = 0;
+    std::size_t jobs_parsed = 0;
+    std::size_t jobs_stored = 0;
+    std::size_t jobs_skipped = 0;   // already stored (incremental runs)
+    std::size_t near_duplicates = 0; // flagged or merged reposts, among jobs_stored
+
+    // Most frequent companies, locations and technologies among the jobs
+    // handed to storage, in bounded memory however long the run.
+    TopK companies;
+    TopK locations;
+    TopK technologies;
+
+    // Pages that could not be fetched or parsed. No pages after the first
+    // failure are requested.
+    std::vector<HttpResponse> failures;
+
+    bool complete() const {
+        return failures.empty();
+    }
+};
+
+// Harvests a search into the database as a chain of stages connected by
+// bounded queues:
+//
+//   fetch (raw page bodies) -> parse (Jobs) -> enrich (technologies,
+//   category, signatures) -> write (batched storeJobs)
+//
+// Each stage runs on its own thread(s), so network, parsing, matching and
+// disk work overlap, and a full queue stalls the stage feeding it.
+class IngestPipeline {
+private:
+    const ApiClient& client;
+
+    // Exactly one of these is set.
+    Database* database;
+    ShardedDatabase* sharded_database;
+
+    IngestOptions options;
+
+    bool storeJobs(std::vector<Job>&& jobs);
+    std::size_t nearDuplicateCount() const;
+    std::unordered_set<std::string> findExistingJobs(const std::vector<std::string>& job_ids);
+    bool loadCheckpoint(const std::string& search_key, CrawlCheckpoint& checkpoint);
+    bool saveCheckpoint(const std::string& search_key, const CrawlCheckpoint& checkpoint);
+
+public:
+    IngestPipeline(const ApiClient& api_client,
+                   Database& db,
+                   const IngestOptions& ingest_options = IngestOptions());
+
+    // Each write batch is split across the shards and written to all of
+    // them at once; a larger write_batch gives every shard more per commit.
+    IngestPipeline(const ApiClient& api_client,
+                   ShardedDatabase& db,
+                   const IngestOptions& ingest_options = IngestOptions());
+
+    // Fetches pages 1..max_pages, stopping early at the first empty page.
+    // Pages are stored as they complete, not in page order.
+    //
+    // Incremental runs keep a checkpoint per (query, location, min_salary).
+    // It only advances when a run got back to known postings (or the end of
+    // the results) without failures, so a run cut short by max_pages or an
+    // error cannot leave a gap behind it. While a checkpoint exists, pages
+    // are requested one at a time, each only after the previous one was
+    // found to be all new.
+    IngestStats run(const std::string& query,
+                    const std::string& location,
+                    double min_salary,
+                    int max_pages);
+};
+
+#endif
@@ -7,47 +7,146 @@
 #include <regex>
 #include <set>
 
-std::vector<std::string> JobParser::extractTechnologies(const std::string& description) {
-    std::vector<std::string> technologies;
+#include "JobSnapshot.h"
+#include "JobStore.h"
+#include "MinHash.h"
+#include "RelevanceIndex.h"
+#include "SalarySketch.h"
+#include "SimilarityIndex.h"
+#include "TextSearch.h"
+#include "ThreadPool.h"
+
+namespace {
+
+std::shared_ptr<const TechnologyMatcher>& matcherSlot() {
+    static std::shared_ptr<const TechnologyMatcher> matcher =
+        std::make_shared<const TechnologyMatcher>(TechnologyMatcher::defaultDefinitions());
+    return matcher;
+}
 
-    std::string desc_lower = description;
-    std::transform(desc_lower.begin(), desc_lower.end(), desc_lower.begin(),
-                   [](unsigned char c) { return std::tolower(c); });
+// Jobs per parallel task. Fixed, so partial results always split the same
+// way regardless of the thread count.
+constexpr std::size_t kParallelChunk = 512;
 
-    const std::vector<std::string> techs = {
-        "c++", "python", "java", "javascript", "typescript",
-        "react", "angular", "vue", "node.js",
-        "docker", "kubernetes", "aws", "azure",
-        "sql", "mongodb", "redis"
-    };
+template<typename Predicate>
+std::vector<std::size_t> findMatches(const std::vector<Job>& jobs, Predicate keep) {
+    std::vector<std::size_t> matches;
+
+    for (std::size_t i = 0; i < jobs.size(); i++) {
+        if (keep(jobs[i])) {
+            matches.push_back(i);
+        }
+    }
+
+    return matches;
+}
 
-    for (const auto& tech : techs) {
-        if (desc_lower.find(tech) != std::string::npos) {
-            if (tech == "c++") technologies.push_back("C++");
-            else if (tech == "node.js") technologies.push_back("Node.js");
-            else {
-                std::string t = tech;
-                t[0] = std::toupper(t[0]);
-                technologies.push_back(t);
+// Positions of the jobs matching `keep`, evaluated in parallel, in input
+// order.
+template<typename Predicate>
+std::vector<std::size_t> parallelFindMatches(const std::vector<Job>& jobs, ThreadPool& pool, Predicate keep) {
+    std::size_t chunks = (jobs.size() + kParallelChunk - 1) / kParallelChunk;
+    std::vector<std::vector<std::size_t>> partial(chunks);
+
+    pool.parallelFor(jobs.size(), kParallelChunk,
+                     [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            if (keep(jobs[i])) {
+                partial[chunk].push_back(i);
             }
         }
+    });
+
+    std::size_t total = 0;
+
+    for (const auto& chunk : partial) {
+        total += chunk.size();
+    }
+
+    std::vector<std::size_t> matches;
+    matches.reserve(total);
+
+    for (const auto& chunk : partial) {
+        matches.insert(matches.end(), chunk.begin(), chunk.end());
+    }
+
+    return matches;
+}
+
+// SalarySketch::isOutlier over exact quartiles: the same rank rule,
+// found by selection in O(n) instead of a sketch. Reorders `salaries`.
+bool isOutsideFences(double salary, std::vector<double>& salaries) {
+    if (salary <= 0 || salaries.size() < SalarySketch::kMinOutlierSample) {
+        return false;
+    }
+
+    auto quartile = [&](double q) {
+        std::size_t rank = static_cast<std::size_t>(std::ceil(q * static_cast<double>(salaries.size())));
+        auto nth = salaries.begin() + static_cast<std::ptrdiff_t>(rank - 1);
+        std::nth_element(salaries.begin(), nth, salaries.end());
+        return *nth;
+    };
+
+    double q1 = quartile(0.25);
+    double q3 = quartile(0.75);
+    double width = SalarySketch::kFenceWidth * (q3 - q1);
+
+    return salary < q1 - width || salary > q3 + width;
+}
+
+// Same, over `rows` entries of salary columns.
+bool isOutsideFences(double salary, const double* mins, const double* maxes, std::size_t rows) {
+    std::vector<double> salaries;
+    salaries.reserve(rows);
+
+    for (std::size_t i = 0; i < rows; i++) {
+        double value = SalaryStatistics::salaryOf(mins[i], maxes[i]);
+
+        if (value > 0) {
+            salaries.push_back(value);
+        }
     }
 
-    std::sort(technologies.begin(), technologies.end());
-    technologies.erase(std::unique(technologies.begin(), technologies.end()), technologies.end());
+    return isOutsideFences(salary, salaries);
+}
+
+std::vector<Job> copyAt(const std::vector<Job>& jobs, const std::vector<std::size_t>& positions) {
+    std::vector<Job> result;
+    result.reserve(positions.size());
+
+    for (std::size_t i : positions) {
+        result.push_back(jobs[i]);
+    }
 
-    return technologies;
+    return result;
+}
+
+} // namespace
+
+std::shared_ptr<const TechnologyMatcher> JobParser::technologyMatcher() {
+    return std::atomic_load(&matcherSlot());
+}
+
+void JobParser::setTechnologyDictionary(const std::vector<TechnologyDefinition>& definitions) {
+    std::atomic_store(&matcherSlot(), std::make_shared<const TechnologyMatcher>(definitions));
+}
+
+void JobParser::loadTechnologyDictionary(const std::string& path) {
+    std::atomic_store(&matcherSlot(),
+                      std::make_shared<const TechnologyMatcher>(TechnologyMatcher::fromJsonFile(path)));
+}
+
+std::vector<std::string> JobParser::extractTechnologies(const std::string& description) {
+    return technologyMatcher()->findNames(description, false);
 }
 
 std::string JobParser::categorizeJob(const Job& job) {
-    std::string title = job.title;
-    std::transform(title.begin(), title.end(), title.begin(),
-                   [](unsigned char c) { return std::tolower(c); });
+    const std::string& title = job.title;
 
-    if (title.find("frontend") != std::string::npos) return "Frontend";
-    if (title.find("backend") != std::string::npos) return "Backend";
-    if (title.find("devops") != std::string::npos) return "DevOps";
-    if (title.find("data") != std::string::npos) return "Data";
+    if (TextSearch::containsIgnoreCase(title, "frontend")) return "Frontend";
+    if (TextSearch::containsIgnoreCase(title, "backend")) return "Backend";
+    if (TextSearch::containsIgnoreCase(title, "devops")) return "DevOps";
+    if (TextSearch::containsIgnoreCase(title, "data")) return "Data";
 
     return "General";
 }
@@ -84,52 +183,220 @@ void JobParser::normalizeSalaryRange(double& min_salary, double& max_salary) {
 }
 
 bool JobParser::isSalaryOutlier(double salary, const std::vector<Job>& jobs) {
-    if (jobs.empty() || salary <= 0) return false;
-
-    double total = 0.0;
-    int count = 0;
+    std::vector<double> salaries;
+    salaries.reserve(jobs.size());
 
     for (const auto& job : jobs) {
-        double avg = (job.salary_min + job.salary_max) / 2.0;
-        if (avg > 0) {
-            total += avg;
-            count++;
+        double value = SalaryStatistics::salaryOf(job);
+
+        if (value > 0) {
+            salaries.push_back(value);
         }
     }
 
-    if (count == 0) return false;
+    return isOutsideFences(salary, salaries);
+}
+
+bool JobParser::isSalaryOutlier(double salary, const JobStore& store) {
+    return isOutsideFences(salary, store.salaryMins().data(), store.salaryMaxes().data(), store.size());
+}
+
+bool JobParser::isSalaryOutlier(double salary, const JobSnapshot& snapshot) {
+    return isOutsideFences(salary, snapshot.salaryMins(), snapshot.salaryMaxes(), snapshot.size());
+}
 
-    double mean = total / count;
-    return std::abs(salary - mean) > mean * 2.0;
+bool JobParser::isSalaryOutlier(double salary, const SalarySketch& salaries) {
+    return salaries.isOutlier(salary);
+}
+
+bool JobParser::isRemoteJob(const Job& job) {
+    // Descriptions mention "remote" in negative phrasings too ("not a remote
+    // role"), so they only count with an explicit remote-work phrase.
+    static const char* const description_phrases[] = {
+        "fully remote", "100% remote", "remote-first", "remote first",
+        "work from home", "work from anywhere", "remote position", "remote role"
+    };
+
+    if (TextSearch::containsIgnoreCase(job.title, "remote") ||
+        TextSearch::containsIgnoreCase(job.location.display_name, "remote")) {
+        return true;
+    }
+
+    for (const char* phrase : description_phrases) {
+        if (TextSearch::containsIgnoreCase(job.description, phrase)) {
+            return true;
+        }
+    }
+
+    return false;
 }
 
 std::vector<Job> JobParser::filterByTechnology(const std::vector<Job>& jobs,
                                                const std::string& tech) {
-    std::vector<Job> result;
+    return copyAt(jobs, findByTechnology(jobs, tech));
+}
 
-    std::string t = tech;
-    std::transform(t.begin(), t.end(), t.begin(),
-                   [](unsigned char c) { return std::tolower(c); });
+std::vector<Job> JobParser::filterRemoteJobs(const std::vector<Job>& jobs) {
+    return copyAt(jobs, findRemoteJobs(jobs));
+}
+
+std::vector<std::size_t> JobParser::findByTechnology(const std::vector<Job>& jobs,
+                                                     const std::string& tech) {
+    return findMatches(jobs, [&](const Job& job) {
+        return TextSearch::containsIgnoreCase(job.description, tech);
+    });
+}
+
+std::vector<std::size_t> JobParser::findRemoteJobs(const std::vector<Job>& jobs) {
+    return findMatches(jobs, JobParser::isRemoteJob);
+}
+
+std::vector<Job> JobParser::filterByTechnology(const std::vector<Job>& jobs,
+                                               const std::string& tech,
+                                               ThreadPool& pool) {
+    return copyAt(jobs, findByTechnology(jobs, tech, pool));
+}
+
+std::vector<Job> JobParser::filterRemoteJobs(const std::vector<Job>& jobs, ThreadPool& pool) {
+    return copyAt(jobs, findRemoteJobs(jobs, pool));
+}
+
+std::vector<std::size_t> JobParser::findByTechnology(const std::vector<Job>& jobs,
+                                                     const std::string& tech,
+                                                     ThreadPool& pool) {
+    return parallelFindMatches(jobs, pool, [&](const Job& job) {
+        return TextSearch::containsIgnoreCase(job.description, tech);
+    });
+}
+
+std::vector<std::size_t> JobParser::findRemoteJobs(const std::vector<Job>& jobs, ThreadPool& pool) {
+    return parallelFindMatches(jobs, pool, JobParser::isRemoteJob);
+}
+
+std::map<std::string, int> JobParser::analyzeTechnologyTrends(const std::vector<Job>& jobs) {
+    auto matcher = technologyMatcher();
+
+    // Count by id, and only resolve names once at the end. Jobs that were
+    // enriched (e.g. loaded from the database) already list their
+    // technologies; only the others are scanned.
+    std::vector<int> per_technology(matcher->size(), 0);
+    std::map<std::string, int> counts;
 
     for (const auto& job : jobs) {
-        std::string desc = job.description;
-        std::transform(desc.begin(), desc.end(), desc.begin(),
-                       [](unsigned char c) { return std::tolower(c); });
+        if (!job.technologies.empty()) {
+            for (const auto& technology : job.technologies) {
+                counts[technology]++;
+            }
+            continue;
+        }
 
-        if (desc.find(t) != std::string::npos) {
-            result.push_back(job);
+        for (int technology : matcher->findIds(job.description, false)) {
+            per_technology[static_cast<std::size_t>(technology)]++;
         }
     }
 
-    return result;
+    for (std::size_t i = 0; i < per_technology.size(); i++) {
+        if (per_technology[i] > 0) {
+            counts[matcher->name(static_cast<int>(i))] += per_technology[i];
+        }
+    }
+
+    return counts;
 }
 
-std::map<std::string, int> JobParser::analyzeTechnologyTrends(const std::vector<Job>& jobs) {
+std::map<std::string, int> JobParser::analyzeTechnologyTrends(const std::vector<Job>& jobs,
+                                                              ThreadPool& pool) {
+    auto matcher = technologyMatcher();
+
+    // One count vector (plus one map for already enriched jobs) per chunk,
+    // summed afterwards.
+    struct Partial {
+        std::vector<int> per_technology;
+        std::map<std::string, int> named;
+    };
+
+    std::size_t chunks = (jobs.size() + kParallelChunk - 1) / kParallelChunk;
+    std::vector<Partial> partial(chunks);
+
+    pool.parallelFor(jobs.size(), kParallelChunk,
+                     [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+        Partial& counts = partial[chunk];
+        counts.per_technology.assign(matcher->size(), 0);
+
+        for (std::size_t i = begin; i < end; i++) {
+            if (!jobs[i].technologies.empty()) {
+                for (const auto& technology : jobs[i].technologies) {
+                    counts.named[technology]++;
+                }
+                continue;
+            }
+
+            for (int technology : matcher->findIds(jobs[i].description, false)) {
+                counts.per_technology[static_cast<std::size_t>(technology)]++;
+            }
+        }
+    });
+
+    std::vector<int> per_technology(matcher->size(), 0);
     std::map<std::string, int> counts;
 
-    for (const auto& job : jobs) {
-        for (const auto& tech : extractTechnologies(job.description)) {
-            counts[tech]++;
+    for (const auto& chunk : partial) {
+        for (std::size_t i = 0; i < chunk.per_technology.size(); i++) {
+            per_technology[i] += chunk.per_technology[i];
+        }
+
+        for (const auto& [technology, count] : chunk.named) {
+            counts[technology] += count;
+        }
+    }
+
+    for (std::size_t i = 0; i < per_technology.size(); i++) {
+        if (per_technology[i] > 0) {
+            counts[matcher->name(static_cast<int>(i))] += per_technology[i];
+        }
+    }
+
+    return counts;
+}
+
+std::map<std::string, int> JobParser::analyzeTechnologyTrends(const JobStore& store) {
+    // Technologies were resolved when the rows were added; this is a count
+    // over one flat id array.
+    const StringInterner& names = store.technologyNames();
+    std::vector<int> per_technology(names.size(), 0);
+
+    for (std::uint32_t technology : store.allTechnologyIds()) {
+        per_technology[technology]++;
+    }
+
+    std::map<std::string, int> counts;
+
+    for (std::uint32_t i = 0; i < per_technology.size(); i++) {
+        if (per_technology[i] > 0) {
+            counts[names.str(i)] += per_technology[i];
+        }
+    }
+
+    return counts;
+}
+
+std::map<std::string, int> JobParser::analyzeTechnologyTrends(const JobSnapshot& snapshot) {
+    // Same count, read from the mapped id column. Ids come straight from
+    // the file, so one past the name table (a damaged snapshot) is skipped.
+    const MappedStrings& names = snapshot.technologyNames();
+    std::vector<int> per_technology(names.size(), 0);
+
+    for (auto it = snapshot.allTechnologyIdsBegin(); it != snapshot.allTechnologyIdsEnd(); ++it) {
+        if (*it < per_technology.size()) {
+            per_technology[*it]++;
+        }
+    }
+
+    std::map<std::string, int> counts;
+
+    for (std::uint32_t i = 0; i < per_technology.size(); i++) {
+        if (per_technology[i] > 0) {
+            counts[std::string(names.str(i))] += per_technology[i];
         }
     }
 
@@ -162,32 +429,169 @@ double JobParser::calculateJobQualityScore(const Job& job) {
 }
 
 std::string JobParser::detectExperienceLevel(const Job& job) {
-    std::string text = job.title + " " + job.description;
-
-    std::transform(text.begin(), text.end(), text.begin(),
-                   [](unsigned char c) { return std::tolower(c); });
+    auto mentions = [&](const char* word) {
+        return TextSearch::containsIgnoreCase(job.title, word) ||
+               TextSearch::containsIgnoreCase(job.description, word);
+    };
 
-    if (text.find("senior") != std::string::npos) return "Senior";
-    if (text.find("junior") != std::string::npos) return "Junior";
+    if (mentions("senior")) return "Senior";
+    if (mentions("junior")) return "Junior";
 
     return "Mid";
 }
 
 std::vector<std::string> JobParser::extractTechnologiesWithAliases(const std::string& description) {
-    return extractTechnologies(description);
+    return technologyMatcher()->findNames(description, true);
 }
 
 std::vector<Job> JobParser::rankJobsByRelevance(const std::vector<Job>& jobs,
-                                               const std::string&,
-                                               const std::string&,
-                                               double,
-                                               const std::vector<std::string>&) {
-    return jobs; // simplified
+                                               const std::string& user_skills,
+                                               const std::string& preferred_location,
+                                               double desired_salary,
+                                               const std::vector<std::string>& preferred_technologies) {
+    RelevanceProfile profile;
+    profile.skills = user_skills;
+    profile.preferred_technologies = preferred_technologies;
+    profile.location = preferred_location;
+    profile.desired_salary = desired_salary;
+
+    RelevanceIndex index(jobs);
+    return copyAt(jobs, index.topK(profile, jobs.size()));
+}
+
+double JobParser::relevanceScore(const Job& job,
+                                 const std::string& user_skills,
+                                 const std::string& preferred_location,
+                                 double desired_salary,
+                                 const std::vector<std::string>& preferred_technologies) {
+    double technology_weight = technologyWeight(user_skills, preferred_technologies) > 0
+        ? RelevanceIndex::kTechnologyWeight : 0.0;
+    double location_weight = RelevanceIndex::locationKey(preferred_location).empty()
+        ? 0.0 : RelevanceIndex::kLocationWeight;
+    double salary_weight = desired_salary > 0 ? RelevanceIndex::kSalaryWeight : 0.0;
+    double total = technology_weight + location_weight + salary_weight;
+
+    if (total == 0) {
+        return 0.0;
+    }
+
+    double score = 0.0;
+
+    if (technology_weight > 0) {
+        score += technology_weight * calculateTechnologyMatchScore(job, user_skills, preferred_technologies);
+    }
+
+    if (location_weight > 0) {
+        score += location_weight * calculateLocationMatchScore(job, preferred_location);
+    }
+
+    if (salary_weight > 0) {
+        score += salary_weight * calculateSalaryMatchScore(job, desired_salary);
+    }
+
+    return score / total;
 }
 
-std::vector<Job> JobParser::findSimilarJobs(const Job&,
-                                           const std::vector<Job>& jobs,
+std::vector<Job> JobParser::findSimilarJobs(const Job& reference_job,
+                                           const std::vector<Job>& all_jobs,
                                            int max_results) {
-    if ((int)jobs.size() <= max_results) return jobs;
-    return std::vector<Job>(jobs.begin(), jobs.begin() + max_results);
+    if (max_results <= 0) {
+        return {};
+    }
+
+    std::vector<std::uint32_t> signature = reference_job.minhash.size() == MinHash::kHashes
+        ? reference_job.minhash
+        : MinHash::signature(reference_job);
+
+    // One extra, in case the reference job itself is among the matches.
+    SimilarityIndex index(all_jobs);
+    std::vector<std::size_t> rows = index.nearest(signature, static_cast<std::size_t>(max_results) + 1);
+
+    rows.erase(std::remove_if(rows.begin(), rows.end(),
+                              [&](std::size_t row) { return all_jobs[row].id == reference_job.id; }),
+               rows.end());
+
+    if (rows.size() > static_cast<std::size_t>(max_results)) {
+        rows.resize(static_cast<std::size_t>(max_results));
+    }
+
+    return copyAt(all_jobs, rows);
+}
+
+std::vector<int> JobParser::technologyIds(const std::vector<std::string>& names) {
+    auto matcher = technologyMatcher();
+    std::vector<int> ids;
+
+    for (const auto& name : names) {
+        int id = matcher->id(name);
+
+        if (id >= 0) {
+            ids.push_back(id);
+            continue;
+        }
+
+        for (int found : matcher->findIds(name, true)) {
+            ids.push_back(found);
+        }
+    }
+
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+int JobParser::technologyWeight(const std::string& user_skills,
+                                const std::vector<std::string>& preferred_technologies) {
+    std::vector<int> preferred = technologyIds(preferred_technologies);
+    int weight = 2 * static_cast<int>(preferred.size());
+
+    for (int id : technologyMatcher()->findIds(user_skills, true)) {
+        if (!std::binary_search(preferred.begin(), preferred.end(), id)) {
+            weight++;
+        }
+    }
+
+    return weight;
+}
+
+double JobParser::calculateTechnologyMatchScore(const Job& job,
+                                                const std::string& user_skills,
+                                                const std::vector<std::string>& preferred_technologies) {
+    int total = technologyWeight(user_skills, preferred_technologies);
+
+    if (total == 0) {
+        return 0.0;
+    }
+
+    std::vector<int> preferred = technologyIds(preferred_technologies);
+    std::vector<int> skills = technologyMatcher()->findIds(user_skills, true);
+    std::vector<int> offered = job.technologies.empty()
+        ? technologyMatcher()->findIds(job.description, false)
+        : technologyIds(job.technologies);
+
+    int matched = 0;
+
+    for (int id : offered) {
+        if (std::binary_search(preferred.begin(), preferred.end(), id)) {
+            matched += 2;
+        } else if (std::binary_search(skills.begin(), skills.end(), id)) {
+            matched++;
+        }
+    }
+
+    return static_cast<double>(matched) / total;
+}
+
+double JobParser::calculateLocationMatchScore(const Job& job, const std::string& preferred_location) {
+    std::string preferred = RelevanceIndex::locationKey(preferred_location);
+
+    if (preferred == "remote" && isRemoteJob(job)) {
+        return 1.0;
+    }
+
+    return RelevanceIndex::locationScore(RelevanceIndex::locationKey(job.location.display_name), preferred);
+}
+
+double JobParser::calculateSalaryMatchScore(const Job& job, double desired_salary) {
+    return RelevanceIndex::salaryScore(job.salary_min, job.salary_max, desired_salary);
 }
@@ -1,18 +1,33 @@
 #ifndef JOBPARSER_H
 #define JOBPARSER_H
 
+#include <cstddef>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "TechnologyMatcher.h"
 #include "model/Job.h"
 #include "model/Location.h"
 
+class JobSnapshot;
+class JobStore;
+class SalarySketch;
+class ThreadPool;
+
 class JobParser {
 public:
     static std::vector<std::string> extractTechnologies(const std::string& description);
     static std::vector<std::string> extractTechnologiesWithAliases(const std::string& description);
 
+    // Dictionary used by the technology functions. Defaults to
+    // TechnologyMatcher::defaultDefinitions(); replacing it is safe while
+    // other threads are extracting.
+    static std::shared_ptr<const TechnologyMatcher> technologyMatcher();
+    static void setTechnologyDictionary(const std::vector<TechnologyDefinition>& definitions);
+    static void loadTechnologyDictionary(const std::string& path);
+
     static std::string categorizeJob(const Job& job);
 
     static bool parseSalary(const std::string& salary_str,
@@ -21,7 +36,14 @@ public:
 
     static bool validateSalaryRange(double min_salary, double max_salary);
     static void normalizeSalaryRange(double& min_salary, double& max_salary);
+    // Outside Tukey's far-out fences (3 IQR beyond the quartiles) of the
+    // salary midpoints. The collection overloads find exact quartiles, an
+    // O(n) pass per call; to check many salaries, build a SalarySketch (or
+    // use Database::salaryStatistics()) once and pass that, O(1) each.
     static bool isSalaryOutlier(double salary, const std::vector<Job>& jobs);
+    static bool isSalaryOutlier(double salary, const JobStore& store);
+    static bool isSalaryOutlier(double salary, const JobSnapshot& snapshot);
+    static bool isSalaryOutlier(double salary, const SalarySketch& salaries);
 
     static std::vector<Job> filterByTechnology(const std::vector<Job>& jobs,
                                                const std::string& technology);
@@ -29,7 +51,34 @@ public:
     // ✅ NEW FUNCTION
     static std::vector<Job> filterRemoteJobs(const std::vector<Job>& jobs);
 
+    // The test behind filterRemoteJobs.
+    static bool isRemoteJob(const Job& job);
+
+    // Positions in `jobs` of the matches, in order: the same selection as
+    // the filter functions without copying any Job.
+    static std::vector<std::size_t> findByTechnology(const std::vector<Job>& jobs,
+                                                     const std::string& technology);
+    static std::vector<std::size_t> findRemoteJobs(const std::vector<Job>& jobs);
+
+    // Jobs that already list their technologies are counted from that list;
+    // only the others have their description scanned. For stored jobs,
+    // Database::technologyCounts reads the same numbers from the rollups.
     static std::map<std::string, int> analyzeTechnologyTrends(const std::vector<Job>& jobs);
+    static std::map<std::string, int> analyzeTechnologyTrends(const JobStore& store);
+    static std::map<std::string, int> analyzeTechnologyTrends(const JobSnapshot& snapshot);
+
+    // Parallel versions. Results are identical to the sequential ones,
+    // including the order of filtered jobs.
+    static std::vector<Job> filterByTechnology(const std::vector<Job>& jobs,
+                                               const std::string& technology,
+                                               ThreadPool& pool);
+    static std::vector<Job> filterRemoteJobs(const std::vector<Job>& jobs, ThreadPool& pool);
+    static std::vector<std::size_t> findByTechnology(const std::vector<Job>& jobs,
+                                                     const std::string& technology,
+                                                     ThreadPool& pool);
+    static std::vector<std::size_t> findRemoteJobs(const std::vector<Job>& jobs, ThreadPool& pool);
+    static std::map<std::string, int> analyzeTechnologyTrends(const std::vector<Job>& jobs,
+                                                              ThreadPool& pool);
 
     static std::string normalizeCompanyName(const std::string& company_name);
     static Location parseLocation(const std::string& location_str);
@@ -37,6 +86,9 @@ public:
     static double calculateJobQualityScore(const Job& job);
     static std::string detectExperienceLevel(const Job& job);
 
+    // Best match first, ties in input order. Builds a RelevanceIndex over
+    // `jobs`; to rank several profiles against the same jobs, keep one
+    // index and call topK on it instead.
     static std::vector<Job> rankJobsByRelevance(
         const std::vector<Job>& jobs,
         const std::string& user_skills,
@@ -45,11 +97,29 @@ public:
         const std::vector<std::string>& preferred_technologies = {}
     );
 
+    // Score rankJobsByRelevance orders by, in [0, 1], for one job; usable
+    // as a JobQuery::sortBy score. See RelevanceIndex for the formula.
+    static double relevanceScore(const Job& job,
+                                 const std::string& user_skills,
+                                 const std::string& preferred_location = "",
+                                 double desired_salary = 0.0,
+                                 const std::vector<std::string>& preferred_technologies = {});
+
+    // Most similar first by MinHash estimate of shared vocabulary, never
+    // including `reference_job` (by id). Builds a SimilarityIndex over
+    // `all_jobs`; for repeated lookups keep one index and call nearest.
     static std::vector<Job> findSimilarJobs(const Job& reference_job,
                                             const std::vector<Job>& all_jobs,
                                             int max_results = 10);
 
 private:
+    // Sorted ids of technology names, accepting dictionary spellings too.
+    static std::vector<int> technologyIds(const std::vector<std::string>& names);
+
+    // Skills count 1, preferred technologies 2.
+    static int technologyWeight(const std::string& user_skills,
+                                const std::vector<std::string>& preferred_technologies);
+
     static double calculateTechnologyMatchScore(
         const Job& job,
         const std::string& user_skills,
@@ -0,0 +1,244 @@
+#include "JobQuery.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "JobParser.h"
+#include "TextSearch.h"
+#include "ThreadPool.h"
+
+namespace {
+
+// Candidates per parallel task; predicates are cheap, so chunks are larger
+// than JobParser's.
+constexpr std::size_t kQueryChunk = 4096;
+
+} // namespace
+
+JobQuery::JobQuery(const std::vector<Job>& jobs)
+    : collection(&jobs),
+      highest_first(true),
+      limit(static_cast<std::size_t>(-1)) {}
+
+bool JobQuery::matches(const Job& job) const {
+    for (const auto& filter : filters) {
+        if (!filter(job)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::size_t JobQuery::candidateCount() const {
+    return rows ? rows->size() : collection->size();
+}
+
+std::size_t JobQuery::candidateAt(std::size_t position) const {
+    return rows ? (*rows)[position] : position;
+}
+
+JobQuery JobQuery::where(Predicate predicate) const {
+    JobQuery query = *this;
+    query.filters.push_back(std::move(predicate));
+    return query;
+}
+
+JobQuery JobQuery::remote() const {
+    return where(JobParser::isRemoteJob);
+}
+
+JobQuery JobQuery::withTechnology(const std::string& technology) const {
+    // Same test as JobParser::filterByTechnology.
+    return where([technology](const Job& job) {
+        return TextSearch::containsIgnoreCase(job.description, technology);
+    });
+}
+
+JobQuery JobQuery::minSalary(double salary) const {
+    // Same test as SearchFilters::min_salary.
+    return where([salary](const Job& job) {
+        return job.salary_min >= salary;
+    });
+}
+
+JobQuery JobQuery::inLocation(const std::string& location) const {
+    return where([location](const Job& job) {
+        return TextSearch::containsIgnoreCase(job.location.display_name, location);
+    });
+}
+
+JobQuery JobQuery::inCategory(const std::string& category) const {
+    return where([category](const Job& job) {
+        return (job.category.empty() ? JobParser::categorizeJob(job) : job.category) == category;
+    });
+}
+
+JobQuery JobQuery::distinct() const {
+    return where([](const Job& job) {
+        return job.duplicate_of.empty();
+    });
+}
+
+JobQuery JobQuery::sortBy(Score job_score, bool highest_first_order) const {
+    JobQuery query = *this;
+    query.score = std::move(job_score);
+    query.highest_first = highest_first_order;
+    return query;
+}
+
+JobQuery JobQuery::top(std::size_t k) const {
+    JobQuery query = *this;
+    query.limit = std::min(limit, k);
+    return query;
+}
+
+std::vector<std::size_t> JobQuery::filtered(ThreadPool* pool) const {
+    const std::size_t candidates = candidateCount();
+    const std::vector<Job>& jobs = *collection;
+
+    // Without a sort, the first `limit` matches are the answer.
+    if (!pool || candidates <= kQueryChunk) {
+        std::size_t wanted = score ? candidates : std::min(limit, candidates);
+        std::vector<std::size_t> result;
+
+        for (std::size_t p = 0; p < candidates && result.size() < wanted; p++) {
+            std::size_t row = candidateAt(p);
+
+            if (matches(jobs[row])) {
+                result.push_back(row);
+            }
+        }
+
+        return result;
+    }
+
+    std::size_t chunks = (candidates + kQueryChunk - 1) / kQueryChunk;
+    std::vector<std::vector<std::size_t>> partial(chunks);
+
+    pool->parallelFor(candidates, kQueryChunk,
+                      [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+        for (std::size_t p = begin; p < end; p++) {
+            std::size_t row = candidateAt(p);
+
+            if (matches(jobs[row])) {
+                partial[chunk].push_back(row);
+            }
+        }
+    });
+
+    std::size_t total = 0;
+
+    for (const auto& chunk : partial) {
+        total += chunk.size();
+    }
+
+    std::vector<std::size_t> result;
+    result.reserve(total);
+
+    for (const auto& chunk : partial) {
+        result.insert(result.end(), chunk.begin(), chunk.end());
+    }
+
+    if (!score && result.size() > limit) {
+        result.resize(limit);
+    }
+
+    return result;
+}
+
+std::vector<std::size_t> JobQuery::evaluate(ThreadPool* pool) const {
+    std::vector<std::size_t> result = filtered(pool);
+
+    if (!score) {
+        return result;
+    }
+
+    // Score each survivor once; the position breaks ties so the order is
+    // total and does not depend on the sort algorithm.
+    struct Ranked {
+        double score;
+        std::size_t position;
+    };
+
+    std::vector<Ranked> ranked(result.size());
+
+    auto scoreRange = [&](std::size_t, std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            double value = score((*collection)[result[i]]);
+
+            // NaN compares false both ways, which would break the sort.
+            if (std::isnan(value)) {
+                value = -std::numeric_limits<double>::infinity();
+            }
+
+            ranked[i] = Ranked{highest_first ? -value : value, i};
+        }
+    };
+
+    if (pool) {
+        pool->parallelFor(result.size(), kQueryChunk, scoreRange);
+    } else {
+        scoreRange(0, 0, result.size());
+    }
+
+    auto before = [](const Ranked& a, const Ranked& b) {
+        return a.score < b.score || (a.score == b.score && a.position < b.position);
+    };
+
+    std::size_t keep = std::min(limit, ranked.size());
+
+    if (keep < ranked.size()) {
+        std::partial_sort(ranked.begin(), ranked.begin() + static_cast<std::ptrdiff_t>(keep),
+                          ranked.end(), before);
+        ranked.resize(keep);
+    } else {
+        std::sort(ranked.begin(), ranked.end(), before);
+    }
+
+    std::vector<std::size_t> ordered;
+    ordered.reserve(ranked.size());
+
+    for (const auto& entry : ranked) {
+        ordered.push_back(result[entry.position]);
+    }
+
+    return ordered;
+}
+
+JobQuery JobQuery::narrow() const {
+    JobQuery query(*collection);
+    query.rows = std::make_shared<const std::vector<std::size_t>>(evaluate(nullptr));
+    return query;
+}
+
+JobQuery JobQuery::narrow(ThreadPool& pool) const {
+    JobQuery query(*collection);
+    query.rows = std::make_shared<const std::vector<std::size_t>>(evaluate(&pool));
+    return query;
+}
+
+std::vector<std::size_t> JobQuery::indices() const {
+    return evaluate(nullptr);
+}
+
+std::vector<std::size_t> JobQuery::indices(ThreadPool& pool) const {
+    return evaluate(&pool);
+}
+
+std::vector<const Job*> JobQuery::refs() const {
+    return project([](const Job& job) { return &job; });
+}
+
+std::vector<Job> JobQuery::materialize() const {
+    return project([](const Job& job) { return job; });
+}
+
+std::size_t JobQuery::count() const {
+    if (!score && filters.empty()) {
+        return std::min(limit, candidateCount());
+    }
+
+    return evaluate(nullptr).size();
+}
@@ -0,0 +1,111 @@
+#ifndef JOBQUERY_H
+#define JOBQUERY_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "model/Job.h"
+
+class ThreadPool;
+
+// Lazy, composable selection over a job collection. Building a query only
+// records steps; nothing is scanned until a terminal call (indices, refs,
+// materialize, project, count). Results are positions in the original
+// vector, so no Job is copied unless materialize() asks for it.
+//
+// Filters run as one fused pass, in the order they were added. sortBy
+// orders the survivors by a score computed once per job, highest first by
+// default, with ties kept in collection order; a NaN score counts as the
+// lowest. top(k) keeps the first k results, by partial sort when a score is
+// set and by stopping the scan early when not.
+//
+// The steps always run in that order, filter, sort, top, whichever order
+// the builders are called in: top(10).remote() is the first ten remote
+// jobs, not the remote ones among the first ten. A later sortBy replaces
+// an earlier one and the smallest top wins. To apply a step to the result
+// of earlier ones, narrow() first.
+//
+// Queries are small values: every builder returns a new query and leaves
+// its source unchanged, so chains can branch. The collection must outlive
+// the queries over it and must not change while they are used.
+class JobQuery {
+public:
+    using Predicate = std::function<bool(const Job&)>;
+    using Score = std::function<double(const Job&)>;
+
+private:
+    const std::vector<Job>* collection;
+
+    // Candidate positions, in result order; null means every row.
+    std::shared_ptr<const std::vector<std::size_t>> rows;
+
+    std::vector<Predicate> filters;
+    Score score;
+    bool highest_first;
+    std::size_t limit;
+
+    bool matches(const Job& job) const;
+    std::size_t candidateCount() const;
+    std::size_t candidateAt(std::size_t position) const;
+
+    std::vector<std::size_t> filtered(ThreadPool* pool) const;
+    std::vector<std::size_t> evaluate(ThreadPool* pool) const;
+
+public:
+    explicit JobQuery(const std::vector<Job>& jobs);
+
+    JobQuery where(Predicate predicate) const;
+    JobQuery remote() const;
+    JobQuery withTechnology(const std::string& technology) const;
+    JobQuery minSalary(double salary) const;
+    JobQuery inLocation(const std::string& location) const;
+    JobQuery inCategory(const std::string& category) const;
+
+    // Drops jobs flagged as near-duplicates of an earlier posting.
+    JobQuery distinct() const;
+
+    JobQuery sortBy(Score job_score, bool highest_first_order = true) const;
+    JobQuery top(std::size_t k) const;
+
+    // Runs the query now and starts a fresh one over its results, so later
+    // refinements only scan what is left (and keep its order).
+    JobQuery narrow() const;
+    JobQuery narrow(ThreadPool& pool) const;
+
+    std::vector<std::size_t> indices() const;
+    std::vector<std::size_t> indices(ThreadPool& pool) const;
+    std::vector<const Job*> refs() const;
+    std::vector<Job> materialize() const;
+    std::size_t count() const;
+
+    // Applies `projection` to each result, e.g. to pull out titles as
+    // string_views without copying them.
+    template<typename Projection>
+    auto project(Projection projection) const
+        -> std::vector<std::decay_t<decltype(projection(std::declval<const Job&>()))>>;
+
+    const std::vector<Job>& source() const {
+        return *collection;
+    }
+};
+
+template<typename Projection>
+auto JobQuery::project(Projection projection) const
+    -> std::vector<std::decay_t<decltype(projection(std::declval<const Job&>()))>> {
+    std::vector<std::decay_t<decltype(projection(std::declval<const Job&>()))>> values;
+    std::vector<std::size_t> positions = evaluate(nullptr);
+    values.reserve(positions.size());
+
+    for (std::size_t i : positions) {
+        values.push_back(projection((*collection)[i]));
+    }
+
+    return values;
+}
+
+#endif
@@ -0,0 +1,553 @@
+#include "JobSnapshot.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "JobStore.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// File layout, integers in the writer's native byte order, which the
+// header's kByteOrderMark records so open() can refuse a foreign one:
+//   Header | kSectionCount x SectionEntry | sections, each 8-byte aligned
+const char kMagic[8] = {'J', 'M', 'S', 'N', 'A', 'P', '\0', '\0'};
+const std::uint32_t kVersion = 2;
+const std::uint32_t kByteOrderMark = 0x01020304;
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t row_count;
+    std::uint32_t section_count;
+    std::uint32_t checksum;   // CRC-32 of this header (with checksum 0) and the section table
+};
+
+struct SectionEntry {
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint32_t checksum;   // CRC-32 of the section's bytes
+    std::uint32_t reserved;
+};
+
+// String sections come in pairs: the offsets, then the bytes they index.
+enum Section : std::size_t {
+    kIdOffsets, kIdBytes,
+    kTitleOffsets, kTitleBytes,
+    kDescriptionOffsets, kDescriptionBytes,
+    kRedirectUrlOffsets, kRedirectUrlBytes,
+    kCreatedOffsets, kCreatedBytes,
+    kCompanyNameOffsets, kCompanyNameBytes,
+    kLocationNameOffsets, kLocationNameBytes,
+    kCategoryNameOffsets, kCategoryNameBytes,
+    kTechnologyNameOffsets, kTechnologyNameBytes,
+    kCompanyIds,
+    kLocationIds,
+    kCategoryIds,
+    kSalaryMins,
+    kSalaryMaxes,
+    kTechnologyOffsets,
+    kTechnologyIds,
+    kCompanyKeyOffsets, kCompanyKeyBytes,
+    kLocationAreaOffsets, kLocationAreaBytes,
+    kLocationCountryOffsets, kLocationCountryBytes,
+    kDuplicateOfOffsets, kDuplicateOfBytes,
+    kSimHashes,
+    kMinHashOffsets,
+    kMinHashValues,
+    kSectionCount
+};
+
+const std::size_t kTableEnd = sizeof(Header) + kSectionCount * sizeof(SectionEntry);
+
+// zlib's crc32 takes 32-bit lengths.
+std::uint32_t crc(std::uint32_t value, const void* data, std::size_t size) {
+    const Bytef* bytes = static_cast<const Bytef*>(data);
+
+    while (size > 0) {
+        uInt chunk = static_cast<uInt>(std::min<std::size_t>(size, 1u << 30));
+        value = static_cast<std::uint32_t>(crc32(value, bytes, chunk));
+        bytes += chunk;
+        size -= chunk;
+    }
+
+    return value;
+}
+
+std::uint32_t tableChecksum(Header header, const SectionEntry* table) {
+    header.checksum = 0;
+    std::uint32_t value = crc(0, &header, sizeof(header));
+    return crc(value, table, kSectionCount * sizeof(SectionEntry));
+}
+
+// Streams sections to `out` one after another, recording where each one
+// lands and its checksum.
+class SectionWriter {
+private:
+    std::ofstream& out;
+    std::vector<SectionEntry>& table;
+    std::uint64_t position;
+    std::string buffer;
+    SectionEntry* current;
+
+    void flush() {
+        current->checksum = crc(current->checksum, buffer.data(), buffer.size());
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        position += buffer.size();
+        buffer.clear();
+    }
+
+public:
+    SectionWriter(std::ofstream& out, std::vector<SectionEntry>& table)
+        : out(out), table(table), position(kTableEnd), current(nullptr) {
+        buffer.reserve(1 << 16);
+    }
+
+    void begin(Section section) {
+        static const char padding[8] = {};
+        std::size_t pad = static_cast<std::size_t>((8 - position % 8) % 8);
+        out.write(padding, static_cast<std::streamsize>(pad));
+        position += pad;
+
+        current = &table[section];
+        current->offset = position;
+        current->checksum = 0;
+    }
+
+    void append(const void* data, std::size_t size) {
+        buffer.append(static_cast<const char*>(data), size);
+
+        if (buffer.size() >= (1 << 16)) {
+            flush();
+        }
+    }
+
+    template<typename T>
+    void value(T item) {
+        append(&item, sizeof(item));
+    }
+
+    void end() {
+        flush();
+        current->size = position - current->offset;
+    }
+};
+
+// Writes `count` strings as an offsets section and a bytes section.
+template<typename Lookup>
+void writeStrings(SectionWriter& writer, Section offsets_section, std::size_t count, Lookup lookup) {
+    std::uint64_t offset = 0;
+
+    writer.begin(offsets_section);
+    writer.value(offset);
+
+    for (std::size_t i = 0; i < count; i++) {
+        offset += lookup(i).size();
+        writer.value(offset);
+    }
+
+    writer.end();
+    writer.begin(static_cast<Section>(offsets_section + 1));
+
+    for (std::size_t i = 0; i < count; i++) {
+        std::string_view value = lookup(i);
+        writer.append(value.data(), value.size());
+    }
+
+    writer.end();
+}
+
+template<typename T>
+void writeArray(SectionWriter& writer, Section section, const T* values, std::size_t count) {
+    writer.begin(section);
+    writer.append(values, count * sizeof(T));
+    writer.end();
+}
+
+} // namespace
+
+JobSnapshot::JobSnapshot()
+    : mapping(nullptr),
+      mapping_size(0),
+      row_count(0),
+      company_ids(nullptr),
+      location_ids(nullptr),
+      category_ids(nullptr),
+      salary_min(nullptr),
+      salary_max(nullptr),
+      technology_offsets(nullptr),
+      technology_ids(nullptr),
+      technology_id_count(0),
+      simhashes(nullptr),
+      minhash_offsets(nullptr),
+      minhash_values(nullptr),
+      minhash_value_count(0) {}
+
+JobSnapshot::~JobSnapshot() {
+    close();
+}
+
+bool JobSnapshot::write(const std::string& path, const std::vector<Job>& jobs) {
+    std::vector<SectionEntry> table(kSectionCount, SectionEntry{0, 0, 0, 0});
+    JobStore store(jobs);
+    std::size_t rows = store.size();
+
+    // Write beside the target and rename, so readers never see half a file.
+    fs::path temporary = path;
+    temporary += ".tmp";
+
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+
+        if (!out) {
+            std::cerr << "Cannot write snapshot " << temporary.string() << '\n';
+            return false;
+        }
+
+        // Header and table are filled in once the sections are placed.
+        out.write(std::string(kTableEnd, '\0').data(), static_cast<std::streamsize>(kTableEnd));
+
+        SectionWriter writer(out, table);
+
+        writeStrings(writer, kIdOffsets, rows, [&](std::size_t row) { return store.id(row); });
+        writeStrings(writer, kTitleOffsets, rows, [&](std::size_t row) { return store.title(row); });
+        writeStrings(writer, kDescriptionOffsets, rows, [&](std::size_t row) { return store.description(row); });
+        writeStrings(writer, kRedirectUrlOffsets, rows, [&](std::size_t row) { return store.redirectUrl(row); });
+        writeStrings(writer, kCreatedOffsets, rows, [&](std::size_t row) { return store.created(row); });
+
+        auto names = [&](Section section, const StringInterner& interner) {
+            writeStrings(writer, section, interner.size(),
+                         [&](std::size_t id) { return std::string_view(interner.str(static_cast<std::uint32_t>(id))); });
+        };
+
+        names(kCompanyNameOffsets, store.companyNames());
+        names(kLocationNameOffsets, store.locationNames());
+        names(kCategoryNameOffsets, store.categoryNames());
+        names(kTechnologyNameOffsets, store.technologyNames());
+
+        std::vector<std::uint32_t> column(rows);
+
+        for (std::size_t row = 0; row < rows; row++) {
+            column[row] = store.companyId(row);
+        }
+
+        writeArray(writer, kCompanyIds, column.data(), rows);
+
+        for (std::size_t row = 0; row < rows; row++) {
+            column[row] = store.locationId(row);
+        }
+
+        writeArray(writer, kLocationIds, column.data(), rows);
+
+        for (std::size_t row = 0; row < rows; row++) {
+            column[row] = store.categoryId(row);
+        }
+
+        writeArray(writer, kCategoryIds, column.data(), rows);
+        writeArray(writer, kSalaryMins, store.salaryMins().data(), rows);
+        writeArray(writer, kSalaryMaxes, store.salaryMaxes().data(), rows);
+
+        const std::vector<std::uint32_t>& technology_column = store.allTechnologyIds();
+
+        column.resize(rows + 1);
+        column[0] = 0;
+
+        for (std::size_t row = 0; row < rows; row++) {
+            column[row + 1] = static_cast<std::uint32_t>(store.technologiesEnd(row) - technology_column.data());
+        }
+
+        writeArray(writer, kTechnologyOffsets, column.data(), rows + 1);
+        writeArray(writer, kTechnologyIds, technology_column.data(), technology_column.size());
+
+        // Fields JobStore has no column for, straight from the jobs.
+        writeStrings(writer, kCompanyKeyOffsets, rows, [&](std::size_t row) { return std::string_view(jobs[row].company.id); });
+        writeStrings(writer, kLocationAreaOffsets, rows, [&](std::size_t row) { return std::string_view(jobs[row].location.area); });
+        writeStrings(writer, kLocationCountryOffsets, rows, [&](std::size_t row) { return std::string_view(jobs[row].location.country); });
+        writeStrings(writer, kDuplicateOfOffsets, rows, [&](std::size_t row) { return std::string_view(jobs[row].duplicate_of); });
+
+        writer.begin(kSimHashes);
+
+        for (const auto& job : jobs) {
+            writer.value(job.simhash);
+        }
+
+        writer.end();
+
+        std::uint32_t minhash_end = 0;
+        writer.begin(kMinHashOffsets);
+        writer.value(minhash_end);
+
+        for (const auto& job : jobs) {
+            minhash_end += static_cast<std::uint32_t>(job.minhash.size());
+            writer.value(minhash_end);
+        }
+
+        writer.end();
+        writer.begin(kMinHashValues);
+
+        for (const auto& job : jobs) {
+            writer.append(job.minhash.data(), job.minhash.size() * sizeof(std::uint32_t));
+        }
+
+        writer.end();
+
+        Header header;
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.byte_order = kByteOrderMark;
+        header.row_count = rows;
+        header.section_count = kSectionCount;
+        header.checksum = tableChecksum(header, table.data());
+
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(table.data()),
+                  static_cast<std::streamsize>(kSectionCount * sizeof(SectionEntry)));
+
+        if (!out.flush()) {
+            std::cerr << "Cannot write snapshot " << temporary.string() << '\n';
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(temporary, path, ec);
+
+    if (ec) {
+        std::cerr << "Cannot replace snapshot " << path << ": " << ec.message() << '\n';
+        fs::remove(temporary, ec);
+        return false;
+    }
+
+    return true;
+}
+
+bool JobSnapshot::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        std::cerr << "Cannot open snapshot " << path << ": " << std::strerror(errno) << '\n';
+        return false;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < kTableEnd) {
+        std::cerr << path << " is not a job snapshot\n";
+        ::close(fd);
+        return false;
+    }
+
+    std::size_t size = static_cast<std::size_t>(info.st_size);
+    void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping keeps the file open.
+    ::close(fd);
+
+    if (address == MAP_FAILED) {
+        std::cerr << "Cannot map snapshot " << path << ": " << std::strerror(errno) << '\n';
+        return false;
+    }
+
+    mapping = static_cast<const unsigned char*>(address);
+    mapping_size = size;
+
+    if (!mapSections()) {
+        std::cerr << path << " is not a valid job snapshot\n";
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+bool JobSnapshot::mapSections() {
+    Header header;
+    std::memcpy(&header, mapping, sizeof(header));
+
+    if (!std::equal(kMagic, kMagic + sizeof(kMagic), header.magic) ||
+        header.version != kVersion ||
+        header.byte_order != kByteOrderMark ||
+        header.section_count != kSectionCount) {
+        return false;
+    }
+
+    // The mapping is page aligned, so the table and every 8-byte aligned
+    // section can be read in place.
+    const SectionEntry* table = reinterpret_cast<const SectionEntry*>(mapping + sizeof(Header));
+
+    if (tableChecksum(header, table) != header.checksum) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < kSectionCount; i++) {
+        if (table[i].offset % 8 != 0 || table[i].offset < kTableEnd ||
+            table[i].offset > mapping_size || table[i].size > mapping_size - table[i].offset) {
+            return false;
+        }
+    }
+
+    // Every row takes bytes in several sections, which bounds the count
+    // before it is multiplied.
+    if (header.row_count > mapping_size) {
+        return false;
+    }
+
+    std::size_t rows = static_cast<std::size_t>(header.row_count);
+
+    auto sized = [&](Section section, std::size_t count, std::size_t width) {
+        return table[section].size == count * width;
+    };
+
+    auto strings = [&](Section offsets_section, MappedStrings& column) {
+        const SectionEntry& offsets = table[offsets_section];
+        const SectionEntry& bytes = table[offsets_section + 1];
+
+        if (offsets.size < 8 || offsets.size % 8 != 0) {
+            return false;
+        }
+
+        std::size_t count = static_cast<std::size_t>(offsets.size / 8 - 1);
+        const std::uint64_t* begin = reinterpret_cast<const std::uint64_t*>(mapping + offsets.offset);
+
+        if (begin[0] != 0 || begin[count] != bytes.size) {
+            return false;
+        }
+
+        column = MappedStrings(begin, reinterpret_cast<const char*>(mapping + bytes.offset), count, bytes.size);
+        return true;
+    };
+
+    bool ok = strings(kIdOffsets, ids) && ids.size() == rows &&
+              strings(kTitleOffsets, titles) && titles.size() == rows &&
+              strings(kDescriptionOffsets, descriptions) && descriptions.size() == rows &&
+              strings(kRedirectUrlOffsets, redirect_urls) && redirect_urls.size() == rows &&
+              strings(kCreatedOffsets, created_dates) && created_dates.size() == rows &&
+              strings(kCompanyNameOffsets, companies) &&
+              strings(kLocationNameOffsets, locations) &&
+              strings(kCategoryNameOffsets, categories) &&
+              strings(kTechnologyNameOffsets, technologies) &&
+              strings(kCompanyKeyOffsets, company_keys) && company_keys.size() == rows &&
+              strings(kLocationAreaOffsets, location_areas) && location_areas.size() == rows &&
+              strings(kLocationCountryOffsets, location_countries) && location_countries.size() == rows &&
+              strings(kDuplicateOfOffsets, duplicate_ofs) && duplicate_ofs.size() == rows &&
+              sized(kCompanyIds, rows, sizeof(std::uint32_t)) &&
+              sized(kLocationIds, rows, sizeof(std::uint32_t)) &&
+              sized(kCategoryIds, rows, sizeof(std::uint32_t)) &&
+              sized(kSalaryMins, rows, sizeof(double)) &&
+              sized(kSalaryMaxes, rows, sizeof(double)) &&
+              sized(kTechnologyOffsets, rows + 1, sizeof(std::uint32_t)) &&
+              table[kTechnologyIds].size % sizeof(std::uint32_t) == 0 &&
+              sized(kSimHashes, rows, sizeof(std::uint64_t)) &&
+              sized(kMinHashOffsets, rows + 1, sizeof(std::uint32_t)) &&
+              table[kMinHashValues].size % sizeof(std::uint32_t) == 0;
+
+    if (!ok) {
+        return false;
+    }
+
+    auto at = [&](Section section) {
+        return mapping + table[section].offset;
+    };
+
+    row_count = rows;
+    company_ids = reinterpret_cast<const std::uint32_t*>(at(kCompanyIds));
+    location_ids = reinterpret_cast<const std::uint32_t*>(at(kLocationIds));
+    category_ids = reinterpret_cast<const std::uint32_t*>(at(kCategoryIds));
+    salary_min = reinterpret_cast<const double*>(at(kSalaryMins));
+    salary_max = reinterpret_cast<const double*>(at(kSalaryMaxes));
+    technology_offsets = reinterpret_cast<const std::uint32_t*>(at(kTechnologyOffsets));
+    technology_ids = reinterpret_cast<const std::uint32_t*>(at(kTechnologyIds));
+    technology_id_count = static_cast<std::size_t>(table[kTechnologyIds].size / sizeof(std::uint32_t));
+    simhashes = reinterpret_cast<const std::uint64_t*>(at(kSimHashes));
+    minhash_offsets = reinterpret_cast<const std::uint32_t*>(at(kMinHashOffsets));
+    minhash_values = reinterpret_cast<const std::uint32_t*>(at(kMinHashValues));
+    minhash_value_count = static_cast<std::size_t>(table[kMinHashValues].size / sizeof(std::uint32_t));
+
+    return technology_offsets[0] == 0 && technology_offsets[rows] == technology_id_count &&
+           minhash_offsets[0] == 0 && minhash_offsets[rows] == minhash_value_count;
+}
+
+void JobSnapshot::close() {
+    if (mapping != nullptr) {
+        munmap(const_cast<unsigned char*>(mapping), mapping_size);
+    }
+
+    mapping = nullptr;
+    mapping_size = 0;
+    row_count = 0;
+
+    ids = titles = descriptions = redirect_urls = created_dates = MappedStrings();
+    companies = locations = categories = technologies = MappedStrings();
+    company_keys = location_areas = location_countries = duplicate_ofs = MappedStrings();
+
+    company_ids = location_ids = category_ids = nullptr;
+    salary_min = salary_max = nullptr;
+    technology_offsets = technology_ids = nullptr;
+    technology_id_count = 0;
+    simhashes = nullptr;
+    minhash_offsets = minhash_values = nullptr;
+    minhash_value_count = 0;
+}
+
+bool JobSnapshot::verify() const {
+    if (mapping == nullptr) {
+        return false;
+    }
+
+    const SectionEntry* table = reinterpret_cast<const SectionEntry*>(mapping + sizeof(Header));
+
+    for (std::size_t i = 0; i < kSectionCount; i++) {
+        if (crc(0, mapping + table[i].offset, static_cast<std::size_t>(table[i].size)) != table[i].checksum) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+Job JobSnapshot::job(std::size_t row) const {
+    Job job;
+
+    job.id = std::string(id(row));
+    job.title = std::string(title(row));
+    job.company.display_name = std::string(company(row));
+    job.company.id = std::string(companyKey(row));
+    job.location.display_name = std::string(location(row));
+    job.location.area = std::string(locationArea(row));
+    job.location.country = std::string(locationCountry(row));
+    job.category = std::string(category(row));
+    job.salary_min = salary_min[row];
+    job.salary_max = salary_max[row];
+    job.description = std::string(description(row));
+    job.redirect_url = std::string(redirectUrl(row));
+    job.created = std::string(created(row));
+
+    for (auto it = technologiesBegin(row); it != technologiesEnd(row); ++it) {
+        if (*it < technologies.size()) {
+            job.technologies.push_back(std::string(technologies.str(*it)));
+        }
+    }
+
+    job.minhash.assign(minHashBegin(row), minHashEnd(row));
+    job.simhash = simhashes[row];
+    job.duplicate_of = std::string(duplicateOf(row));
+
+    return job;
+}
@@ -0,0 +1,189 @@
+#ifndef JOBSNAPSHOT_H
+#define JOBSNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "model/Job.h"
+
+// Strings stored back to back and addressed by index through `count + 1`
+// offsets, read in place from a mapped file. An index past the end, or
+// offsets that do not fit the bytes (a damaged file), give an empty string.
+class MappedStrings {
+private:
+    const std::uint64_t* offsets = nullptr;
+    const char* bytes = nullptr;
+    std::size_t count = 0;
+    std::uint64_t byte_count = 0;
+
+public:
+    MappedStrings() = default;
+
+    MappedStrings(const std::uint64_t* offsets, const char* bytes, std::size_t count, std::uint64_t byte_count)
+        : offsets(offsets), bytes(bytes), count(count), byte_count(byte_count) {}
+
+    std::string_view str(std::size_t i) const {
+        if (i >= count || offsets[i] > offsets[i + 1] || offsets[i + 1] > byte_count) {
+            return std::string_view();
+        }
+
+        return std::string_view(bytes + offsets[i], static_cast<std::size_t>(offsets[i + 1] - offsets[i]));
+    }
+
+    std::size_t size() const {
+        return count;
+    }
+};
+
+// Jobs written to disk in JobStore's column layout and read back with
+// mmap, so opening one costs a few page faults instead of a parse: every
+// accessor reads the mapping in place and pages come in as they are
+// touched. Read-only; write() takes a new snapshot.
+//
+// The file is a header, a table of sections (offset, size, CRC-32) and the
+// sections themselves, 8-byte aligned: fixed-width id, salary and SimHash
+// columns, and an offset table plus a byte heap for each text column,
+// interned name table and list column (technologies, MinHash). Integers
+// are in the writer's native byte order, recorded in the header; a
+// snapshot from a machine of the other byte order fails to open.
+class JobSnapshot {
+private:
+    const unsigned char* mapping;
+    std::size_t mapping_size;
+    std::size_t row_count;
+
+    MappedStrings ids;
+    MappedStrings titles;
+    MappedStrings descriptions;
+    MappedStrings redirect_urls;
+    MappedStrings created_dates;
+
+    MappedStrings companies;
+    MappedStrings locations;
+    MappedStrings categories;
+    MappedStrings technologies;
+
+    const std::uint32_t* company_ids;
+    const std::uint32_t* location_ids;
+    const std::uint32_t* category_ids;
+    const double* salary_min;
+    const double* salary_max;
+
+    // Technologies of row i are technology_ids[technology_offsets[i] ..
+    // technology_offsets[i + 1]).
+    const std::uint32_t* technology_offsets;
+    const std::uint32_t* technology_ids;
+    std::size_t technology_id_count;
+
+    // Job fields kept only so job(row) gives back what was written.
+    MappedStrings company_keys;
+    MappedStrings location_areas;
+    MappedStrings location_countries;
+    MappedStrings duplicate_ofs;
+    const std::uint64_t* simhashes;
+
+    // MinHash signature of row i is minhash_values[minhash_offsets[i] ..
+    // minhash_offsets[i + 1]).
+    const std::uint32_t* minhash_offsets;
+    const std::uint32_t* minhash_values;
+    std::size_t minhash_value_count;
+
+    bool mapSections();
+
+    // `offset` limited to [low, high], low itself limited to high.
+    static std::size_t clamp(std::uint32_t offset, std::size_t low, std::size_t high) {
+        low = low < high ? low : high;
+        return offset < low ? low : (offset > high ? high : offset);
+    }
+
+public:
+    JobSnapshot();
+    ~JobSnapshot();
+
+    JobSnapshot(const JobSnapshot&) = delete;
+    JobSnapshot& operator=(const JobSnapshot&) = delete;
+
+    // Writes `jobs` to `path`, every field of them, replacing it only once
+    // the new file is complete.
+    static bool write(const std::string& path, const std::vector<Job>& jobs);
+
+    // Maps `path` after checking its header, section table checksum and
+    // section bounds. The section contents are not read; verify() does that.
+    bool open(const std::string& path);
+    void close();
+
+    // Recomputes every section's CRC-32 (touching the whole file), for
+    // snapshots that may have been damaged since they were written.
+    bool verify() const;
+
+    bool isOpen() const {
+        return mapping != nullptr;
+    }
+
+    std::size_t size() const {
+        return row_count;
+    }
+
+    bool empty() const {
+        return row_count == 0;
+    }
+
+    std::string_view id(std::size_t row) const { return ids.str(row); }
+    std::string_view title(std::size_t row) const { return titles.str(row); }
+    std::string_view description(std::size_t row) const { return descriptions.str(row); }
+    std::string_view redirectUrl(std::size_t row) const { return redirect_urls.str(row); }
+    std::string_view created(std::size_t row) const { return created_dates.str(row); }
+    std::string_view companyKey(std::size_t row) const { return company_keys.str(row); }
+    std::string_view locationArea(std::size_t row) const { return location_areas.str(row); }
+    std::string_view locationCountry(std::size_t row) const { return location_countries.str(row); }
+    std::string_view duplicateOf(std::size_t row) const { return duplicate_ofs.str(row); }
+    std::uint64_t simhash(std::size_t row) const { return simhashes[row]; }
+
+    std::uint32_t companyId(std::size_t row) const { return company_ids[row]; }
+    std::uint32_t locationId(std::size_t row) const { return location_ids[row]; }
+    std::uint32_t categoryId(std::size_t row) const { return category_ids[row]; }
+
+    std::string_view company(std::size_t row) const { return companies.str(company_ids[row]); }
+    std::string_view location(std::size_t row) const { return locations.str(location_ids[row]); }
+    std::string_view category(std::size_t row) const { return categories.str(category_ids[row]); }
+
+    const MappedStrings& companyNames() const { return companies; }
+    const MappedStrings& locationNames() const { return locations; }
+    const MappedStrings& categoryNames() const { return categories; }
+    const MappedStrings& technologyNames() const { return technologies; }
+
+    // size() values each.
+    const double* salaryMins() const { return salary_min; }
+    const double* salaryMaxes() const { return salary_max; }
+
+    // Offsets are clamped to the id column, so a damaged file gives a short
+    // list rather than a read past it. The ids themselves are not checked:
+    // compare them with technologyNames().size() before indexing by them.
+    const std::uint32_t* technologiesBegin(std::size_t row) const {
+        return technology_ids + clamp(technology_offsets[row], 0, technology_id_count);
+    }
+
+    const std::uint32_t* technologiesEnd(std::size_t row) const {
+        return technology_ids + clamp(technology_offsets[row + 1], technology_offsets[row], technology_id_count);
+    }
+
+    // All technology ids of all rows, for whole-snapshot counting.
+    const std::uint32_t* allTechnologyIdsBegin() const { return technology_ids; }
+    const std::uint32_t* allTechnologyIdsEnd() const { return technology_ids + technology_id_count; }
+
+    const std::uint32_t* minHashBegin(std::size_t row) const {
+        return minhash_values + clamp(minhash_offsets[row], 0, minhash_value_count);
+    }
+
+    const std::uint32_t* minHashEnd(std::size_t row) const {
+        return minhash_values + clamp(minhash_offsets[row + 1], minhash_offsets[row], minhash_value_count);
+    }
+
+    // Rebuilds row `row` as a Job.
+    Job job(std::size_t row) const;
+};
+
+#endif
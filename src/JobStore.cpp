@@ -0,0 +1,117 @@
+#include "JobStore.h"
+
+#include "JobParser.h"
+
+std::uint32_t StringInterner::intern(std::string_view value) {
+    auto it = ids.find(value);
+
+    if (it != ids.end()) {
+        return it->second;
+    }
+
+    auto id = static_cast<std::uint32_t>(strings.size());
+    strings.emplace_back(value);
+    ids.emplace(strings.back(), id);
+
+    return id;
+}
+
+JobStore::JobStore(const std::vector<Job>& jobs) {
+    reserve(jobs.size());
+
+    // Size the text buffers exactly rather than letting them double.
+    std::size_t id_bytes = 0;
+    std::size_t title_bytes = 0;
+    std::size_t description_bytes = 0;
+    std::size_t url_bytes = 0;
+    std::size_t created_bytes = 0;
+
+    for (const auto& job : jobs) {
+        id_bytes += job.id.size();
+        title_bytes += job.title.size();
+        description_bytes += job.description.size();
+        url_bytes += job.redirect_url.size();
+        created_bytes += job.created.size();
+    }
+
+    ids.reserve(jobs.size(), id_bytes);
+    titles.reserve(jobs.size(), title_bytes);
+    descriptions.reserve(jobs.size(), description_bytes);
+    redirect_urls.reserve(jobs.size(), url_bytes);
+    created_dates.reserve(jobs.size(), created_bytes);
+
+    for (const auto& job : jobs) {
+        add(job);
+    }
+}
+
+void JobStore::reserve(std::size_t rows) {
+    company_ids.reserve(rows);
+    location_ids.reserve(rows);
+    category_ids.reserve(rows);
+    salary_min.reserve(rows);
+    salary_max.reserve(rows);
+    technology_offsets.reserve(rows + 1);
+}
+
+void JobStore::add(const Job& job) {
+    ids.append(job.id);
+    titles.append(job.title);
+    descriptions.append(job.description);
+    redirect_urls.append(job.redirect_url);
+    created_dates.append(job.created);
+
+    company_ids.push_back(companies.intern(job.company.display_name));
+    location_ids.push_back(locations.intern(job.location.display_name));
+    category_ids.push_back(categories.intern(job.category.empty() ? JobParser::categorizeJob(job)
+                                                                  : job.category));
+    salary_min.push_back(job.salary_min);
+    salary_max.push_back(job.salary_max);
+
+    if (job.technologies.empty()) {
+        auto matcher = JobParser::technologyMatcher();
+
+        for (int technology : matcher->findIds(job.description, false)) {
+            technology_ids.push_back(technologies.intern(matcher->name(technology)));
+        }
+    } else {
+        for (const auto& technology : job.technologies) {
+            technology_ids.push_back(technologies.intern(technology));
+        }
+    }
+
+    technology_offsets.push_back(static_cast<std::uint32_t>(technology_ids.size()));
+}
+
+Job JobStore::job(std::size_t row) const {
+    Job job;
+
+    job.id = std::string(id(row));
+    job.title = std::string(title(row));
+    job.company.display_name = company(row);
+    job.location.display_name = location(row);
+    job.category = category(row);
+    job.salary_min = salary_min[row];
+    job.salary_max = salary_max[row];
+    job.description = std::string(description(row));
+    job.redirect_url = std::string(redirectUrl(row));
+    job.created = std::string(created(row));
+
+    for (auto it = technologiesBegin(row); it != technologiesEnd(row); ++it) {
+        job.technologies.push_back(technologies.str(*it));
+    }
+
+    return job;
+}
+
+std::size_t JobStore::bytesUsed() const {
+    std::size_t bytes = ids.bytesUsed() + titles.bytesUsed() + descriptions.bytesUsed() +
+                        redirect_urls.bytesUsed() + created_dates.bytesUsed();
+
+    bytes += (company_ids.capacity() + location_ids.capacity() + category_ids.capacity()) *
+             sizeof(std::uint32_t);
+    bytes += (salary_min.capacity() + salary_max.capacity()) * sizeof(double);
+    bytes += (technology_offsets.capacity() + technology_ids.capacity()) * sizeof(std::uint32_t);
+
+    return bytes;
+}
@@ -0,0 +1,154 @@
+#ifndef JOBSTORE_H
+#define JOBSTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "model/Job.h"
+
+// Maps each distinct string to a small dense id. Strings are stored once and
+// never move, so the lookup table can key on views into them.
+class StringInterner {
+private:
+    std::deque<std::string> strings;
+    std::unordered_map<std::string_view, std::uint32_t> ids;
+
+public:
+    StringInterner() = default;
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+    StringInterner(StringInterner&&) = default;
+    StringInterner& operator=(StringInterner&&) = default;
+
+    std::uint32_t intern(std::string_view value);
+
+    const std::string& str(std::uint32_t id) const {
+        return strings[id];
+    }
+
+    std::size_t size() const {
+        return strings.size();
+    }
+};
+
+// Variable-length text packed into one buffer, addressed by row.
+class TextColumn {
+private:
+    std::string bytes;
+    std::vector<std::size_t> offsets{0};
+
+public:
+    void append(std::string_view value) {
+        bytes.append(value.data(), value.size());
+        offsets.push_back(bytes.size());
+    }
+
+    std::string_view at(std::size_t row) const {
+        return std::string_view(bytes).substr(offsets[row], offsets[row + 1] - offsets[row]);
+    }
+
+    void reserve(std::size_t rows, std::size_t total_bytes) {
+        offsets.reserve(rows + 1);
+        bytes.reserve(total_bytes);
+    }
+
+    std::size_t bytesUsed() const {
+        return bytes.capacity() + offsets.capacity() * sizeof(std::size_t);
+    }
+};
+
+// Column-oriented copy of a set of jobs for analytics. Company, location,
+// category and technology names are interned, so a row holds small ids
+// instead of its own strings; salaries sit in contiguous arrays and all
+// free text shares a few buffers. Aggregates become linear passes over
+// plain arrays. Rows are append-only.
+class JobStore {
+private:
+    StringInterner companies;
+    StringInterner locations;
+    StringInterner categories;
+    StringInterner technologies;
+
+    TextColumn ids;
+    TextColumn titles;
+    TextColumn descriptions;
+    TextColumn redirect_urls;
+    TextColumn created_dates;
+
+    std::vector<std::uint32_t> company_ids;
+    std::vector<std::uint32_t> location_ids;
+    std::vector<std::uint32_t> category_ids;
+    std::vector<double> salary_min;
+    std::vector<double> salary_max;
+
+    // Technologies of row i are technology_ids[technology_offsets[i] ..
+    // technology_offsets[i + 1]).
+    std::vector<std::uint32_t> technology_offsets{0};
+    std::vector<std::uint32_t> technology_ids;
+
+public:
+    JobStore() = default;
+    explicit JobStore(const std::vector<Job>& jobs);
+
+    // Jobs without technologies get them extracted from the description, and
+    // jobs without a category are categorized with JobParser::categorizeJob.
+    void add(const Job& job);
+    void reserve(std::size_t rows);
+
+    std::size_t size() const {
+        return company_ids.size();
+    }
+
+    bool empty() const {
+        return company_ids.empty();
+    }
+
+    std::string_view id(std::size_t row) const { return ids.at(row); }
+    std::string_view title(std::size_t row) const { return titles.at(row); }
+    std::string_view description(std::size_t row) const { return descriptions.at(row); }
+    std::string_view redirectUrl(std::size_t row) const { return redirect_urls.at(row); }
+    std::string_view created(std::size_t row) const { return created_dates.at(row); }
+
+    std::uint32_t companyId(std::size_t row) const { return company_ids[row]; }
+    std::uint32_t locationId(std::size_t row) const { return location_ids[row]; }
+    std::uint32_t categoryId(std::size_t row) const { return category_ids[row]; }
+
+    const std::string& company(std::size_t row) const { return companies.str(company_ids[row]); }
+    const std::string& location(std::size_t row) const { return locations.str(location_ids[row]); }
+    const std::string& category(std::size_t row) const { return categories.str(category_ids[row]); }
+
+    const StringInterner& companyNames() const { return companies; }
+    const StringInterner& locationNames() const { return locations; }
+    const StringInterner& categoryNames() const { return categories; }
+    const StringInterner& technologyNames() const { return technologies; }
+
+    const std::vector<double>& salaryMins() const { return salary_min; }
+    const std::vector<double>& salaryMaxes() const { return salary_max; }
+
+    const std::uint32_t* technologiesBegin(std::size_t row) const {
+        return technology_ids.data() + technology_offsets[row];
+    }
+
+    const std::uint32_t* technologiesEnd(std::size_t row) const {
+        return technology_ids.data() + technology_offsets[row + 1];
+    }
+
+    // All technology ids of all rows, for whole-store counting.
+    const std::vector<std::uint32_t>& allTechnologyIds() const {
+        return technology_ids;
+    }
+
+    // Rebuilds row `row` as a Job.
+    Job job(std::size_t row) const;
+
+    // Heap footprint of the columns; the interned strings are not counted.
+    std::size_t bytesUsed() const;
+};
+
+#endif
@@ -0,0 +1,415 @@
+#include "JsonStreamParser.h"
+
+#include <cerrno>
+#include <cstdlib>
+
+namespace {
+
+bool isWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool isNumberChar(char c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+// RFC 8259 number grammar: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+bool isValidNumber(const std::string& s, bool& is_float) {
+    std::size_t i = 0;
+    std::size_t n = s.size();
+    auto digits = [&]() {
+        std::size_t start = i;
+        while (i < n && s[i] >= '0' && s[i] <= '9') i++;
+        return i > start;
+    };
+
+    is_float = false;
+
+    if (i < n && s[i] == '-') i++;
+
+    if (i < n && s[i] == '0') {
+        i++;
+    } else if (!digits()) {
+        return false;
+    }
+
+    if (i < n && s[i] == '.') {
+        is_float = true;
+        i++;
+        if (!digits()) return false;
+    }
+
+    if (i < n && (s[i] == 'e' || s[i] == 'E')) {
+        is_float = true;
+        i++;
+        if (i < n && (s[i] == '+' || s[i] == '-')) i++;
+        if (!digits()) return false;
+    }
+
+    return i == n;
+}
+
+void appendUtf8(std::string& out, std::uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+} // namespace
+
+JsonStreamParser::JsonStreamParser(Sax* handler)
+    : sax(handler) {
+    reset();
+}
+
+void JsonStreamParser::reset() {
+    state = State::Value;
+    containers.clear();
+    token.clear();
+    token_is_key = false;
+    literal = nullptr;
+    literal_pos = 0;
+    unicode_value = 0;
+    unicode_digits = 0;
+    high_surrogate = 0;
+    offset = 0;
+    error_message.clear();
+}
+
+bool JsonStreamParser::fail(const std::string& message) {
+    if (state != State::Error) {
+        state = State::Error;
+        error_message = "syntax error at byte " + std::to_string(offset) + ": " + message;
+    }
+    return false;
+}
+
+bool JsonStreamParser::feed(const char* data, std::size_t size) {
+    const char* p = data;
+    const char* end = data + size;
+
+    while (p < end) {
+        if (state == State::String) {
+            // Copy plain string content in one go instead of per character.
+            const char* run = p;
+            while (p < end && *p != '"' && *p != '\\' &&
+                   static_cast<unsigned char>(*p) >= 0x20) {
+                ++p;
+            }
+            token.append(run, p);
+            offset += static_cast<std::size_t>(p - run);
+
+            if (p == end) {
+                break;
+            }
+        }
+
+        if (!step(*p)) {
+            return false;
+        }
+
+        ++p;
+        ++offset;
+    }
+
+    return state != State::Error;
+}
+
+bool JsonStreamParser::finish() {
+    if (state == State::Number && containers.empty()) {
+        if (!emitNumber() || !valueDone()) {
+            return false;
+        }
+    }
+
+    if (state == State::Error) {
+        return false;
+    }
+
+    if (state != State::Done) {
+        return fail("unexpected end of input");
+    }
+
+    return true;
+}
+
+bool JsonStreamParser::valueDone() {
+    state = containers.empty() ? State::Done : State::CommaOrEnd;
+    return true;
+}
+
+bool JsonStreamParser::emitNumber() {
+    bool is_float = false;
+
+    if (!isValidNumber(token, is_float)) {
+        return fail("invalid number '" + token + "'");
+    }
+
+    bool accepted = false;
+    bool in_range = false;
+
+    if (!is_float) {
+        errno = 0;
+
+        if (token[0] == '-') {
+            long long value = std::strtoll(token.c_str(), nullptr, 10);
+            in_range = errno != ERANGE;
+            if (in_range) accepted = sax->number_integer(value);
+        } else {
+            unsigned long long value = std::strtoull(token.c_str(), nullptr, 10);
+            in_range = errno != ERANGE;
+            if (in_range) accepted = sax->number_unsigned(value);
+        }
+    }
+
+    // Floats, and integers too large for 64 bits, are reported as doubles.
+    if (!in_range) {
+        accepted = sax->number_float(std::strtod(token.c_str(), nullptr), token);
+    }
+
+    return accepted || fail("parsing aborted by handler");
+}
+
+bool JsonStreamParser::finishUnicode() {
+    std::uint32_t cp = unicode_value;
+
+    if (high_surrogate != 0) {
+        if (cp < 0xDC00 || cp > 0xDFFF) {
+            return fail("surrogate U+D800..U+DBFF must be followed by U+DC00..U+DFFF");
+        }
+        cp = 0x10000 + ((high_surrogate - 0xD800) << 10) + (cp - 0xDC00);
+        high_surrogate = 0;
+    } else if (cp >= 0xD800 && cp <= 0xDBFF) {
+        high_surrogate = cp;
+        state = State::SurrogateBackslash;
+        return true;
+    } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+        return fail("surrogate U+DC00..U+DFFF must follow U+D800..U+DBFF");
+    }
+
+    appendUtf8(token, cp);
+    state = State::String;
+    return true;
+}
+
+bool JsonStreamParser::step(char c) {
+    switch (state) {
+        case State::Value:
+            if (isWhitespace(c)) return true;
+
+            switch (c) {
+                case '{':
+                    containers.push_back('{');
+                    state = State::ObjectKeyOrEnd;
+                    return sax->start_object(static_cast<std::size_t>(-1)) ||
+                           fail("parsing aborted by handler");
+                case '[':
+                    containers.push_back('[');
+                    state = State::ArrayValueOrEnd;
+                    return sax->start_array(static_cast<std::size_t>(-1)) ||
+                           fail("parsing aborted by handler");
+                case '"':
+                    token.clear();
+                    token_is_key = false;
+                    state = State::String;
+                    return true;
+                case 't':
+                    literal = "true";
+                    break;
+                case 'f':
+                    literal = "false";
+                    break;
+                case 'n':
+                    literal = "null";
+                    break;
+                default:
+                    if (c == '-' || (c >= '0' && c <= '9')) {
+                        token.assign(1, c);
+                        state = State::Number;
+                        return true;
+                    }
+                    return fail(std::string("unexpected '") + c + "'; expected value");
+            }
+
+            literal_pos = 1;
+            state = State::Literal;
+            return true;
+
+        case State::ArrayValueOrEnd:
+            if (isWhitespace(c)) return true;
+
+            if (c == ']') {
+                containers.pop_back();
+                return (sax->end_array() || fail("parsing aborted by handler")) && valueDone();
+            }
+
+            state = State::Value;
+            return step(c);
+
+        case State::ObjectKeyOrEnd:
+        case State::ObjectKey:
+            if (isWhitespace(c)) return true;
+
+            if (c == '}' && state == State::ObjectKeyOrEnd) {
+                containers.pop_back();
+                return (sax->end_object() || fail("parsing aborted by handler")) && valueDone();
+            }
+
+            if (c != '"') {
+                return fail("expected string literal for object key");
+            }
+
+            token.clear();
+            token_is_key = true;
+            state = State::String;
+            return true;
+
+        case State::Colon:
+            if (isWhitespace(c)) return true;
+
+            if (c != ':') {
+                return fail("expected ':' after object key");
+            }
+
+            state = State::Value;
+            return true;
+
+        case State::CommaOrEnd:
+            if (isWhitespace(c)) return true;
+
+            if (c == ',') {
+                state = containers.back() == '{' ? State::ObjectKey : State::Value;
+                return true;
+            }
+
+            if (c == '}' && containers.back() == '{') {
+                containers.pop_back();
+                return (sax->end_object() || fail("parsing aborted by handler")) && valueDone();
+            }
+
+            if (c == ']' && containers.back() == '[') {
+                containers.pop_back();
+                return (sax->end_array() || fail("parsing aborted by handler")) && valueDone();
+            }
+
+            return fail(std::string("unexpected '") + c + "'; expected ',' or end of container");
+
+        case State::String:
+            if (c == '"') {
+                if (token_is_key) {
+                    state = State::Colon;
+                    return sax->key(token) || fail("parsing aborted by handler");
+                }
+                return (sax->string(token) || fail("parsing aborted by handler")) && valueDone();
+            }
+
+            if (c == '\\') {
+                state = State::StringEscape;
+                return true;
+            }
+
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return fail("control character must be escaped");
+            }
+
+            token += c;
+            return true;
+
+        case State::StringEscape:
+            state = State::String;
+
+            switch (c) {
+                case '"': token += '"'; return true;
+                case '\\': token += '\\'; return true;
+                case '/': token += '/'; return true;
+                case 'b': token += '\b'; return true;
+                case 'f': token += '\f'; return true;
+                case 'n': token += '\n'; return true;
+                case 'r': token += '\r'; return true;
+                case 't': token += '\t'; return true;
+                case 'u':
+                    unicode_value = 0;
+                    unicode_digits = 0;
+                    state = State::StringUnicode;
+                    return true;
+                default:
+                    return fail("invalid escape sequence");
+            }
+
+        case State::StringUnicode:
+            unicode_value <<= 4;
+
+            if (c >= '0' && c <= '9') unicode_value |= static_cast<std::uint32_t>(c - '0');
+            else if (c >= 'a' && c <= 'f') unicode_value |= static_cast<std::uint32_t>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') unicode_value |= static_cast<std::uint32_t>(c - 'A' + 10);
+            else return fail("'\\u' must be followed by 4 hex digits");
+
+            if (++unicode_digits == 4) {
+                return finishUnicode();
+            }
+            return true;
+
+        case State::SurrogateBackslash:
+            if (c != '\\') {
+                return fail("surrogate U+D800..U+DBFF must be followed by U+DC00..U+DFFF");
+            }
+            state = State::SurrogateU;
+            return true;
+
+        case State::SurrogateU:
+            if (c != 'u') {
+                return fail("surrogate U+D800..U+DBFF must be followed by U+DC00..U+DFFF");
+            }
+            unicode_value = 0;
+            unicode_digits = 0;
+            state = State::StringUnicode;
+            return true;
+
+        case State::Number:
+            if (isNumberChar(c)) {
+                token += c;
+                return true;
+            }
+
+            if (!emitNumber() || !valueDone()) {
+                return false;
+            }
+            return step(c);
+
+        case State::Literal:
+            if (c != literal[literal_pos]) {
+                return fail(std::string("invalid literal; expected '") + literal + "'");
+            }
+
+            if (literal[++literal_pos] != '\0') {
+                return true;
+            }
+
+            switch (literal[0]) {
+                case 't': return (sax->boolean(true) || fail("parsing aborted by handler")) && valueDone();
+                case 'f': return (sax->boolean(false) || fail("parsing aborted by handler")) && valueDone();
+                default: return (sax->null() || fail("parsing aborted by handler")) && valueDone();
+            }
+
+        case State::Done:
+            if (isWhitespace(c)) return true;
+            return fail("unexpected trailing input");
+
+        case State::Error:
+            return false;
+    }
+
+    return false;
+}
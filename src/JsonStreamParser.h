@@ -0,0 +1,87 @@
+#ifndef JSONSTREAMPARSER_H
+#define JSONSTREAMPARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "json.hpp"
+
+// Incremental (push) JSON parser. Input may be split at any byte, e.g. as
+// chunks arrive from libcurl, and every token is reported to a json_sax
+// handler as soon as it is complete. Only the token being read and the
+// container nesting are buffered, so memory does not grow with input size.
+class JsonStreamParser {
+public:
+    using Sax = nlohmann::json_sax<nlohmann::json>;
+
+private:
+    enum class State {
+        Value,
+        ArrayValueOrEnd,
+        ObjectKeyOrEnd,
+        ObjectKey,
+        Colon,
+        CommaOrEnd,
+        String,
+        StringEscape,
+        StringUnicode,
+        SurrogateBackslash,
+        SurrogateU,
+        Number,
+        Literal,
+        Done,
+        Error
+    };
+
+    Sax* sax;
+    State state;
+    std::vector<char> containers;
+
+    std::string token;
+    bool token_is_key;
+
+    const char* literal;
+    std::size_t literal_pos;
+
+    std::uint32_t unicode_value;
+    int unicode_digits;
+    std::uint32_t high_surrogate;
+
+    std::size_t offset;
+    std::string error_message;
+
+    bool step(char c);
+    bool valueDone();
+    bool emitNumber();
+    bool finishUnicode();
+    bool fail(const std::string& message);
+
+public:
+    explicit JsonStreamParser(Sax* handler);
+
+    // Returns false once the input is known to be invalid or the handler
+    // aborted; the parser then ignores further input until reset().
+    bool feed(const char* data, std::size_t size);
+
+    // Call after the last chunk. Returns true if exactly one complete JSON
+    // value was read.
+    bool finish();
+
+    void reset();
+
+    bool failed() const {
+        return state == State::Error;
+    }
+
+    const std::string& error() const {
+        return error_message;
+    }
+
+    std::size_t bytesConsumed() const {
+        return offset;
+    }
+};
+
+#endif
@@ -0,0 +1,127 @@
+#include "MinHash.h"
+
+#include <algorithm>
+#include <array>
+
+namespace {
+
+// Stored signatures depend on these; changing them means recomputing every
+// stored signature.
+constexpr std::uint64_t kSeed = 0x6A09E667F3BCC909ULL;
+
+std::uint64_t splitmix64(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Hash function i maps a 64-bit word hash h to the high half of
+// a[i] * h + b[i] (multiply-shift), so one word hash serves all of them.
+struct Permutations {
+    std::array<std::uint64_t, MinHash::kHashes> a;
+    std::array<std::uint64_t, MinHash::kHashes> b;
+
+    Permutations() {
+        std::uint64_t state = kSeed;
+
+        for (std::size_t i = 0; i < MinHash::kHashes; i++) {
+            a[i] = splitmix64(state) | 1;
+            b[i] = splitmix64(state);
+        }
+    }
+};
+
+const Permutations& permutations() {
+    static const Permutations instance;
+    return instance;
+}
+
+bool isWordByte(unsigned char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           c == '+' || c == '#' || c >= 0x80;
+}
+
+// FNV-1a over the ASCII-lowercased word, with a splitmix finalizer so the
+// low bits are usable too.
+std::uint64_t wordHash(std::string_view word, std::uint64_t salt) {
+    std::uint64_t h = 1469598103934665603ULL ^ salt;
+
+    for (unsigned char c : word) {
+        h ^= (c >= 'A' && c <= 'Z') ? c + 32 : c;
+        h *= 1099511628211ULL;
+    }
+
+    return splitmix64(h);
+}
+
+void addHash(std::uint32_t* minimums, std::uint64_t h) {
+    const Permutations& p = permutations();
+
+    for (std::size_t i = 0; i < MinHash::kHashes; i++) {
+        std::uint32_t value = static_cast<std::uint32_t>((p.a[i] * h + p.b[i]) >> 32);
+        minimums[i] = std::min(minimums[i], value);
+    }
+}
+
+// Feeds every word of two bytes or more in `text`.
+void addWords(std::uint32_t* minimums, std::string_view text) {
+    std::size_t i = 0;
+
+    while (i < text.size()) {
+        while (i < text.size() && !isWordByte(static_cast<unsigned char>(text[i]))) {
+            i++;
+        }
+
+        std::size_t start = i;
+
+        while (i < text.size() && isWordByte(static_cast<unsigned char>(text[i]))) {
+            i++;
+        }
+
+        if (i - start >= 2) {
+            addHash(minimums, wordHash(text.substr(start, i - start), 0));
+        }
+    }
+}
+
+} // namespace
+
+std::vector<std::uint32_t> MinHash::signature(const Job& job) {
+    std::vector<std::uint32_t> minimums(kHashes, kEmpty);
+
+    addWords(minimums.data(), job.title);
+    addWords(minimums.data(), job.description);
+
+    // Salted, so "Go" the technology is a different element from the word.
+    for (const auto& technology : job.technologies) {
+        addHash(minimums.data(), wordHash(technology, 1));
+    }
+
+    return minimums;
+}
+
+double MinHash::similarity(const std::uint32_t* a, const std::uint32_t* b) {
+    std::size_t equal = 0;
+
+    for (std::size_t i = 0; i < kHashes; i++) {
+        equal += a[i] == b[i];
+    }
+
+    return static_cast<double>(equal) / kHashes;
+}
+
+std::uint64_t MinHash::bandKey(const std::uint32_t* signature, std::size_t band) {
+    std::uint64_t h = band;
+
+    for (std::size_t i = band * kRowsPerBand; i < (band + 1) * kRowsPerBand; i++) {
+        h ^= signature[i];
+        h = splitmix64(h);
+    }
+
+    return h;
+}
+
+bool MinHash::isEmpty(const std::uint32_t* signature) {
+    return std::all_of(signature, signature + kHashes, [](std::uint32_t value) { return value == kEmpty; });
+}
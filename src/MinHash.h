@@ -0,0 +1,40 @@
+#ifndef MINHASH_H
+#define MINHASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "model/Job.h"
+
+// MinHash signatures of a job's vocabulary: the lowercased words of its
+// title and description plus its technology names. The fraction of equal
+// positions in two signatures estimates the Jaccard similarity of the two
+// word sets (about +-0.06 at 64 hashes).
+//
+// Signatures are split into kBands bands of kRowsPerBand values for
+// locality-sensitive hashing: two jobs share at least one band key with
+// probability 1 - (1 - s^4)^16 for similarity s, i.e. ~5% at s = 0.3, ~63%
+// at 0.5 and ~99% at 0.7.
+class MinHash {
+public:
+    static constexpr std::size_t kHashes = 64;
+    static constexpr std::size_t kBands = 16;
+    static constexpr std::size_t kRowsPerBand = kHashes / kBands;
+
+    // Value of every position when there is no word to hash.
+    static constexpr std::uint32_t kEmpty = 0xFFFFFFFFu;
+
+    static std::vector<std::uint32_t> signature(const Job& job);
+
+    // Estimated Jaccard similarity; both must have kHashes values.
+    static double similarity(const std::uint32_t* a, const std::uint32_t* b);
+
+    // Hash of band `band` of `signature`, for bucketing.
+    static std::uint64_t bandKey(const std::uint32_t* signature, std::size_t band);
+
+    static bool isEmpty(const std::uint32_t* signature);
+};
+
+#endif
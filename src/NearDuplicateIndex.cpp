@@ -0,0 +1,105 @@
+#include "NearDuplicateIndex.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "SimHash.h"
+
+namespace {
+
+// Fixed, so the bands are the same in every process.
+constexpr std::uint64_t kBandSeed = 0xBB67AE8584CAA73BULL;
+
+} // namespace
+
+const std::array<std::array<std::uint8_t, NearDuplicateIndex::kKeyBits>, NearDuplicateIndex::kTables>&
+NearDuplicateIndex::bandBits() {
+    static const auto bits = []() {
+        std::array<std::array<std::uint8_t, kKeyBits>, kTables> result{};
+        std::uint64_t state = kBandSeed;
+
+        // Each band: the first kKeyBits of a Fisher-Yates shuffle of 0..63,
+        // driven by xorshift64.
+        for (auto& band : result) {
+            std::array<std::uint8_t, 64> positions;
+            std::iota(positions.begin(), positions.end(), 0);
+
+            for (int i = 63; i > 0; i--) {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                std::swap(positions[i], positions[state % static_cast<std::uint64_t>(i + 1)]);
+            }
+
+            std::copy(positions.begin(), positions.begin() + kKeyBits, band.begin());
+        }
+
+        return result;
+    }();
+
+    return bits;
+}
+
+std::uint32_t NearDuplicateIndex::bucketKey(std::uint64_t fingerprint, int band) {
+    std::uint32_t key = 0;
+    const auto& positions = bandBits()[static_cast<std::size_t>(band)];
+
+    for (int i = 0; i < kKeyBits; i++) {
+        key |= static_cast<std::uint32_t>((fingerprint >> positions[static_cast<std::size_t>(i)]) & 1) << i;
+    }
+
+    return key;
+}
+
+void NearDuplicateIndex::add(std::uint64_t fingerprint, const std::string& id) {
+    std::uint32_t position = static_cast<std::uint32_t>(entries.size());
+    entries.push_back(Entry{fingerprint, id});
+
+    for (int band = 0; band < kTables; band++) {
+        buckets[static_cast<std::size_t>(band)][bucketKey(fingerprint, band)].push_back(position);
+    }
+}
+
+void NearDuplicateIndex::addAll(const NearDuplicateIndex& other) {
+    for (const Entry& entry : other.entries) {
+        add(entry.fingerprint, entry.id);
+    }
+}
+
+const std::string* NearDuplicateIndex::find(std::uint64_t fingerprint, std::string_view exclude_id) const {
+    const Entry* best = nullptr;
+    int best_distance = kMaxDistance + 1;
+
+    for (int band = 0; band < kTables; band++) {
+        const auto& table = buckets[static_cast<std::size_t>(band)];
+        auto bucket = table.find(bucketKey(fingerprint, band));
+
+        if (bucket == table.end()) {
+            continue;
+        }
+
+        for (std::uint32_t position : bucket->second) {
+            const Entry& entry = entries[position];
+            int distance = SimHash::distance(fingerprint, entry.fingerprint);
+
+            // Earliest entry wins a tie, so every repost points at the same
+            // original.
+            if (distance < best_distance || (distance == best_distance && best && &entry < best)) {
+                if (entry.id != exclude_id) {
+                    best = &entry;
+                    best_distance = distance;
+                }
+            }
+        }
+    }
+
+    return best ? &best->id : nullptr;
+}
+
+void NearDuplicateIndex::clear() {
+    entries.clear();
+
+    for (auto& table : buckets) {
+        std::unordered_map<std::uint32_t, std::vector<std::uint32_t>>().swap(table);
+    }
+}
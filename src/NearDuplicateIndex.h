@@ -0,0 +1,64 @@
+#ifndef NEARDUPLICATEINDEX_H
+#define NEARDUPLICATEINDEX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Finds a stored SimHash fingerprint within kMaxDistance bits of a new one.
+//
+// Job postings are short, so small edits move a fingerprint several bits:
+// trimming a tenth of a description typically costs 5-10. Exact block
+// matching (pigeonhole over k + 1 blocks) would need blocks too small to be
+// selective at that distance, so the index samples instead: each of
+// kTables bands keys on kKeyBits fixed, randomly chosen bit positions. A
+// pair d bits apart shares a band with probability
+// 1 - (1 - C(64 - d, 16) / C(64, 16))^16: >99% at d = 4, ~94% at d = 6 and
+// ~76% at d = 8.
+// Unrelated fingerprints (~32 bits apart) collide in a band about once per
+// 65536 entries, so a lookup reads kTables small buckets and stays constant
+// time until the archive reaches millions of rows.
+class NearDuplicateIndex {
+private:
+    struct Entry {
+        std::uint64_t fingerprint;
+        std::string id;
+    };
+
+    std::vector<Entry> entries;
+
+public:
+    static constexpr int kMaxDistance = 8;
+    static constexpr int kTables = 16;
+    static constexpr int kKeyBits = 16;
+
+private:
+    // Per band, entry positions keyed by the band's sampled bits. Only keys
+    // in use take memory, so a small index stays small.
+    std::array<std::unordered_map<std::uint32_t, std::vector<std::uint32_t>>, kTables> buckets;
+
+    static const std::array<std::array<std::uint8_t, kKeyBits>, kTables>& bandBits();
+    static std::uint32_t bucketKey(std::uint64_t fingerprint, int band);
+
+public:
+    void add(std::uint64_t fingerprint, const std::string& id);
+
+    // Adds every entry of `other`, in the order it was added there.
+    void addAll(const NearDuplicateIndex& other);
+
+    // Id of the closest entry within kMaxDistance, other than `exclude_id`;
+    // null if there is none. Valid until the next add or clear.
+    const std::string* find(std::uint64_t fingerprint, std::string_view exclude_id) const;
+
+    void clear();
+
+    std::size_t size() const {
+        return entries.size();
+    }
+};
+
+#endif
@@ -0,0 +1,63 @@
+#include "RateLimiter.h"
+
+#include <algorithm>
+#include <thread>
+
+RateLimiter::RateLimiter(double requests_per_second, double burst)
+    : rate(requests_per_second > 0 ? requests_per_second : 1.0),
+      capacity(std::max(1.0, burst)),
+      tokens(capacity),
+      last_refill(Clock::now()) {}
+
+void RateLimiter::refill(Clock::time_point now) {
+    if (now <= last_refill) {
+        return;
+    }
+
+    double elapsed = std::chrono::duration<double>(now - last_refill).count();
+    tokens = std::min(capacity, tokens + elapsed * rate);
+    last_refill = now;
+}
+
+void RateLimiter::acquire() {
+    while (!tryAcquire()) {
+        std::this_thread::sleep_for(timeUntilAvailable());
+    }
+}
+
+bool RateLimiter::tryAcquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+    refill(Clock::now());
+
+    if (tokens < 1.0) {
+        return false;
+    }
+
+    tokens -= 1.0;
+    return true;
+}
+
+RateLimiter::Clock::duration RateLimiter::timeUntilAvailable() {
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point now = Clock::now();
+    refill(now);
+
+    if (tokens >= 1.0) {
+        return Clock::duration::zero();
+    }
+
+    Clock::duration paused = last_refill > now ? last_refill - now : Clock::duration::zero();
+    auto refilling = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>((1.0 - tokens) / rate));
+
+    return paused + refilling;
+}
+
+void RateLimiter::pause(Clock::duration delay) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point now = Clock::now();
+    refill(now);
+
+    tokens = std::min(tokens, 0.0);
+    last_refill = std::max(last_refill, now + delay);
+}
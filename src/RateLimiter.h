@@ -0,0 +1,41 @@
+#ifndef RATELIMITER_H
+#define RATELIMITER_H
+
+#include <chrono>
+#include <mutex>
+
+// Token bucket: `requests_per_second` tokens accrue continuously up to
+// `burst`, and each request spends one. Thread-safe.
+class RateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    double rate;
+    double capacity;
+    double tokens;
+    Clock::time_point last_refill;
+    std::mutex mutex;
+
+    // Credits the time since last_refill; last_refill may lie in the future
+    // while paused.
+    void refill(Clock::time_point now);
+
+public:
+    explicit RateLimiter(double requests_per_second, double burst = 1.0);
+
+    // Blocks until a request may be sent.
+    void acquire();
+
+    // Takes a token if one is available right now.
+    bool tryAcquire();
+
+    // How long until tryAcquire can succeed.
+    Clock::duration timeUntilAvailable();
+
+    // Stops handing out tokens for `delay`, e.g. when the server answered
+    // 429, so every caller sharing the limiter backs off together.
+    void pause(Clock::duration delay);
+};
+
+#endif
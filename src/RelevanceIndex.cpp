@@ -0,0 +1,339 @@
+#include "RelevanceIndex.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "JobParser.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RELEVANCEINDEX_X86 1
+#endif
+
+namespace {
+
+// Rows scored per block before the heap sees them.
+constexpr std::size_t kScoreBlock = 1024;
+
+void setBit(std::vector<std::uint64_t>& bits, std::size_t offset, int id) {
+    bits[offset + static_cast<std::size_t>(id) / 64] |= std::uint64_t(1) << (id % 64);
+}
+
+int bitCount(const std::vector<std::uint64_t>& bits) {
+    int count = 0;
+
+    for (std::uint64_t word : bits) {
+        count += __builtin_popcountll(word);
+    }
+
+    return count;
+}
+
+struct Ranked {
+    float score;
+    std::size_t row;
+};
+
+// Higher score first; equal scores keep row order.
+bool better(const Ranked& a, const Ranked& b) {
+    return a.score > b.score || (a.score == b.score && a.row < b.row);
+}
+
+// Flat columns and per-query constants for one scoring pass.
+struct ScoreInputs {
+    const std::uint64_t* technology_bits;
+    std::size_t words;
+    const std::uint32_t* location_keys;
+    const std::uint8_t* remote;
+    const float* salary_top;
+    const std::uint64_t* skill_bits;
+    const std::uint64_t* preferred_bits;
+    const float* location_table;
+    float technology_scale;
+    float location_scale;
+    float salary_scale;
+    bool remote_matches;
+    float inverse_salary;
+};
+
+// Branch-free per row so the salary and location terms vectorize; inlined
+// into each kernel below so the popcounts compile to the instruction the
+// kernel targets.
+__attribute__((always_inline))
+inline void scoreRows(const ScoreInputs& in, std::size_t begin, std::size_t end, float* out) {
+    for (std::size_t row = begin; row < end; row++) {
+        const std::uint64_t* bits = in.technology_bits + row * in.words;
+        int matched = 0;
+
+        for (std::size_t w = 0; w < in.words; w++) {
+            matched += __builtin_popcountll(bits[w] & in.skill_bits[w]) +
+                       2 * __builtin_popcountll(bits[w] & in.preferred_bits[w]);
+        }
+
+        float top = in.salary_top[row];
+        float salary = top > 0.0f ? std::min(1.0f, top * in.inverse_salary) : 0.5f;
+        float location = in.location_table[in.location_keys[row]];
+
+        if (in.remote_matches && in.remote[row]) {
+            location = 1.0f;
+        }
+
+        out[row - begin] = in.technology_scale * static_cast<float>(matched) +
+                           in.location_scale * location +
+                           in.salary_scale * salary;
+    }
+}
+
+void scoreRowsGeneric(const ScoreInputs& in, std::size_t begin, std::size_t end, float* out) {
+    scoreRows(in, begin, end, out);
+}
+
+#ifdef RELEVANCEINDEX_X86
+
+// Without -mpopcnt the builtin is a libgcc call per word.
+__attribute__((target("popcnt")))
+void scoreRowsPopcnt(const ScoreInputs& in, std::size_t begin, std::size_t end, float* out) {
+    scoreRows(in, begin, end, out);
+}
+
+#endif
+
+using ScoreKernel = void (*)(const ScoreInputs&, std::size_t, std::size_t, float*);
+
+ScoreKernel selectKernel() {
+#ifdef RELEVANCEINDEX_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("popcnt")) {
+        return scoreRowsPopcnt;
+    }
+#endif
+
+    return scoreRowsGeneric;
+}
+
+ScoreKernel scoreKernel() {
+    static const ScoreKernel selected = selectKernel();
+    return selected;
+}
+
+} // namespace
+
+RelevanceIndex::RelevanceIndex(const std::vector<Job>& jobs)
+    : matcher(JobParser::technologyMatcher()),
+      words((matcher->size() + 63) / 64) {
+    technology_bits.assign(jobs.size() * words, 0);
+    location_keys.reserve(jobs.size());
+    remote.reserve(jobs.size());
+    salary_top.reserve(jobs.size());
+
+    for (std::size_t row = 0; row < jobs.size(); row++) {
+        const Job& job = jobs[row];
+
+        // Enriched jobs already name their technologies; the rest are
+        // matched the way extractTechnologies does.
+        std::vector<int> ids = job.technologies.empty()
+            ? matcher->findIds(job.description, false)
+            : technologyIds(job.technologies);
+
+        for (int id : ids) {
+            setBit(technology_bits, row * words, id);
+        }
+
+        location_keys.push_back(location_names.intern(locationKey(job.location.display_name)));
+        remote.push_back(JobParser::isRemoteJob(job) ? 1 : 0);
+        salary_top.push_back(static_cast<float>(std::max(job.salary_min, job.salary_max)));
+    }
+}
+
+std::vector<int> RelevanceIndex::technologyIds(const std::vector<std::string>& names) const {
+    std::vector<int> ids;
+
+    for (const auto& name : names) {
+        int id = matcher->id(name);
+
+        if (id >= 0) {
+            ids.push_back(id);
+            continue;
+        }
+
+        // Not a dictionary name as written ("c++", "k8s"): match it as text.
+        for (int id : matcher->findIds(name, true)) {
+            ids.push_back(id);
+        }
+    }
+
+    return ids;
+}
+
+std::string RelevanceIndex::locationKey(std::string_view location) {
+    std::string key;
+    bool pending_space = false;
+
+    for (char c : location.substr(0, location.find(','))) {
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            pending_space = !key.empty();
+            continue;
+        }
+
+        if (pending_space) {
+            key += ' ';
+            pending_space = false;
+        }
+
+        key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    return key;
+}
+
+float RelevanceIndex::locationScore(std::string_view job_key, std::string_view preferred_key) {
+    if (job_key.empty() || preferred_key.empty()) {
+        return 0.0f;
+    }
+
+    if (job_key == preferred_key) {
+        return 1.0f;
+    }
+
+    if (job_key.find(preferred_key) != std::string_view::npos ||
+        preferred_key.find(job_key) != std::string_view::npos) {
+        return 0.5f;
+    }
+
+    return 0.0f;
+}
+
+float RelevanceIndex::salaryScore(double salary_min, double salary_max, double desired_salary) {
+    double top = std::max(salary_min, salary_max);
+
+    if (desired_salary <= 0) {
+        return 0.0f;
+    }
+
+    if (top <= 0) {
+        return 0.5f;
+    }
+
+    return static_cast<float>(std::min(1.0, top / desired_salary));
+}
+
+RelevanceIndex::Query RelevanceIndex::prepare(const RelevanceProfile& profile) const {
+    Query query;
+    query.skill_bits.assign(words, 0);
+    query.preferred_bits.assign(words, 0);
+
+    for (int id : technologyIds(profile.preferred_technologies)) {
+        setBit(query.preferred_bits, 0, id);
+    }
+
+    for (int id : matcher->findIds(profile.skills, true)) {
+        setBit(query.skill_bits, 0, id);
+    }
+
+    for (std::size_t w = 0; w < words; w++) {
+        query.skill_bits[w] &= ~query.preferred_bits[w];
+    }
+
+    int technology_total = bitCount(query.skill_bits) + 2 * bitCount(query.preferred_bits);
+    std::string preferred_location = locationKey(profile.location);
+
+    // Weighted mean over the criteria the profile sets.
+    float technology_weight = technology_total > 0 ? kTechnologyWeight : 0.0f;
+    float location_weight = preferred_location.empty() ? 0.0f : kLocationWeight;
+    float salary_weight = profile.desired_salary > 0 ? kSalaryWeight : 0.0f;
+    float total = technology_weight + location_weight + salary_weight;
+
+    // Scored even when nothing is weighted, so it must always cover every
+    // location key.
+    query.location_table.assign(location_names.size(), 0.0f);
+
+    if (total == 0.0f) {
+        return query;
+    }
+
+    if (technology_total > 0) {
+        query.technology_scale = technology_weight / total / static_cast<float>(technology_total);
+    }
+
+    query.location_scale = location_weight / total;
+    query.salary_scale = salary_weight / total;
+
+    if (!preferred_location.empty()) {
+        // One comparison per distinct location rather than per job.
+        for (std::uint32_t key = 0; key < location_names.size(); key++) {
+            query.location_table[key] = locationScore(location_names.str(key), preferred_location);
+        }
+
+        query.remote_matches = preferred_location == "remote";
+    }
+
+    if (profile.desired_salary > 0) {
+        query.inverse_salary = static_cast<float>(1.0 / profile.desired_salary);
+    }
+
+    return query;
+}
+
+void RelevanceIndex::scoreRange(const Query& query, std::size_t begin, std::size_t end, float* out) const {
+    ScoreInputs inputs{technology_bits.data(), words, location_keys.data(), remote.data(),
+                       salary_top.data(), query.skill_bits.data(), query.preferred_bits.data(),
+                       query.location_table.data(), query.technology_scale, query.location_scale,
+                       query.salary_scale, query.remote_matches, query.inverse_salary};
+
+    scoreKernel()(inputs, begin, end, out);
+}
+
+std::vector<float> RelevanceIndex::scores(const RelevanceProfile& profile) const {
+    Query query = prepare(profile);
+    std::vector<float> result(size());
+
+    if (!result.empty()) {
+        scoreRange(query, 0, size(), result.data());
+    }
+
+    return result;
+}
+
+std::vector<std::size_t> RelevanceIndex::topK(const RelevanceProfile& profile, std::size_t k) const {
+    std::vector<std::size_t> rows;
+    k = std::min(k, size());
+
+    if (k == 0) {
+        return rows;
+    }
+
+    Query query = prepare(profile);
+
+    // Min-heap of the best k so far: the root is the one to beat.
+    std::vector<Ranked> heap;
+    heap.reserve(k);
+
+    float block[kScoreBlock];
+
+    for (std::size_t begin = 0; begin < size(); begin += kScoreBlock) {
+        std::size_t end = std::min(size(), begin + kScoreBlock);
+        scoreRange(query, begin, end, block);
+
+        for (std::size_t row = begin; row < end; row++) {
+            Ranked candidate{block[row - begin], row};
+
+            if (heap.size() < k) {
+                heap.push_back(candidate);
+                std::push_heap(heap.begin(), heap.end(), better);
+            } else if (better(candidate, heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), better);
+                heap.back() = candidate;
+                std::push_heap(heap.begin(), heap.end(), better);
+            }
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), better);
+    rows.reserve(heap.size());
+
+    for (const auto& entry : heap) {
+        rows.push_back(entry.row);
+    }
+
+    return rows;
+}
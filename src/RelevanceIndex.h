@@ -0,0 +1,91 @@
+#ifndef RELEVANCEINDEX_H
+#define RELEVANCEINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "JobStore.h"
+#include "TechnologyMatcher.h"
+#include "model/Job.h"
+
+// What a user is looking for. Empty / zero fields do not count towards the
+// score.
+struct RelevanceProfile {
+    std::string skills;                              // free text; technologies found in it count once
+    std::vector<std::string> preferred_technologies; // count double
+    std::string location;                            // "remote" matches remote jobs
+    double desired_salary = 0.0;
+};
+
+// Precomputed ranking columns for a fixed set of jobs: a technology bitset,
+// a normalized location key, a remote flag and the top of the salary range
+// per row. Scoring a profile is then a linear pass of popcounts and table
+// lookups over flat arrays, done in blocks, with a bounded min-heap keeping
+// the best k.
+//
+// Score, in [0, 1], is a weighted mean over the criteria the profile sets:
+//   technologies 0.6   matched weight / profile weight (preferred count 2)
+//   location     0.25  1 for the same key, 0.5 if one key contains the other
+//   salary       0.15  1 at or above the desired salary, else proportional;
+//                      0.5 when the job lists no salary
+// JobParser's calculate*MatchScore functions compute the same components
+// for a single job.
+class RelevanceIndex {
+private:
+    std::shared_ptr<const TechnologyMatcher> matcher;
+    std::size_t words;
+
+    std::vector<std::uint64_t> technology_bits;   // `words` per row
+    StringInterner location_names;                // normalized keys
+    std::vector<std::uint32_t> location_keys;
+    std::vector<std::uint8_t> remote;
+    std::vector<float> salary_top;
+
+    // A profile turned into per-query constants and lookup tables.
+    struct Query {
+        std::vector<std::uint64_t> skill_bits;      // skills not also preferred
+        std::vector<std::uint64_t> preferred_bits;
+        float technology_scale = 0.0f;
+        float location_scale = 0.0f;
+        float salary_scale = 0.0f;
+        std::vector<float> location_table;          // by location key
+        bool remote_matches = false;
+        float inverse_salary = 0.0f;
+    };
+
+    Query prepare(const RelevanceProfile& profile) const;
+    void scoreRange(const Query& query, std::size_t begin, std::size_t end, float* out) const;
+
+    // Technology ids of `names` (dictionary names or spellings of them).
+    std::vector<int> technologyIds(const std::vector<std::string>& names) const;
+
+public:
+    static constexpr float kTechnologyWeight = 0.6f;
+    static constexpr float kLocationWeight = 0.25f;
+    static constexpr float kSalaryWeight = 0.15f;
+
+    explicit RelevanceIndex(const std::vector<Job>& jobs);
+
+    std::size_t size() const {
+        return location_keys.size();
+    }
+
+    // Scores of every row for `profile`.
+    std::vector<float> scores(const RelevanceProfile& profile) const;
+
+    // Rows of the k best jobs, best first; equal scores keep row order.
+    std::vector<std::size_t> topK(const RelevanceProfile& profile, std::size_t k) const;
+
+    // "London, UK" -> "london": the first comma-separated part, lowercased,
+    // with whitespace runs collapsed.
+    static std::string locationKey(std::string_view location);
+
+    static float locationScore(std::string_view job_key, std::string_view preferred_key);
+    static float salaryScore(double salary_min, double salary_max, double desired_salary);
+};
+
+#endif
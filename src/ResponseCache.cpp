@@ -0,0 +1,406 @@
+#include "ResponseCache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <vector>
+
+#include <zlib.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// File layout, integers in the writing machine's native byte order (a
+// cache directory is not meant to be shared between machines):
+//   "JMRC" | u32 version | i64 stored_at | u64 body size
+//   | u32 + key | u32 + etag | u32 + last_modified | u64 + deflated body
+const char kMagic[4] = {'J', 'M', 'R', 'C'};
+const std::uint32_t kVersion = 1;
+const std::streamoff kStoredAtOffset = 8;
+
+// deflate never shrinks data by more than this, so a larger stated body
+// size means a damaged entry.
+const std::uint64_t kMaxDeflateRatio = 1032;
+
+std::int64_t nowSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+template<typename T>
+void writeValue(std::ostream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+bool readValue(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+void writeString(std::ostream& out, const std::string& value) {
+    writeValue(out, static_cast<std::uint32_t>(value.size()));
+    out.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+// Bytes left in a file of `file_size` after the read position.
+std::uint64_t remaining(std::istream& in, std::uint64_t file_size) {
+    std::streamoff position = in.tellg();
+    return position < 0 || static_cast<std::uint64_t>(position) > file_size
+               ? 0
+               : file_size - static_cast<std::uint64_t>(position);
+}
+
+// Lengths come from the file, so one longer than what is left of it means
+// the file is damaged; reject it rather than allocate for it.
+bool readString(std::istream& in, std::uint64_t file_size, std::string& value) {
+    std::uint32_t size = 0;
+
+    if (!readValue(in, size) || size > remaining(in, file_size)) {
+        return false;
+    }
+
+    value.resize(size);
+    return static_cast<bool>(in.read(value.data(), size));
+}
+
+// FNV-1a; the full key is stored in the file and compared on lookup, so a
+// collision only costs a miss.
+std::string fileNameFor(const std::string& key) {
+    std::uint64_t hash = 1469598103934665603ULL;
+
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+
+    static const char hex[] = "0123456789abcdef";
+    std::string name(16, '0');
+
+    for (int i = 15; i >= 0; i--) {
+        name[static_cast<std::size_t>(i)] = hex[hash & 0x0F];
+        hash >>= 4;
+    }
+
+    return name + ".cache";
+}
+
+// Reads up to and including the stored key, and checks it is `key`.
+bool readHeader(std::istream& in,
+                std::uint64_t file_size,
+                const std::string& key,
+                std::int64_t& stored_at,
+                std::uint64_t& body_size) {
+    char magic[4];
+    std::uint32_t version = 0;
+    std::string stored_key;
+
+    return in.read(magic, sizeof(magic)) && std::equal(magic, magic + 4, kMagic) &&
+           readValue(in, version) && version == kVersion &&
+           readValue(in, stored_at) && readValue(in, body_size) &&
+           readString(in, file_size, stored_key) && stored_key == key;
+}
+
+bool readEntry(const fs::path& path,
+               const std::string& key,
+               std::int64_t& stored_at,
+               CachedResponse& response) {
+    std::error_code ec;
+    std::uint64_t file_size = fs::file_size(path, ec);
+
+    if (ec) {
+        return false;
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    std::uint64_t body_size = 0;
+    std::uint64_t deflated_size = 0;
+
+    if (!in || !readHeader(in, file_size, key, stored_at, body_size) ||
+        !readString(in, file_size, response.etag) ||
+        !readString(in, file_size, response.last_modified) ||
+        !readValue(in, deflated_size) || deflated_size != remaining(in, file_size) ||
+        body_size > deflated_size * kMaxDeflateRatio) {
+        return false;
+    }
+
+    std::string deflated(deflated_size, '\0');
+
+    if (!in.read(deflated.data(), static_cast<std::streamsize>(deflated_size))) {
+        return false;
+    }
+
+    response.body.resize(body_size);
+    uLongf length = static_cast<uLongf>(body_size);
+
+    if (uncompress(reinterpret_cast<Bytef*>(response.body.data()), &length,
+                   reinterpret_cast<const Bytef*>(deflated.data()),
+                   static_cast<uLong>(deflated.size())) != Z_OK ||
+        length != body_size) {
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+ResponseCache::ResponseCache(const std::string& dir,
+                             std::chrono::seconds time_to_live,
+                             std::uintmax_t size_limit)
+    : directory(dir), ttl(time_to_live), max_bytes(size_limit), total_bytes(0), index_loaded(false) {
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+
+    if (ec) {
+        std::cerr << "Cannot create response cache directory: " << ec.message() << '\n';
+    }
+}
+
+std::string ResponseCache::normalizeKey(const std::string& url) {
+    std::size_t query_start = url.find('?');
+    std::string base = url.substr(0, query_start);
+
+    // Scheme and host are case-insensitive; the path is not.
+    std::size_t host_start = base.find("://");
+    std::size_t path_start = host_start == std::string::npos
+                                 ? std::string::npos
+                                 : base.find('/', host_start + 3);
+
+    std::transform(base.begin(),
+                   path_start == std::string::npos ? base.end() : base.begin() + static_cast<std::ptrdiff_t>(path_start),
+                   base.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (query_start == std::string::npos) {
+        return base;
+    }
+
+    std::vector<std::string> parameters;
+    std::size_t pos = query_start + 1;
+
+    while (pos <= url.size()) {
+        std::size_t end = url.find('&', pos);
+
+        if (end == std::string::npos) {
+            end = url.size();
+        }
+
+        std::string parameter = url.substr(pos, end - pos);
+
+        if (!parameter.empty() && parameter.compare(0, 8, "app_key=") != 0 && parameter != "app_key") {
+            parameters.push_back(parameter);
+        }
+
+        pos = end + 1;
+    }
+
+    std::sort(parameters.begin(), parameters.end());
+
+    std::string key = base;
+
+    for (std::size_t i = 0; i < parameters.size(); i++) {
+        key += i == 0 ? '?' : '&';
+        key += parameters[i];
+    }
+
+    return key;
+}
+
+fs::path ResponseCache::pathFor(const std::string& key) const {
+    return directory / fileNameFor(key);
+}
+
+bool ResponseCache::lookup(const std::string& key, CachedResponse& response) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    fs::path path = pathFor(key);
+    std::int64_t stored_at = 0;
+
+    if (!readEntry(path, key, stored_at, response)) {
+        return false;
+    }
+
+    response.fresh = nowSeconds() - stored_at < ttl.count();
+
+    // Recently used; keeps the entry away from eviction, in this process
+    // through the index and in later ones through the file's mtime.
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+
+    std::string name = path.filename().string();
+    auto entry = index.find(name);
+    recordUse(name, entry != index.end() ? entry->second.size : fs::file_size(path, ec));
+
+    return true;
+}
+
+bool ResponseCache::write(const fs::path& path,
+                          const std::string& key,
+                          std::int64_t stored_at,
+                          const CachedResponse& response) {
+    uLongf deflated_size = compressBound(static_cast<uLong>(response.body.size()));
+    std::string deflated(deflated_size, '\0');
+
+    if (compress2(reinterpret_cast<Bytef*>(deflated.data()), &deflated_size,
+                  reinterpret_cast<const Bytef*>(response.body.data()),
+                  static_cast<uLong>(response.body.size()), Z_DEFAULT_COMPRESSION) != Z_OK) {
+        return false;
+    }
+
+    deflated.resize(deflated_size);
+
+    // Write beside the target and rename, so readers never see half a file.
+    fs::path temporary = path;
+    temporary += ".tmp";
+
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+
+        if (!out) {
+            return false;
+        }
+
+        out.write(kMagic, sizeof(kMagic));
+        writeValue(out, kVersion);
+        writeValue(out, stored_at);
+        writeValue(out, static_cast<std::uint64_t>(response.body.size()));
+        writeString(out, key);
+        writeString(out, response.etag);
+        writeString(out, response.last_modified);
+        writeValue(out, static_cast<std::uint64_t>(deflated.size()));
+        out.write(deflated.data(), static_cast<std::streamsize>(deflated.size()));
+
+        if (!out) {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(temporary, path, ec);
+
+    if (ec) {
+        fs::remove(temporary, ec);
+        return false;
+    }
+
+    return true;
+}
+
+bool ResponseCache::store(const std::string& key, const CachedResponse& response) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    fs::path path = pathFor(key);
+
+    if (!write(path, key, nowSeconds(), response)) {
+        std::cerr << "Cannot write response cache entry for " << key << '\n';
+        return false;
+    }
+
+    std::error_code ec;
+    std::uintmax_t size = fs::file_size(path, ec);
+
+    if (!ec) {
+        recordUse(path.filename().string(), size);
+    }
+
+    evict();
+    return true;
+}
+
+bool ResponseCache::refresh(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    fs::path path = pathFor(key);
+    std::error_code ec;
+    std::uint64_t file_size = fs::file_size(path, ec);
+
+    if (ec) {
+        return false;
+    }
+
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    std::int64_t stored_at = 0;
+    std::uint64_t body_size = 0;
+
+    // Another key can share the file name; leave its entry alone.
+    if (!file || !readHeader(file, file_size, key, stored_at, body_size)) {
+        return false;
+    }
+
+    // stored_at sits at a fixed offset; patch it in place.
+    file.seekp(kStoredAtOffset);
+    writeValue(file, nowSeconds());
+
+    return static_cast<bool>(file);
+}
+
+void ResponseCache::loadIndex() {
+    struct Entry {
+        std::string name;
+        fs::file_time_type used;
+        std::uintmax_t size;
+    };
+
+    std::vector<Entry> entries;
+    std::error_code ec;
+
+    for (const auto& file : fs::directory_iterator(directory, ec)) {
+        if (file.path().extension() != ".cache") {
+            continue;
+        }
+
+        std::uintmax_t size = file.file_size(ec);
+        fs::file_time_type used = file.last_write_time(ec);
+
+        if (!ec) {
+            entries.push_back({file.path().filename().string(), used, size});
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.used < b.used; });
+
+    for (const auto& entry : entries) {
+        lru.push_back(entry.name);
+        index[entry.name] = IndexEntry{std::prev(lru.end()), entry.size};
+        total_bytes += entry.size;
+    }
+
+    index_loaded = true;
+}
+
+void ResponseCache::recordUse(const std::string& name, std::uintmax_t size) {
+    if (!index_loaded) {
+        loadIndex();
+    }
+
+    auto it = index.find(name);
+
+    if (it == index.end()) {
+        lru.push_back(name);
+        index[name] = IndexEntry{std::prev(lru.end()), size};
+        total_bytes += size;
+        return;
+    }
+
+    lru.splice(lru.end(), lru, it->second.position);
+    total_bytes = total_bytes - it->second.size + size;
+    it->second.size = size;
+}
+
+void ResponseCache::evict() {
+    std::error_code ec;
+
+    while (total_bytes > max_bytes && !lru.empty()) {
+        std::string name = lru.front();
+        auto it = index.find(name);
+
+        fs::remove(directory / name, ec);
+        total_bytes -= it->second.size;
+        index.erase(it);
+        lru.pop_front();
+    }
+}
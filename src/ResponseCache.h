@@ -0,0 +1,74 @@
+#ifndef RESPONSECACHE_H
+#define RESPONSECACHE_H
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+struct CachedResponse {
+    std::string body;
+    std::string etag;
+    std::string last_modified;
+
+    // Younger than the TTL: usable without asking the server. A stale entry
+    // can still be revalidated with its ETag / Last-Modified.
+    bool fresh = false;
+};
+
+// On-disk cache of HTTP response bodies, one zlib-compressed file per URL.
+// Entries expire after `ttl`; the directory is kept under `max_bytes` by
+// evicting the least recently used files (a hit refreshes the file's mtime).
+// Safe to share between threads of one process.
+class ResponseCache {
+private:
+    std::filesystem::path directory;
+    std::chrono::seconds ttl;
+    std::uintmax_t max_bytes;
+    std::mutex mutex;
+
+    // Entry files, least recently used first, with their sizes and total:
+    // read from the directory once, then kept up to date by this object,
+    // so a store never rescans the directory. Files another process adds
+    // are picked up by the next ResponseCache opened on the directory.
+    struct IndexEntry {
+        std::list<std::string>::iterator position;
+        std::uintmax_t size;
+    };
+
+    std::list<std::string> lru;
+    std::unordered_map<std::string, IndexEntry> index;
+    std::uintmax_t total_bytes;
+    bool index_loaded;
+
+    std::filesystem::path pathFor(const std::string& key) const;
+    bool write(const std::filesystem::path& path,
+               const std::string& key,
+               std::int64_t stored_at,
+               const CachedResponse& response);
+
+    void loadIndex();
+    // Marks `name` most recently used, at `size` bytes.
+    void recordUse(const std::string& name, std::uintmax_t size);
+    void evict();
+
+public:
+    ResponseCache(const std::string& directory,
+                  std::chrono::seconds ttl,
+                  std::uintmax_t max_bytes);
+
+    // Cache key for a request URL: the query parameters are sorted and
+    // app_key is dropped, so rotating the key does not invalidate entries.
+    static std::string normalizeKey(const std::string& url);
+
+    bool lookup(const std::string& key, CachedResponse& response);
+    bool store(const std::string& key, const CachedResponse& response);
+
+    // Marks an entry fresh again after the server answered 304.
+    bool refresh(const std::string& key);
+};
+
+#endif
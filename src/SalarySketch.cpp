@@ -0,0 +1,394 @@
+#include "SalarySketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "RelevanceIndex.h"
+
+namespace {
+
+constexpr unsigned char kFormatVersion = 1;
+
+void writeU64(std::string& out, std::uint64_t value) {
+    for (int byte = 0; byte < 8; byte++) {
+        out += static_cast<char>((value >> (8 * byte)) & 0xFF);
+    }
+}
+
+void writeDouble(std::string& out, double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeU64(out, bits);
+}
+
+// Reads from [data, end), advancing data; false once it runs out.
+bool readU64(const unsigned char*& data, const unsigned char* end, std::uint64_t& value) {
+    if (end - data < 8) {
+        return false;
+    }
+
+    value = 0;
+
+    for (int byte = 0; byte < 8; byte++) {
+        value |= static_cast<std::uint64_t>(data[byte]) << (8 * byte);
+    }
+
+    data += 8;
+    return true;
+}
+
+bool readDouble(const unsigned char*& data, const unsigned char* end, double& value) {
+    std::uint64_t bits;
+
+    if (!readU64(data, end, bits)) {
+        return false;
+    }
+
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+} // namespace
+
+SalarySketch::SalarySketch()
+    : item_count(0),
+      running_mean(0.0),
+      sum_squares(0.0),
+      minimum(0.0),
+      maximum(0.0),
+      levels(1),
+      coin(0x3C6EF372FE94F82BULL),
+      fences_valid(false),
+      lower_fence(0.0),
+      upper_fence(0.0) {}
+
+std::size_t SalarySketch::capacity(std::size_t level) const {
+    // Lower levels get geometrically less room (factor 2/3 per level), so
+    // the total stays within about 3 * kK items.
+    double depth = static_cast<double>(levels.size() - 1 - level);
+    return std::max<std::size_t>(2, static_cast<std::size_t>(std::ceil(kK * std::pow(2.0 / 3.0, depth))));
+}
+
+bool SalarySketch::flip() {
+    coin ^= coin << 13;
+    coin ^= coin >> 7;
+    coin ^= coin << 17;
+    return coin & 1;
+}
+
+void SalarySketch::compress() {
+    for (std::size_t h = 0; h < levels.size(); h++) {
+        if (levels[h].size() < capacity(h)) {
+            continue;
+        }
+
+        if (h + 1 == levels.size()) {
+            levels.emplace_back();
+        }
+
+        std::vector<double>& level = levels[h];
+        std::vector<double>& above = levels[h + 1];
+        std::sort(level.begin(), level.end());
+
+        // Every other item moves up at twice the weight, starting at a
+        // random parity so the error is unbiased. With an odd count the
+        // largest item stays behind.
+        bool odd = level.size() % 2 != 0;
+        std::size_t paired = level.size() - (odd ? 1 : 0);
+
+        for (std::size_t i = flip() ? 1 : 0; i < paired; i += 2) {
+            above.push_back(level[i]);
+        }
+
+        if (odd) {
+            level.front() = level.back();
+            level.resize(1);
+        } else {
+            level.clear();
+        }
+    }
+}
+
+void SalarySketch::add(double salary) {
+    item_count++;
+
+    if (item_count == 1) {
+        minimum = salary;
+        maximum = salary;
+    } else {
+        minimum = std::min(minimum, salary);
+        maximum = std::max(maximum, salary);
+    }
+
+    double delta = salary - running_mean;
+    running_mean += delta / static_cast<double>(item_count);
+    sum_squares += delta * (salary - running_mean);
+
+    levels[0].push_back(salary);
+
+    if (levels[0].size() >= capacity(0)) {
+        compress();
+    }
+
+    fences_valid = false;
+}
+
+void SalarySketch::merge(const SalarySketch& other) {
+    if (other.empty()) {
+        return;
+    }
+
+    if (empty()) {
+        minimum = other.minimum;
+        maximum = other.maximum;
+    } else {
+        minimum = std::min(minimum, other.minimum);
+        maximum = std::max(maximum, other.maximum);
+    }
+
+    // Chan et al.'s pairwise update of the mean and M2.
+    double n_a = static_cast<double>(item_count);
+    double n_b = static_cast<double>(other.item_count);
+    double n = n_a + n_b;
+    double delta = other.running_mean - running_mean;
+
+    running_mean += delta * n_b / n;
+    sum_squares += other.sum_squares + delta * delta * n_a * n_b / n;
+    item_count += other.item_count;
+
+    if (levels.size() < other.levels.size()) {
+        levels.resize(other.levels.size());
+    }
+
+    for (std::size_t h = 0; h < other.levels.size(); h++) {
+        levels[h].insert(levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+    }
+
+    compress();
+    fences_valid = false;
+}
+
+double SalarySketch::variance() const {
+    return item_count > 1 ? sum_squares / static_cast<double>(item_count - 1) : 0.0;
+}
+
+double SalarySketch::stddev() const {
+    return std::sqrt(variance());
+}
+
+double SalarySketch::quantile(double q) const {
+    if (empty()) {
+        return 0.0;
+    }
+
+    if (q <= 0.0) {
+        return minimum;
+    }
+
+    if (q >= 1.0) {
+        return maximum;
+    }
+
+    std::vector<std::pair<double, std::uint64_t>> weighted;
+
+    for (std::size_t h = 0; h < levels.size(); h++) {
+        for (double value : levels[h]) {
+            weighted.emplace_back(value, std::uint64_t(1) << h);
+        }
+    }
+
+    std::sort(weighted.begin(), weighted.end());
+
+    std::uint64_t total = 0;
+
+    for (const auto& item : weighted) {
+        total += item.second;
+    }
+
+    double target = q * static_cast<double>(total);
+    std::uint64_t cumulative = 0;
+
+    for (const auto& item : weighted) {
+        cumulative += item.second;
+
+        if (static_cast<double>(cumulative) >= target) {
+            return item.first;
+        }
+    }
+
+    return weighted.back().first;
+}
+
+bool SalarySketch::isOutlier(double salary) const {
+    if (salary <= 0 || item_count < kMinOutlierSample) {
+        return false;
+    }
+
+    if (!fences_valid) {
+        double q1 = quantile(0.25);
+        double q3 = quantile(0.75);
+        lower_fence = q1 - kFenceWidth * (q3 - q1);
+        upper_fence = q3 + kFenceWidth * (q3 - q1);
+        fences_valid = true;
+    }
+
+    return salary < lower_fence || salary > upper_fence;
+}
+
+void SalarySketch::serialize(std::string& out) const {
+    out.clear();
+    out += static_cast<char>(kFormatVersion);
+
+    writeU64(out, item_count);
+    writeDouble(out, running_mean);
+    writeDouble(out, sum_squares);
+    writeDouble(out, minimum);
+    writeDouble(out, maximum);
+    writeU64(out, coin);
+    writeU64(out, levels.size());
+
+    for (const auto& level : levels) {
+        writeU64(out, level.size());
+
+        for (double value : level) {
+            writeDouble(out, value);
+        }
+    }
+}
+
+bool SalarySketch::deserialize(const char* data, std::size_t size) {
+    *this = SalarySketch();
+
+    const unsigned char* cursor = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = cursor + size;
+
+    if (size == 0 || *cursor++ != kFormatVersion) {
+        return false;
+    }
+
+    SalarySketch parsed;
+    std::uint64_t level_count = 0;
+
+    bool ok = readU64(cursor, end, parsed.item_count) &&
+              readDouble(cursor, end, parsed.running_mean) &&
+              readDouble(cursor, end, parsed.sum_squares) &&
+              readDouble(cursor, end, parsed.minimum) &&
+              readDouble(cursor, end, parsed.maximum) &&
+              readU64(cursor, end, parsed.coin) &&
+              readU64(cursor, end, level_count) &&
+              level_count >= 1 && level_count <= 64;
+
+    if (!ok) {
+        return false;
+    }
+
+    parsed.levels.assign(static_cast<std::size_t>(level_count), {});
+
+    for (auto& level : parsed.levels) {
+        std::uint64_t items = 0;
+
+        if (!readU64(cursor, end, items) || items > static_cast<std::uint64_t>(end - cursor) / 8) {
+            return false;
+        }
+
+        level.resize(static_cast<std::size_t>(items));
+
+        for (double& value : level) {
+            readDouble(cursor, end, value);
+        }
+    }
+
+    if (cursor != end) {
+        return false;
+    }
+
+    *this = std::move(parsed);
+    return true;
+}
+
+double SalaryStatistics::salaryOf(const Job& job) {
+    return salaryOf(job.salary_min, job.salary_max);
+}
+
+double SalaryStatistics::salaryOf(double salary_min, double salary_max) {
+    if (salary_min > 0 && salary_max > 0) {
+        return (salary_min + salary_max) / 2.0;
+    }
+
+    return std::max(0.0, std::max(salary_min, salary_max));
+}
+
+SalarySketch& SalaryStatistics::slice(const std::string& key) {
+    changed.insert(key);
+    return slices[key];
+}
+
+const SalarySketch* SalaryStatistics::find(const std::string& key) const {
+    auto it = slices.find(key);
+    return it == slices.end() ? nullptr : &it->second;
+}
+
+void SalaryStatistics::add(const Job& job) {
+    double salary = salaryOf(job);
+
+    if (salary <= 0) {
+        return;
+    }
+
+    slice("all").add(salary);
+
+    if (!job.category.empty()) {
+        slice("category:" + job.category).add(salary);
+    }
+
+    std::string location = RelevanceIndex::locationKey(job.location.display_name);
+
+    if (!location.empty()) {
+        slice("location:" + location).add(salary);
+    }
+
+    for (const auto& technology : job.technologies) {
+        slice("technology:" + technology).add(salary);
+    }
+}
+
+void SalaryStatistics::merge(const SalaryStatistics& other) {
+    for (const auto& [key, sketch] : other.slices) {
+        slice(key).merge(sketch);
+    }
+}
+
+void SalaryStatistics::clear() {
+    slices.clear();
+    changed.clear();
+}
+
+const SalarySketch& SalaryStatistics::all() const {
+    static const SalarySketch none;
+    const SalarySketch* overall = find("all");
+    return overall ? *overall : none;
+}
+
+const SalarySketch* SalaryStatistics::byCategory(const std::string& category) const {
+    return find("category:" + category);
+}
+
+const SalarySketch* SalaryStatistics::byLocation(std::string_view location) const {
+    return find("location:" + RelevanceIndex::locationKey(location));
+}
+
+const SalarySketch* SalaryStatistics::byTechnology(const std::string& technology) const {
+    return find("technology:" + technology);
+}
+
+void SalaryStatistics::setSlice(const std::string& key, SalarySketch sketch) {
+    slices[key] = std::move(sketch);
+}
+
+std::set<std::string> SalaryStatistics::takeChanged() {
+    std::set<std::string> result;
+    result.swap(changed);
+    return result;
+}
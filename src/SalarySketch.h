@@ -0,0 +1,120 @@
+#ifndef SALARYSKETCH_H
+#define SALARYSKETCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "model/Job.h"
+
+// One-pass summary of a stream of salaries: exact count, mean, variance
+// (Welford), min and max, plus a KLL quantile sketch whose rank error is
+// about 1% at kK = 200 regardless of how many values were added. Sketches
+// of disjoint streams merge into the sketch of their union, so per-chunk or
+// per-batch summaries can be combined instead of rescanned.
+//
+// Quantile queries sort the retained items (a few hundred); isOutlier uses
+// fences cached from the last such sort, so it is O(1) between updates.
+// Const calls may refresh that cache: share a sketch across threads only if
+// it is not being updated and has been queried once.
+class SalarySketch {
+private:
+    std::uint64_t item_count;
+    double running_mean;
+    double sum_squares;   // of deviations from the mean (Welford's M2)
+    double minimum;
+    double maximum;
+
+    // levels[h] holds items that each stand for 2^h added values.
+    std::vector<std::vector<double>> levels;
+    std::uint64_t coin;
+
+    mutable bool fences_valid;
+    mutable double lower_fence;
+    mutable double upper_fence;
+
+    std::size_t capacity(std::size_t level) const;
+    void compress();
+    bool flip();
+
+public:
+    static constexpr std::size_t kK = 200;
+
+    // Tukey's far-out fences: an outlier lies more than 3 interquartile
+    // ranges outside the middle half.
+    static constexpr double kFenceWidth = 3.0;
+
+    // Fewer salaries than this never make an outlier: the quartiles of a
+    // handful say little about the spread.
+    static constexpr std::uint64_t kMinOutlierSample = 4;
+
+    SalarySketch();
+
+    void add(double salary);
+    void merge(const SalarySketch& other);
+
+    std::uint64_t count() const { return item_count; }
+    bool empty() const { return item_count == 0; }
+    double mean() const { return running_mean; }
+    double variance() const;
+    double stddev() const;
+    double min() const { return minimum; }
+    double max() const { return maximum; }
+
+    // Value at rank `q` in [0, 1]; 0 when empty.
+    double quantile(double q) const;
+
+    bool isOutlier(double salary) const;
+
+    // Little-endian binary form for storage; deserialize returns false
+    // (and leaves the sketch empty) for data it does not recognize.
+    void serialize(std::string& out) const;
+    bool deserialize(const char* data, std::size_t size);
+};
+
+// SalarySketches of job salaries, overall and sliced by category, location
+// and technology. A job's salary is the midpoint of its range; jobs without
+// one are left out.
+//
+// Slices are keyed "all", "category:<name>", "location:<key>" (see
+// RelevanceIndex::locationKey) and "technology:<name>". Slices changed since
+// the last takeChanged() are tracked so callers can persist only those.
+class SalaryStatistics {
+private:
+    std::map<std::string, SalarySketch> slices;
+    std::set<std::string> changed;
+
+    SalarySketch& slice(const std::string& key);
+    const SalarySketch* find(const std::string& key) const;
+
+public:
+    static double salaryOf(const Job& job);
+
+    // The same, from the two ends of a range, for callers holding salary
+    // columns rather than jobs.
+    static double salaryOf(double salary_min, double salary_max);
+
+    void add(const Job& job);
+    void merge(const SalaryStatistics& other);
+    void clear();
+
+    const SalarySketch& all() const;
+    const SalarySketch* byCategory(const std::string& category) const;
+    const SalarySketch* byLocation(std::string_view location) const;
+    const SalarySketch* byTechnology(const std::string& technology) const;
+
+    const std::map<std::string, SalarySketch>& allSlices() const {
+        return slices;
+    }
+
+    // Replaces (or creates) one slice, e.g. when loading from storage.
+    void setSlice(const std::string& key, SalarySketch sketch);
+
+    std::set<std::string> takeChanged();
+};
+
+#endif
@@ -0,0 +1,370 @@
+#include "ShardedDatabase.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <queue>
+#include <utility>
+
+#include "SimHash.h"
+
+namespace {
+
+// FNV-1a with MurmurHash3's finalizer. Fixed rather than std::hash, since
+// the shard an id lands in must not change between builds.
+std::uint64_t idHash(const std::string& job_id) {
+    std::uint64_t h = 1469598103934665603ULL;
+
+    for (unsigned char c : job_id) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+} // namespace
+
+ShardedDatabase::ShardedDatabase(const std::string& path,
+                                 std::size_t shard_count,
+                                 const DatabaseOptions& options)
+    : near_duplicates(options.near_duplicates),
+      fingerprints_loaded(false),
+      near_duplicate_count(0),
+      merged_dirty(true) {
+    shard_count = std::max<std::size_t>(shard_count, 1);
+
+    DatabaseOptions shard_options = options;
+    shard_options.near_duplicates = NearDuplicatePolicy::Keep;
+
+    for (std::size_t i = 0; i < shard_count; i++) {
+        auto shard = std::make_unique<Shard>();
+        shard->database = std::make_unique<Database>(shardPath(path, i), shard_options);
+
+        Shard* owner = shard.get();
+        shard->worker = std::thread([owner]() {
+            std::function<void()> task;
+
+            while (owner->tasks.pop(task)) {
+                task();
+            }
+        });
+
+        shards.push_back(std::move(shard));
+    }
+}
+
+ShardedDatabase::~ShardedDatabase() {
+    for (auto& shard : shards) {
+        shard->tasks.close();
+    }
+
+    for (auto& shard : shards) {
+        shard->worker.join();
+    }
+}
+
+std::string ShardedDatabase::shardPath(const std::string& path, std::size_t index) {
+    std::filesystem::path base(path);
+    std::string name = base.stem().string() + "." + std::to_string(index) + base.extension().string();
+
+    return (base.parent_path() / name).string();
+}
+
+std::size_t ShardedDatabase::shardOf(const std::string& job_id) const {
+    return static_cast<std::size_t>(idHash(job_id) % shards.size());
+}
+
+std::future<void> ShardedDatabase::submit(std::size_t index, std::function<void(Database&)> fn) {
+    Database& database = *shards[index]->database;
+    auto task = std::make_shared<std::packaged_task<void()>>(
+        [fn = std::move(fn), &database]() { fn(database); });
+
+    std::future<void> done = task->get_future();
+    shards[index]->tasks.push([task]() { (*task)(); });
+
+    return done;
+}
+
+void ShardedDatabase::forEachShard(const std::function<void(std::size_t, Database&)>& fn) {
+    std::vector<std::future<void>> pending;
+    pending.reserve(shards.size());
+
+    for (std::size_t i = 0; i < shards.size(); i++) {
+        pending.push_back(submit(i, [&fn, i](Database& database) { fn(i, database); }));
+    }
+
+    // Every task refers to `fn`, so all of them finish before anything is
+    // rethrown.
+    std::exception_ptr error;
+
+    for (auto& done : pending) {
+        try {
+            done.get();
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void ShardedDatabase::loadFingerprints() {
+    fingerprints.clear();
+
+    // One shard at a time, since they all add to the same index.
+    for (std::size_t i = 0; i < shards.size(); i++) {
+        submit(i, [this](Database& database) { database.addFingerprints(fingerprints); }).get();
+    }
+
+    fingerprints_loaded = true;
+}
+
+bool ShardedDatabase::checkNearDuplicate(Job& job) {
+    if (near_duplicates == NearDuplicatePolicy::Keep) {
+        return true;
+    }
+
+    if (!fingerprints_loaded) {
+        loadFingerprints();
+    }
+
+    if (job.simhash == 0) {
+        job.simhash = SimHash::fingerprint(job);
+    }
+
+    const std::string* original = job.simhash != 0 ? fingerprints.find(job.simhash, job.id) : nullptr;
+
+    if (!original) {
+        job.duplicate_of.clear();
+
+        // Later jobs of the same batch are checked against this one too.
+        if (job.simhash != 0) {
+            fingerprints.add(job.simhash, job.id);
+        }
+
+        return true;
+    }
+
+    near_duplicate_count++;
+
+    if (near_duplicates == NearDuplicatePolicy::Merge) {
+        return false;
+    }
+
+    job.duplicate_of = *original;
+    return true;
+}
+
+bool ShardedDatabase::storeJob(const Job& job) {
+    Job row = job;
+
+    if (!checkNearDuplicate(row)) {
+        return true;
+    }
+
+    bool stored = false;
+
+    submit(shardOf(row.id), [&](Database& database) { stored = database.storeJob(row); }).get();
+    merged_dirty = true;
+
+    return stored;
+}
+
+bool ShardedDatabase::storeJobs(const std::vector<Job>& jobs) {
+    return storeJobs(std::vector<Job>(jobs));
+}
+
+bool ShardedDatabase::storeJobs(std::vector<Job>&& jobs) {
+    std::vector<std::vector<Job>> parts(shards.size());
+
+    for (auto& job : jobs) {
+        if (!checkNearDuplicate(job)) {
+            continue;
+        }
+
+        std::size_t shard = shardOf(job.id);
+        parts[shard].push_back(std::move(job));
+    }
+
+    std::vector<char> stored(shards.size(), 1);
+
+    forEachShard([&](std::size_t i, Database& database) {
+        if (!parts[i].empty()) {
+            stored[i] = database.storeJobs(std::move(parts[i]));
+        }
+    });
+
+    merged_dirty = true;
+
+    return std::all_of(stored.begin(), stored.end(), [](char ok) { return ok != 0; });
+}
+
+const std::vector<const Job*>& ShardedDatabase::loadJobs() {
+    if (!merged_dirty) {
+        return merged_jobs;
+    }
+
+    std::vector<const std::vector<Job>*> loaded(shards.size());
+
+    forEachShard([&](std::size_t i, Database& database) {
+        loaded[i] = &database.loadJobs();
+    });
+
+    // Each shard is already newest first; merge them, ties in shard order.
+    struct Cursor {
+        std::size_t shard;
+        std::size_t position;
+    };
+
+    auto older = [&](const Cursor& a, const Cursor& b) {
+        const std::string& a_created = (*loaded[a.shard])[a.position].created;
+        const std::string& b_created = (*loaded[b.shard])[b.position].created;
+        return a_created < b_created || (a_created == b_created && a.shard > b.shard);
+    };
+
+    std::priority_queue<Cursor, std::vector<Cursor>, decltype(older)> next(older);
+    std::size_t total = 0;
+
+    for (std::size_t i = 0; i < shards.size(); i++) {
+        total += loaded[i]->size();
+
+        if (!loaded[i]->empty()) {
+            next.push(Cursor{i, 0});
+        }
+    }
+
+    merged_jobs.clear();
+    merged_jobs.reserve(total);
+
+    while (!next.empty()) {
+        Cursor cursor = next.top();
+        next.pop();
+        merged_jobs.push_back(&(*loaded[cursor.shard])[cursor.position]);
+
+        if (++cursor.position < loaded[cursor.shard]->size()) {
+            next.push(cursor);
+        }
+    }
+
+    merged_dirty = false;
+    return merged_jobs;
+}
+
+void ShardedDatabase::refreshCache() {
+    forEachShard([](std::size_t, Database& database) { database.refreshCache(); });
+    fingerprints_loaded = false;
+    merged_dirty = true;
+}
+
+bool ShardedDatabase::isJobExists(const std::string& job_id) {
+    bool exists = false;
+
+    submit(shardOf(job_id), [&](Database& database) { exists = database.isJobExists(job_id); }).get();
+
+    return exists;
+}
+
+std::unordered_set<std::string> ShardedDatabase::findExistingJobs(const std::vector<std::string>& job_ids) {
+    std::vector<std::vector<std::string>> parts(shards.size());
+
+    for (const auto& id : job_ids) {
+        parts[shardOf(id)].push_back(id);
+    }
+
+    std::vector<std::unordered_set<std::string>> found(shards.size());
+
+    forEachShard([&](std::size_t i, Database& database) {
+        if (!parts[i].empty()) {
+            found[i] = database.findExistingJobs(parts[i]);
+        }
+    });
+
+    std::unordered_set<std::string> existing;
+
+    for (auto& ids : found) {
+        existing.merge(ids);
+    }
+
+    return existing;
+}
+
+bool ShardedDatabase::loadCheckpoint(const std::string& search_key, CrawlCheckpoint& checkpoint) {
+    bool found = false;
+
+    submit(0, [&](Database& database) { found = database.loadCheckpoint(search_key, checkpoint); }).get();
+
+    return found;
+}
+
+bool ShardedDatabase::saveCheckpoint(const std::string& search_key, const CrawlCheckpoint& checkpoint) {
+    bool saved = false;
+
+    submit(0, [&](Database& database) { saved = database.saveCheckpoint(search_key, checkpoint); }).get();
+
+    return saved;
+}
+
+std::vector<Job> ShardedDatabase::search(const std::string& query,
+                                         const SearchFilters& filters,
+                                         int limit) {
+    // Each shard's best `limit` include every row of the overall best.
+    std::vector<std::vector<Job>> found(shards.size());
+    std::vector<std::vector<double>> scores(shards.size());
+
+    forEachShard([&](std::size_t i, Database& database) {
+        found[i] = database.search(query, filters, limit, &scores[i]);
+    });
+
+    struct Hit {
+        std::size_t shard;
+        std::size_t rank;
+    };
+
+    std::vector<Hit> hits;
+    bool ranked = true;
+
+    for (std::size_t i = 0; i < shards.size(); i++) {
+        ranked = ranked && scores[i].size() == found[i].size();
+
+        for (std::size_t rank = 0; rank < found[i].size(); rank++) {
+            hits.push_back(Hit{i, rank});
+        }
+    }
+
+    // Hits are in shard, then rank order, which the stable sort keeps for
+    // ties.
+    ranked = ranked && !hits.empty();
+
+    std::stable_sort(hits.begin(), hits.end(), [&](const Hit& a, const Hit& b) {
+        if (ranked) {
+            return scores[a.shard][a.rank] < scores[b.shard][b.rank];
+        }
+
+        return found[a.shard][a.rank].created > found[b.shard][b.rank].created;
+    });
+
+    if (hits.size() > static_cast<std::size_t>(std::max(limit, 0))) {
+        hits.resize(static_cast<std::size_t>(std::max(limit, 0)));
+    }
+
+    std::vector<Job> results;
+    results.reserve(hits.size());
+
+    for (const auto& hit : hits) {
+        results.push_back(std::move(found[hit.shard][hit.rank]));
+    }
+
+    return results;
+}
@@ -0,0 +1,117 @@
+#ifndef SHARDEDDATABASE_H
+#define SHARDEDDATABASE_H
+
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "BoundedQueue.h"
+#include "Database.h"
+#include "NearDuplicateIndex.h"
+#include "model/Job.h"
+
+// Jobs spread over `shard_count` SQLite files by a hash of Job::id, so
+// writes are no longer serialized by a single file's lock. "jobs.db" with
+// four shards is "jobs.0.db" .. "jobs.3.db". Each shard is a Database
+// owned by its own thread, and every call fans out to the shards it
+// touches and waits for them: a batch is written to all shards at once,
+// and reads gather the shards' answers into one.
+//
+// Ids are routed modulo the shard count, so reopen a set of shards with
+// the count it was created with. Near-duplicates are looked up against the
+// originals of every shard before a job is routed, so a repost is caught
+// whichever shard its id lands in. Like Database, one caller at a time.
+class ShardedDatabase {
+private:
+    struct Shard {
+        std::unique_ptr<Database> database;
+        BoundedQueue<std::function<void()>> tasks;
+        std::thread worker;
+
+        Shard() : tasks(16) {}
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    // The near-duplicate policy is applied here, with one index over the
+    // originals of all shards (loaded on the first write); the shards
+    // themselves are opened with NearDuplicatePolicy::Keep and store jobs
+    // as flagged here.
+    NearDuplicatePolicy near_duplicates;
+    NearDuplicateIndex fingerprints;
+    bool fingerprints_loaded;
+    std::size_t near_duplicate_count;
+
+    // The rows of every shard's loadJobs(), merged newest first; rebuilt
+    // after writes. Points into the shards' caches rather than copying them.
+    std::vector<const Job*> merged_jobs;
+    bool merged_dirty;
+
+    std::size_t shardOf(const std::string& job_id) const;
+
+    // Queues fn(database) on shard `index`'s thread.
+    std::future<void> submit(std::size_t index, std::function<void(Database&)> fn);
+
+    // Runs fn(index, database) on every shard's thread and waits for all of
+    // them; the first exception thrown is rethrown here.
+    void forEachShard(const std::function<void(std::size_t, Database&)>& fn);
+
+    void loadFingerprints();
+
+    // Applies the near-duplicate policy to `job`, computing its SimHash if
+    // it has none; false if the job is to be dropped.
+    bool checkNearDuplicate(Job& job);
+
+public:
+    ShardedDatabase(const std::string& path,
+                    std::size_t shard_count,
+                    const DatabaseOptions& options = DatabaseOptions());
+    ~ShardedDatabase();
+
+    ShardedDatabase(const ShardedDatabase&) = delete;
+    ShardedDatabase& operator=(const ShardedDatabase&) = delete;
+
+    std::size_t shardCount() const {
+        return shards.size();
+    }
+
+    // The file of shard `index`.
+    static std::string shardPath(const std::string& path, std::size_t index);
+
+    bool storeJob(const Job& job);
+    bool storeJobs(const std::vector<Job>& jobs);
+    bool storeJobs(std::vector<Job>&& jobs);
+
+    // Every shard's rows, newest first, as pointers into the shards' own
+    // caches. The reference and the rows it points to stay valid until the
+    // next call that writes or reloads.
+    const std::vector<const Job*>& loadJobs();
+    void refreshCache();
+
+    // Asks only the shard the id hashes to.
+    bool isJobExists(const std::string& job_id);
+    std::unordered_set<std::string> findExistingJobs(const std::vector<std::string>& job_ids);
+
+    // Near-duplicates flagged or merged since this was opened.
+    std::size_t nearDuplicateCount() const {
+        return near_duplicate_count;
+    }
+
+    // Checkpoints are not per job, so they all live in shard 0.
+    bool loadCheckpoint(const std::string& search_key, CrawlCheckpoint& checkpoint);
+    bool saveCheckpoint(const std::string& search_key, const CrawlCheckpoint& checkpoint);
+
+    // Database::search on every shard, merged by bm25 rank (each shard
+    // ranks against its own term statistics, which hashing keeps close to
+    // the whole set's) or, for date-ordered searches, by date.
+    std::vector<Job> search(const std::string& query,
+                            const SearchFilters& filters = SearchFilters(),
+                            int limit = 50);
+};
+
+#endif
@@ -0,0 +1,101 @@
+#include "SimHash.h"
+
+#include <string_view>
+
+namespace {
+
+std::uint64_t mix(std::uint64_t z) {
+    z += 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+bool isWordByte(unsigned char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           c == '+' || c == '#' || c >= 0x80;
+}
+
+// Running bit votes over the word pairs of several fields, read as one
+// stream so a pair can span the end of the title and the start of the
+// company.
+class Accumulator {
+private:
+    int votes[64] = {};
+    std::uint64_t previous = 0;
+    bool has_previous = false;
+    bool any = false;
+
+    void addWord(std::string_view word) {
+        std::uint64_t h = 1469598103934665603ULL;
+
+        for (unsigned char c : word) {
+            h ^= (c >= 'A' && c <= 'Z') ? c + 32 : c;
+            h *= 1099511628211ULL;
+        }
+
+        if (has_previous) {
+            std::uint64_t feature = mix(previous * 31 + h);
+
+            for (int bit = 0; bit < 64; bit++) {
+                votes[bit] += ((feature >> bit) & 1) ? 1 : -1;
+            }
+
+            any = true;
+        }
+
+        previous = h;
+        has_previous = true;
+    }
+
+public:
+    void addText(std::string_view text) {
+        std::size_t i = 0;
+
+        while (i < text.size()) {
+            while (i < text.size() && !isWordByte(static_cast<unsigned char>(text[i]))) {
+                i++;
+            }
+
+            std::size_t start = i;
+
+            while (i < text.size() && isWordByte(static_cast<unsigned char>(text[i]))) {
+                i++;
+            }
+
+            if (i > start) {
+                addWord(text.substr(start, i - start));
+            }
+        }
+    }
+
+    std::uint64_t result() const {
+        if (!any) {
+            return 0;
+        }
+
+        std::uint64_t fingerprint = 0;
+
+        for (int bit = 0; bit < 64; bit++) {
+            if (votes[bit] > 0) {
+                fingerprint |= std::uint64_t(1) << bit;
+            }
+        }
+
+        // Keep 0 free for "no fingerprint".
+        return fingerprint ? fingerprint : 1;
+    }
+};
+
+} // namespace
+
+std::uint64_t SimHash::fingerprint(const Job& job) {
+    Accumulator accumulator;
+
+    accumulator.addText(job.title);
+    accumulator.addText(job.company.display_name);
+    accumulator.addText(job.location.display_name);
+    accumulator.addText(job.description);
+
+    return accumulator.result();
+}
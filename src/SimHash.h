@@ -0,0 +1,23 @@
+#ifndef SIMHASH_H
+#define SIMHASH_H
+
+#include <cstdint>
+
+#include "model/Job.h"
+
+// 64-bit SimHash of a posting: every pair of adjacent words in its title,
+// company, location and description votes on each bit with its own hash,
+// and the fingerprint keeps the majority. Reposts of the same text (a
+// different id, an aggregator's prefix, a truncated description) land a
+// few bits apart, while unrelated postings differ in about 32.
+class SimHash {
+public:
+    // 0 when the job has no words; callers treat 0 as "no fingerprint".
+    static std::uint64_t fingerprint(const Job& job);
+
+    static int distance(std::uint64_t a, std::uint64_t b) {
+        return __builtin_popcountll(a ^ b);
+    }
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "SimilarityIndex.h"
+
+#include <algorithm>
+
+SimilarityIndex::SimilarityIndex(const std::vector<Job>& jobs)
+    : buckets(MinHash::kBands) {
+    signatures.reserve(jobs.size() * MinHash::kHashes);
+
+    for (const auto& job : jobs) {
+        if (job.minhash.size() == MinHash::kHashes) {
+            signatures.insert(signatures.end(), job.minhash.begin(), job.minhash.end());
+        } else {
+            std::vector<std::uint32_t> computed = MinHash::signature(job);
+            signatures.insert(signatures.end(), computed.begin(), computed.end());
+        }
+    }
+
+    for (std::size_t band = 0; band < MinHash::kBands; band++) {
+        std::vector<std::uint64_t>& entries = buckets[band];
+        entries.reserve(jobs.size());
+
+        for (std::size_t row = 0; row < jobs.size(); row++) {
+            // Jobs without words would all share every bucket.
+            if (MinHash::isEmpty(signatureAt(row))) {
+                continue;
+            }
+
+            std::uint64_t key = MinHash::bandKey(signatureAt(row), band) >> 32;
+            entries.push_back(key << 32 | row);
+        }
+
+        std::sort(entries.begin(), entries.end());
+    }
+}
+
+double SimilarityIndex::similarity(const std::vector<std::uint32_t>& signature, std::size_t row) const {
+    return MinHash::similarity(signature.data(), signatureAt(row));
+}
+
+std::vector<std::size_t> SimilarityIndex::nearest(const std::vector<std::uint32_t>& signature,
+                                                  std::size_t k,
+                                                  std::size_t exclude) const {
+    std::vector<std::size_t> result;
+
+    if (k == 0 || signature.size() != MinHash::kHashes || MinHash::isEmpty(signature.data())) {
+        return result;
+    }
+
+    std::vector<std::uint32_t> candidates;
+
+    for (std::size_t band = 0; band < MinHash::kBands; band++) {
+        const std::vector<std::uint64_t>& entries = buckets[band];
+        std::uint64_t key = MinHash::bandKey(signature.data(), band) >> 32;
+
+        auto first = std::lower_bound(entries.begin(), entries.end(), key << 32);
+        auto last = std::upper_bound(first, entries.end(), key << 32 | 0xFFFFFFFFu);
+
+        for (auto it = first; it != last; ++it) {
+            candidates.push_back(static_cast<std::uint32_t>(*it));
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    struct Ranked {
+        double similarity;
+        std::size_t row;
+    };
+
+    std::vector<Ranked> ranked;
+    ranked.reserve(candidates.size());
+
+    for (std::uint32_t row : candidates) {
+        if (row != exclude) {
+            ranked.push_back(Ranked{similarity(signature, row), row});
+        }
+    }
+
+    auto before = [](const Ranked& a, const Ranked& b) {
+        return a.similarity > b.similarity || (a.similarity == b.similarity && a.row < b.row);
+    };
+
+    std::size_t keep = std::min(k, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + static_cast<std::ptrdiff_t>(keep), ranked.end(), before);
+
+    result.reserve(keep);
+
+    for (std::size_t i = 0; i < keep; i++) {
+        result.push_back(ranked[i].row);
+    }
+
+    return result;
+}
@@ -0,0 +1,50 @@
+#ifndef SIMILARITYINDEX_H
+#define SIMILARITYINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "MinHash.h"
+#include "model/Job.h"
+
+// Locality-sensitive hashing over MinHash signatures, for "more like this"
+// lookups. Each band of a signature is hashed into a sorted bucket array,
+// so a query only verifies the jobs that share a band with it (binary
+// searches per band plus the candidates) instead of comparing against
+// every job.
+//
+// Signatures come from Job::minhash when it was filled in at ingest, and
+// are computed here otherwise.
+class SimilarityIndex {
+private:
+    std::vector<std::uint32_t> signatures;   // MinHash::kHashes per row
+
+    // Per band, (band key << 32 | row) sorted: a bucket is an equal range
+    // of the high halves.
+    std::vector<std::vector<std::uint64_t>> buckets;
+
+    const std::uint32_t* signatureAt(std::size_t row) const {
+        return &signatures[row * MinHash::kHashes];
+    }
+
+public:
+    explicit SimilarityIndex(const std::vector<Job>& jobs);
+
+    std::size_t size() const {
+        return signatures.size() / MinHash::kHashes;
+    }
+
+    // Up to `k` rows most similar to `signature`, most similar first (ties
+    // in row order). Only rows sharing a band are considered, so rows below
+    // roughly 0.3 estimated similarity are rarely returned. `exclude` is
+    // skipped, e.g. the row of the reference job itself.
+    std::vector<std::size_t> nearest(const std::vector<std::uint32_t>& signature,
+                                     std::size_t k,
+                                     std::size_t exclude = static_cast<std::size_t>(-1)) const;
+
+    // Estimated Jaccard similarity of `row` to `signature`.
+    double similarity(const std::vector<std::uint32_t>& signature, std::size_t row) const;
+};
+
+#endif
@@ -0,0 +1,98 @@
+#include "SqliteConnection.h"
+
+#include <iostream>
+
+#include <sqlite3.h>
+
+SqliteConnection::Statement::~Statement() {
+    if (!stmt) {
+        return;
+    }
+
+    if (!in_use) {
+        sqlite3_finalize(stmt);
+        return;
+    }
+
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    *in_use = false;
+}
+
+SqliteConnection::SqliteConnection(const std::string& path, bool write_ahead_log)
+    : db(nullptr) {
+    if (sqlite3_open(path.c_str(), &db) != SQLITE_OK) {
+        std::cerr << "Cannot open database: " << sqlite3_errmsg(db) << '\n';
+        sqlite3_close(db);
+        db = nullptr;
+        return;
+    }
+
+    // Other connections (other threads or processes) may hold the write
+    // lock briefly; wait for it instead of failing with SQLITE_BUSY.
+    sqlite3_busy_timeout(db, 5000);
+
+    if (write_ahead_log) {
+        execute("PRAGMA journal_mode = WAL; PRAGMA synchronous = NORMAL;");
+    }
+}
+
+SqliteConnection::~SqliteConnection() {
+    for (auto& [sql, cached] : statements) {
+        sqlite3_finalize(cached.stmt);
+    }
+
+    if (db) {
+        sqlite3_close(db);
+    }
+}
+
+bool SqliteConnection::execute(const char* sql) {
+    if (!db) {
+        return false;
+    }
+
+    char* error_message = nullptr;
+
+    if (sqlite3_exec(db, sql, nullptr, nullptr, &error_message) != SQLITE_OK) {
+        std::cerr << "SQL error: " << (error_message ? error_message : sqlite3_errmsg(db)) << '\n';
+        sqlite3_free(error_message);
+        return false;
+    }
+
+    return true;
+}
+
+SqliteConnection::Statement SqliteConnection::prepare(const std::string& sql) {
+    if (!db) {
+        return Statement(nullptr, nullptr);
+    }
+
+    auto it = statements.find(sql);
+
+    if (it != statements.end() && !it->second.in_use) {
+        it->second.in_use = true;
+        return Statement(it->second.stmt, &it->second.in_use);
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Prepare failed: " << sqlite3_errmsg(db) << '\n';
+        sqlite3_finalize(stmt);
+        return Statement(nullptr, nullptr);
+    }
+
+    // The cached one is busy: this copy lives only as long as its Statement.
+    if (it != statements.end()) {
+        return Statement(stmt, nullptr);
+    }
+
+    // Map nodes do not move on rehash, so the flag's address stays valid.
+    CachedStatement& cached = statements.emplace(sql, CachedStatement{stmt, true}).first->second;
+    return Statement(stmt, &cached.in_use);
+}
+
+const char* SqliteConnection::errorMessage() const {
+    return db ? sqlite3_errmsg(db) : "database is not open";
+}
@@ -0,0 +1,82 @@
+#ifndef SQLITECONNECTION_H
+#define SQLITECONNECTION_H
+
+#include <string>
+#include <unordered_map>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+// Owns one sqlite3 handle for its whole lifetime, together with the
+// statements prepared on it. Statements are cached by their SQL text, so
+// each distinct query is compiled once per connection. Not thread-safe: use
+// one connection per thread.
+class SqliteConnection {
+private:
+    struct CachedStatement {
+        sqlite3_stmt* stmt;
+        bool in_use;
+    };
+
+    sqlite3* db;
+    std::unordered_map<std::string, CachedStatement> statements;
+
+public:
+    // Resets its statement (and clears bindings) when it goes out of scope,
+    // which also releases the read lock a half-stepped SELECT would hold,
+    // and hands a cached statement back to the cache. A statement prepared
+    // outside the cache is finalized instead.
+    class Statement {
+    private:
+        sqlite3_stmt* stmt;
+        bool* in_use;   // the cache entry's flag; null if not cached
+
+    public:
+        Statement(sqlite3_stmt* statement, bool* cached_in_use)
+            : stmt(statement), in_use(cached_in_use) {}
+        ~Statement();
+
+        Statement(Statement&& other) noexcept : stmt(other.stmt), in_use(other.in_use) {
+            other.stmt = nullptr;
+            other.in_use = nullptr;
+        }
+
+        Statement(const Statement&) = delete;
+        Statement& operator=(const Statement&) = delete;
+        Statement& operator=(Statement&&) = delete;
+
+        sqlite3_stmt* get() const {
+            return stmt;
+        }
+
+        explicit operator bool() const {
+            return stmt != nullptr;
+        }
+    };
+
+    SqliteConnection(const std::string& path, bool write_ahead_log);
+    ~SqliteConnection();
+
+    SqliteConnection(const SqliteConnection&) = delete;
+    SqliteConnection& operator=(const SqliteConnection&) = delete;
+
+    bool isOpen() const {
+        return db != nullptr;
+    }
+
+    sqlite3* handle() const {
+        return db;
+    }
+
+    // Runs one or more statements without caching them.
+    bool execute(const char* sql);
+
+    // Cached prepared statement for `sql`; empty on failure. While an
+    // earlier Statement for the same SQL is still alive, a separate,
+    // uncached one is prepared so the two do not share bindings or a cursor.
+    Statement prepare(const std::string& sql);
+
+    const char* errorMessage() const;
+};
+
+#endif
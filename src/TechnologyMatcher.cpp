@@ -0,0 +1,516 @@
+#include "TechnologyMatcher.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <queue>
+#include <stdexcept>
+
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+
+std::string toLower(const std::string& value) {
+    std::string result = value;
+    std::transform(result.begin(), result.end(), result.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return result;
+}
+
+} // namespace
+
+const std::vector<TechnologyDefinition>& TechnologyMatcher::defaultDefinitions() {
+    // Keywords default to the lowercased name. Ambiguous short names (Go, R,
+    // C, Chef, ...) only match through longer, unambiguous spellings.
+    static const std::vector<TechnologyDefinition> definitions = {
+        // Languages
+        {"C++", {"c++", "cpp"}, {"c plus plus", "cplusplus"}},
+        {"C#", {"c#"}, {"csharp", "c sharp"}},
+        {"C", {"c programming", "c language", "embedded c", "ansi c"}, {"c99", "c11"}},
+        {"Java", {}, {"java se", "java ee", "j2ee", "jakarta ee"}},
+        {"JavaScript", {}, {"js", "ecmascript", "es6"}},
+        {"TypeScript", {}, {}},
+        {"Python", {}, {"python3", "cpython"}},
+        {"Go", {"golang"}, {"go lang"}},
+        {"Rust", {}, {}},
+        {"Ruby", {}, {}},
+        {"PHP", {}, {"php8", "php7"}},
+        {"Kotlin", {}, {}},
+        {"Swift", {}, {}},
+        {"Scala", {}, {}},
+        {"Perl", {}, {}},
+        {"R", {"r programming", "r language"}, {"rstudio", "tidyverse"}},
+        {"Haskell", {}, {}},
+        {"Elixir", {}, {}},
+        {"Erlang", {}, {}},
+        {"Clojure", {}, {}},
+        {"F#", {"f#"}, {"fsharp"}},
+        {"Dart", {}, {}},
+        {"Lua", {}, {}},
+        {"Julia", {"julia language"}, {}},
+        {"MATLAB", {}, {"simulink"}},
+        {"Objective-C", {"objective-c"}, {"objc", "obj-c"}},
+        {"Groovy", {}, {}},
+        {"Fortran", {}, {}},
+        {"COBOL", {}, {}},
+        {"Assembly", {"assembly language"}, {"asm", "x86 assembly", "arm assembly"}},
+        {"Visual Basic", {}, {"vb.net", "vba"}},
+        {"Solidity", {}, {}},
+        {"Zig", {}, {}},
+        {"OCaml", {}, {}},
+        {"Bash", {}, {"shell scripting", "bash scripting"}},
+        {"PowerShell", {}, {}},
+        {"SQL", {}, {"t-sql", "tsql", "pl/sql", "ansi sql"}},
+        {"GraphQL", {}, {"apollo graphql"}},
+        {"HTML", {}, {"html5"}},
+        {"CSS", {}, {"css3"}},
+        {"Sass", {}, {"scss"}},
+        {"WebAssembly", {}, {"wasm"}},
+        {"Verilog", {}, {"systemverilog"}},
+        {"VHDL", {}, {}},
+        {"Apex", {"salesforce apex"}, {}},
+        {"ABAP", {}, {}},
+        {"Delphi", {}, {}},
+        {"Prolog", {}, {}},
+
+        // Frontend and mobile
+        {"React", {}, {"react.js", "reactjs"}},
+        {"React Native", {}, {}},
+        {"Angular", {}, {"angularjs", "angular.js"}},
+        {"Vue", {}, {"vue.js", "vuejs"}},
+        {"Svelte", {}, {"sveltekit"}},
+        {"Next.js", {}, {"nextjs"}},
+        {"Nuxt", {}, {"nuxt.js", "nuxtjs"}},
+        {"Redux", {}, {}},
+        {"jQuery", {}, {}},
+        {"Tailwind CSS", {"tailwind"}, {"tailwindcss"}},
+        {"Bootstrap", {}, {}},
+        {"Webpack", {}, {}},
+        {"Vite", {}, {}},
+        {"Ember.js", {}, {"emberjs"}},
+        {"Backbone.js", {}, {"backbonejs"}},
+        {"Gatsby", {}, {}},
+        {"Storybook", {}, {}},
+        {"Material UI", {}, {"material-ui", "mui"}},
+        {"Three.js", {}, {"threejs"}},
+        {"D3.js", {}, {"d3"}},
+        {"Flutter", {}, {}},
+        {"Ionic", {}, {}},
+        {"Electron", {"electron.js"}, {"electronjs"}},
+        {"Xamarin", {}, {}},
+        {"SwiftUI", {}, {}},
+        {"Jetpack Compose", {}, {}},
+        {"Android", {}, {"android sdk"}},
+        {"iOS", {}, {"ios sdk"}},
+
+        // Backend frameworks and runtimes
+        {"Node.js", {}, {"nodejs", "node"}},
+        {"Express", {"express.js"}, {"expressjs"}},
+        {"NestJS", {}, {"nest.js"}},
+        {"Deno", {}, {}},
+        {"Django", {}, {}},
+        {"Flask", {}, {}},
+        {"FastAPI", {}, {}},
+        {"Spring", {"spring framework"}, {"spring mvc"}},
+        {"Spring Boot", {}, {"springboot"}},
+        {"Ruby on Rails", {}, {"rails", "ror"}},
+        {"Laravel", {}, {}},
+        {"Symfony", {}, {}},
+        {"ASP.NET", {}, {"asp.net core", "aspnet"}},
+        {".NET", {}, {"dotnet", ".net core"}},
+        {"Entity Framework", {}, {"ef core"}},
+        {"Hibernate", {}, {}},
+        {"gRPC", {}, {}},
+        {"Protobuf", {}, {"protocol buffers"}},
+        {"Thrift", {"apache thrift"}, {}},
+        {"REST", {"rest api", "restful"}, {"rest apis"}},
+        {"SOAP", {}, {}},
+        {"WebSockets", {"websocket"}, {"websockets"}},
+        {"Microservices", {}, {"microservice"}},
+        {"Qt", {}, {"qml"}},
+        {"Boost", {"boost c++"}, {"boost libraries"}},
+        {"OpenGL", {}, {}},
+        {"Vulkan", {}, {}},
+        {"DirectX", {}, {"direct3d"}},
+        {"CUDA", {}, {}},
+        {"OpenCL", {}, {}},
+        {"OpenMP", {}, {}},
+        {"MPI", {}, {"open mpi"}},
+        {"Unreal Engine", {}, {"ue4", "ue5", "unreal"}},
+        {"Unity", {"unity3d"}, {"unity"}},
+        {"Godot", {}, {}},
+
+        // Messaging and caching
+        {"Kafka", {}, {"apache kafka"}},
+        {"RabbitMQ", {}, {}},
+        {"ActiveMQ", {}, {}},
+        {"NATS", {}, {}},
+        {"Celery", {}, {}},
+        {"Redis", {}, {}},
+        {"Memcached", {}, {}},
+        {"Nginx", {}, {}},
+        {"Apache HTTP Server", {"apache httpd"}, {"httpd"}},
+        {"Tomcat", {}, {}},
+
+        // Databases and data platforms
+        {"PostgreSQL", {}, {"postgres", "psql"}},
+        {"MySQL", {}, {}},
+        {"MariaDB", {}, {}},
+        {"SQLite", {}, {}},
+        {"Oracle Database", {"oracle database", "oracle db"}, {"oracle"}},
+        {"SQL Server", {}, {"mssql", "ms sql"}},
+        {"MongoDB", {}, {"mongo"}},
+        {"Cassandra", {}, {}},
+        {"DynamoDB", {}, {}},
+        {"Couchbase", {}, {}},
+        {"CouchDB", {}, {}},
+        {"Neo4j", {}, {}},
+        {"Elasticsearch", {}, {"elastic search", "elk"}},
+        {"OpenSearch", {}, {}},
+        {"Solr", {}, {}},
+        {"Snowflake", {}, {}},
+        {"BigQuery", {}, {}},
+        {"Redshift", {}, {}},
+        {"Databricks", {}, {}},
+        {"ClickHouse", {}, {}},
+        {"Cosmos DB", {}, {"cosmosdb"}},
+        {"Firebase", {}, {"firestore"}},
+        {"Supabase", {}, {}},
+        {"InfluxDB", {}, {}},
+        {"TimescaleDB", {}, {}},
+        {"HBase", {}, {}},
+        {"Hive", {"apache hive"}, {"hiveql"}},
+        {"Presto", {}, {}},
+        {"Trino", {}, {}},
+        {"Spark", {}, {"apache spark", "pyspark"}},
+        {"Hadoop", {}, {"hdfs", "mapreduce"}},
+        {"Flink", {}, {"apache flink"}},
+        {"Airflow", {}, {"apache airflow"}},
+        {"dbt", {}, {}},
+
+        // Data science and machine learning
+        {"Pandas", {}, {}},
+        {"NumPy", {}, {}},
+        {"SciPy", {}, {}},
+        {"scikit-learn", {}, {"sklearn"}},
+        {"TensorFlow", {}, {}},
+        {"PyTorch", {}, {}},
+        {"Keras", {}, {}},
+        {"JAX", {}, {}},
+        {"Hugging Face", {}, {"huggingface"}},
+        {"LangChain", {}, {}},
+        {"OpenCV", {}, {}},
+        {"XGBoost", {}, {}},
+        {"LightGBM", {}, {}},
+        {"MLflow", {}, {}},
+        {"Kubeflow", {}, {}},
+        {"Jupyter", {}, {"jupyter notebook"}},
+        {"Matplotlib", {}, {}},
+        {"Plotly", {}, {}},
+        {"Machine Learning", {}, {"ml"}},
+        {"Deep Learning", {}, {}},
+        {"LLM", {"llm", "llms"}, {"large language model", "large language models"}},
+        {"Computer Vision", {}, {}},
+        {"NLP", {"nlp"}, {"natural language processing"}},
+        {"Tableau", {}, {}},
+        {"Power BI", {}, {"powerbi"}},
+        {"Looker", {}, {}},
+        {"Excel", {}, {}},
+        {"SAS", {}, {}},
+        {"SPSS", {}, {}},
+        {"Stata", {}, {}},
+
+        // Cloud, infrastructure and DevOps
+        {"AWS", {}, {"amazon web services"}},
+        {"Azure", {}, {"microsoft azure"}},
+        {"GCP", {}, {"google cloud", "google cloud platform"}},
+        {"AWS Lambda", {}, {}},
+        {"EC2", {}, {}},
+        {"S3", {"amazon s3"}, {"s3"}},
+        {"EKS", {}, {}},
+        {"AKS", {}, {}},
+        {"GKE", {}, {}},
+        {"CloudFormation", {}, {}},
+        {"Serverless", {}, {}},
+        {"Docker", {}, {"dockerfile", "docker compose"}},
+        {"Kubernetes", {}, {"k8s"}},
+        {"OpenShift", {}, {}},
+        {"Helm", {}, {}},
+        {"Terraform", {}, {}},
+        {"Pulumi", {}, {}},
+        {"Ansible", {}, {}},
+        {"Chef", {"chef infra"}, {}},
+        {"Puppet", {}, {}},
+        {"SaltStack", {}, {}},
+        {"Vagrant", {}, {}},
+        {"Packer", {"hashicorp packer"}, {}},
+        {"Jenkins", {}, {}},
+        {"GitLab CI", {}, {"gitlab-ci"}},
+        {"GitHub Actions", {}, {}},
+        {"CircleCI", {}, {}},
+        {"Travis CI", {}, {}},
+        {"Argo CD", {}, {"argocd"}},
+        {"Spinnaker", {}, {}},
+        {"CI/CD", {}, {"continuous integration", "continuous delivery", "continuous deployment"}},
+        {"Prometheus", {}, {}},
+        {"Grafana", {}, {}},
+        {"Datadog", {}, {}},
+        {"New Relic", {}, {}},
+        {"Splunk", {}, {}},
+        {"Kibana", {}, {}},
+        {"Logstash", {}, {}},
+        {"Jaeger", {}, {}},
+        {"OpenTelemetry", {}, {}},
+        {"Istio", {}, {}},
+        {"Linkerd", {}, {}},
+        {"Envoy", {}, {}},
+        {"Consul", {}, {}},
+        {"Vault", {"hashicorp vault"}, {}},
+        {"Heroku", {}, {}},
+        {"Vercel", {}, {}},
+        {"Netlify", {}, {}},
+        {"Cloudflare", {}, {}},
+        {"DigitalOcean", {}, {}},
+        {"Linux", {}, {"ubuntu", "centos", "rhel", "debian"}},
+        {"Unix", {}, {}},
+        {"Git", {}, {"github", "gitlab", "bitbucket"}},
+        {"Jira", {}, {}},
+        {"Confluence", {}, {}},
+        {"Bazel", {}, {}},
+        {"CMake", {}, {}},
+        {"Maven", {}, {}},
+        {"Gradle", {}, {}},
+        {"npm", {}, {}},
+        {"Yarn", {}, {}},
+
+        // Testing
+        {"Selenium", {}, {}},
+        {"Cypress", {}, {}},
+        {"Playwright", {}, {}},
+        {"Jest", {}, {}},
+        {"Mocha", {}, {}},
+        {"JUnit", {}, {}},
+        {"pytest", {}, {}},
+        {"Cucumber", {}, {}},
+        {"Postman", {}, {}},
+        {"JMeter", {}, {}},
+        {"Appium", {}, {}},
+        {"TestNG", {}, {}},
+        {"GoogleTest", {}, {"gtest"}},
+
+        // Security and identity
+        {"OAuth", {}, {"oauth2"}},
+        {"JWT", {}, {}},
+        {"OWASP", {}, {}},
+        {"SAML", {}, {}},
+        {"Okta", {}, {}},
+
+        // Platforms and other tools
+        {"Salesforce", {}, {}},
+        {"SAP", {}, {"sap hana"}},
+        {"ServiceNow", {}, {}},
+        {"Shopify", {}, {}},
+        {"WordPress", {}, {}},
+        {"Drupal", {}, {}},
+        {"Magento", {}, {}},
+        {"Figma", {}, {}},
+        {"Blockchain", {}, {}},
+        {"Ethereum", {}, {}},
+        {"Web3", {}, {}},
+        {"Arduino", {}, {}},
+        {"Raspberry Pi", {}, {}},
+        {"ROS", {}, {"robot operating system"}},
+        {"FPGA", {}, {}},
+        {"XML", {}, {}},
+        {"JSON", {}, {}},
+        {"YAML", {}, {}},
+    };
+
+    return definitions;
+}
+
+TechnologyMatcher::TechnologyMatcher(const std::vector<TechnologyDefinition>& definitions) {
+    build(definitions);
+}
+
+TechnologyMatcher TechnologyMatcher::fromJsonFile(const std::string& path) {
+    std::ifstream file(path);
+
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open technology dictionary: " + path);
+    }
+
+    json data = json::parse(file);
+
+    if (!data.is_array()) {
+        throw std::runtime_error("Technology dictionary must be a JSON array: " + path);
+    }
+
+    std::vector<TechnologyDefinition> definitions;
+
+    for (const auto& entry : data) {
+        if (!entry.is_object() || !entry.contains("name")) {
+            continue;
+        }
+
+        TechnologyDefinition definition;
+        definition.name = entry["name"].get<std::string>();
+
+        if (entry.contains("keywords")) {
+            entry["keywords"].get_to(definition.keywords);
+        }
+
+        if (entry.contains("aliases")) {
+            entry["aliases"].get_to(definition.aliases);
+        }
+
+        definitions.push_back(std::move(definition));
+    }
+
+    return TechnologyMatcher(definitions);
+}
+
+void TechnologyMatcher::build(const std::vector<TechnologyDefinition>& definitions) {
+    struct Keyword {
+        std::string text;
+        int technology;
+        bool alias;
+    };
+
+    std::vector<Keyword> keywords;
+
+    for (const auto& definition : definitions) {
+        int technology = static_cast<int>(names.size());
+        names.push_back(definition.name);
+        name_ids.emplace(definition.name, technology);
+
+        if (definition.keywords.empty()) {
+            keywords.push_back({toLower(definition.name), technology, false});
+        }
+
+        for (const auto& keyword : definition.keywords) {
+            keywords.push_back({toLower(keyword), technology, false});
+        }
+
+        for (const auto& alias : definition.aliases) {
+            keywords.push_back({toLower(alias), technology, true});
+        }
+    }
+
+    // Alphabet: class 0 for bytes that never occur in a keyword.
+    std::fill(std::begin(byte_class), std::end(byte_class), 0);
+    class_count = 1;
+
+    for (const auto& keyword : keywords) {
+        for (unsigned char c : keyword.text) {
+            if (byte_class[c] == 0) {
+                std::uint16_t cls = static_cast<std::uint16_t>(class_count++);
+                byte_class[c] = cls;
+                byte_class[static_cast<unsigned char>(std::toupper(c))] = cls;
+            }
+        }
+    }
+
+    // Trie
+    transitions.assign(class_count, -1);
+    terminal.assign(1, -1);
+
+    for (const auto& keyword : keywords) {
+        if (keyword.text.empty()) {
+            continue;
+        }
+
+        std::int32_t node = 0;
+
+        for (unsigned char c : keyword.text) {
+            std::size_t slot = static_cast<std::size_t>(node) * class_count + byte_class[c];
+
+            if (transitions[slot] < 0) {
+                transitions[slot] = static_cast<std::int32_t>(terminal.size());
+                terminal.push_back(-1);
+                transitions.resize(transitions.size() + class_count, -1);
+            }
+
+            node = transitions[slot];
+        }
+
+        Pattern pattern;
+        pattern.technology = keyword.technology;
+        pattern.length = static_cast<std::uint32_t>(keyword.text.size());
+        pattern.alias = keyword.alias;
+        pattern.check_left = technology_matcher_detail::isWordByte(
+            static_cast<unsigned char>(keyword.text.front()));
+        pattern.check_right = technology_matcher_detail::isWordByte(
+            static_cast<unsigned char>(keyword.text.back()));
+        pattern.next = terminal[node];
+
+        terminal[node] = static_cast<std::int32_t>(patterns.size());
+        patterns.push_back(pattern);
+    }
+
+    // Breadth-first pass turning the trie into a DFA: missing transitions are
+    // filled from the failure state, and dictionary links point at the
+    // nearest proper suffix that ends a keyword.
+    std::size_t node_count = terminal.size();
+    std::vector<std::int32_t> failure(node_count, 0);
+    dictionary_link.assign(node_count, 0);
+
+    std::queue<std::int32_t> pending;
+
+    for (std::size_t cls = 0; cls < class_count; cls++) {
+        std::int32_t& next = transitions[cls];
+
+        if (next < 0) {
+            next = 0;
+        } else {
+            pending.push(next);
+        }
+    }
+
+    while (!pending.empty()) {
+        std::int32_t node = pending.front();
+        pending.pop();
+
+        std::size_t base = static_cast<std::size_t>(node) * class_count;
+
+        for (std::size_t cls = 0; cls < class_count; cls++) {
+            std::int32_t child = transitions[base + cls];
+            std::int32_t fallback =
+                transitions[static_cast<std::size_t>(failure[node]) * class_count + cls];
+
+            if (child < 0) {
+                transitions[base + cls] = fallback;
+                continue;
+            }
+
+            failure[child] = fallback;
+            dictionary_link[child] = terminal[fallback] >= 0 ? fallback : dictionary_link[fallback];
+            pending.push(child);
+        }
+    }
+}
+
+std::vector<int> TechnologyMatcher::findIds(std::string_view text, bool include_aliases) const {
+    std::vector<int> ids;
+
+    forEachMatch(text, include_aliases, [&](int technology) {
+        ids.push_back(technology);
+    });
+
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+std::vector<std::string> TechnologyMatcher::findNames(std::string_view text, bool include_aliases) const {
+    std::vector<std::string> result;
+
+    for (int technology : findIds(text, include_aliases)) {
+        result.push_back(names[static_cast<std::size_t>(technology)]);
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
@@ -0,0 +1,137 @@
+#ifndef TECHNOLOGYMATCHER_H
+#define TECHNOLOGYMATCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// One entry of the technology dictionary. `keywords` are the spellings of the
+// name itself (defaulting to the lowercased name); `aliases` are alternative
+// spellings such as "k8s" that only alias-aware lookups report.
+struct TechnologyDefinition {
+    std::string name;
+    std::vector<std::string> keywords;
+    std::vector<std::string> aliases;
+};
+
+// Aho-Corasick automaton over a technology dictionary. All keywords are found
+// in a single pass over the text, folding ASCII case on the fly, and a hit
+// only counts on word boundaries so "java" does not match inside "javascript".
+class TechnologyMatcher {
+private:
+    struct Pattern {
+        int technology;
+        std::uint32_t length;
+        bool alias;
+        bool check_left;
+        bool check_right;
+        int next;
+    };
+
+    std::vector<std::string> names;
+    std::unordered_map<std::string, int> name_ids;
+    std::vector<Pattern> patterns;
+
+    // Bytes are mapped to a small alphabet of the characters that occur in
+    // some keyword (case-folded); everything else shares class 0. Wider
+    // than a byte so the class count never wraps, whatever the dictionary
+    // and the case folding leave.
+    std::uint16_t byte_class[256];
+    std::size_t class_count;
+
+    // Full DFA: transitions[node * class_count + class].
+    std::vector<std::int32_t> transitions;
+    std::vector<std::int32_t> terminal;
+    std::vector<std::int32_t> dictionary_link;
+
+    void build(const std::vector<TechnologyDefinition>& definitions);
+
+public:
+    explicit TechnologyMatcher(const std::vector<TechnologyDefinition>& definitions);
+
+    // Reads [{"name": ..., "keywords": [...], "aliases": [...]}, ...].
+    // Throws std::runtime_error if the file cannot be read or parsed.
+    static TechnologyMatcher fromJsonFile(const std::string& path);
+
+    static const std::vector<TechnologyDefinition>& defaultDefinitions();
+
+    std::size_t size() const {
+        return names.size();
+    }
+
+    const std::string& name(int technology) const {
+        return names[static_cast<std::size_t>(technology)];
+    }
+
+    // Id of the technology called exactly `name`, or -1.
+    int id(const std::string& name) const {
+        auto it = name_ids.find(name);
+        return it == name_ids.end() ? -1 : it->second;
+    }
+
+    // Calls on_match(technology_id) for every boundary-respecting hit, in
+    // text order. Ids may repeat.
+    template<typename Callback>
+    void forEachMatch(std::string_view text, bool include_aliases, Callback&& on_match) const;
+
+    // Sorted, de-duplicated technology ids found in `text`.
+    std::vector<int> findIds(std::string_view text, bool include_aliases = true) const;
+
+    // Names of the technologies found in `text`, sorted alphabetically.
+    std::vector<std::string> findNames(std::string_view text, bool include_aliases = true) const;
+};
+
+namespace technology_matcher_detail {
+
+inline bool isWordByte(unsigned char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+} // namespace technology_matcher_detail
+
+template<typename Callback>
+void TechnologyMatcher::forEachMatch(std::string_view text,
+                                     bool include_aliases,
+                                     Callback&& on_match) const {
+    using technology_matcher_detail::isWordByte;
+
+    const std::size_t n = text.size();
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(text.data());
+    std::int32_t state = 0;
+
+    for (std::size_t i = 0; i < n; i++) {
+        state = transitions[static_cast<std::size_t>(state) * class_count + byte_class[bytes[i]]];
+
+        std::int32_t node = terminal[state] >= 0 ? state : dictionary_link[state];
+
+        for (; node > 0; node = dictionary_link[node]) {
+            for (int p = terminal[node]; p >= 0; p = patterns[p].next) {
+                const Pattern& pattern = patterns[p];
+
+                if (pattern.alias && !include_aliases) {
+                    continue;
+                }
+
+                std::size_t start = i + 1 - pattern.length;
+
+                if (pattern.check_left && start > 0 && isWordByte(bytes[start - 1])) {
+                    continue;
+                }
+
+                // A trailing '+' or '#' extends the word too, so "c" does not
+                // match "c++" or "c#".
+                if (pattern.check_right && i + 1 < n &&
+                    (isWordByte(bytes[i + 1]) || bytes[i + 1] == '+' || bytes[i + 1] == '#')) {
+                    continue;
+                }
+
+                on_match(pattern.technology);
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,181 @@
+#include "TextSearch.h"
+
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define TEXTSEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+inline unsigned char foldByte(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c | 0x20) : c;
+}
+
+// Compares needle[1..m-1) against the haystack candidate; the first and last
+// bytes were already matched by the caller.
+inline bool middleMatches(const unsigned char* candidate, const unsigned char* needle, std::size_t m) {
+    for (std::size_t k = 1; k + 1 < m; k++) {
+        if (foldByte(candidate[k]) != foldByte(needle[k])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::size_t scalarFrom(const unsigned char* h, std::size_t n,
+                       const unsigned char* needle, std::size_t m,
+                       std::size_t start) {
+    unsigned char first = foldByte(needle[0]);
+    unsigned char last = foldByte(needle[m - 1]);
+
+    for (std::size_t i = start; i + m <= n; i++) {
+        if (foldByte(h[i]) == first && foldByte(h[i + m - 1]) == last &&
+            middleMatches(h + i, needle, m)) {
+            return i;
+        }
+    }
+
+    return TextSearch::npos;
+}
+
+#ifdef TEXTSEARCH_X86
+
+// Lowercases A-Z in a vector of bytes. Bytes >= 0x80 compare as negative and
+// are left alone.
+inline __m128i foldSse2(__m128i x) {
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8('A' - 1)),
+                                  _mm_cmplt_epi8(x, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(x, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+std::size_t findSse2(const unsigned char* h, std::size_t n,
+                     const unsigned char* needle, std::size_t m) {
+    const __m128i first = _mm_set1_epi8(static_cast<char>(foldByte(needle[0])));
+    const __m128i last = _mm_set1_epi8(static_cast<char>(foldByte(needle[m - 1])));
+
+    std::size_t i = 0;
+
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        __m128i block_first = foldSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i)));
+        __m128i block_last = foldSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i + m - 1)));
+
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last))));
+
+        while (mask != 0) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+
+            if (middleMatches(h + i + bit, needle, m)) {
+                return i + bit;
+            }
+
+            mask &= mask - 1;
+        }
+    }
+
+    return scalarFrom(h, n, needle, m, i);
+}
+
+__attribute__((target("avx2")))
+inline __m256i foldAvx2(__m256i x) {
+    __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8('A' - 1)),
+                                     _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), x));
+    return _mm256_or_si256(x, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+__attribute__((target("avx2")))
+std::size_t findAvx2(const unsigned char* h, std::size_t n,
+                     const unsigned char* needle, std::size_t m) {
+    const __m256i first = _mm256_set1_epi8(static_cast<char>(foldByte(needle[0])));
+    const __m256i last = _mm256_set1_epi8(static_cast<char>(foldByte(needle[m - 1])));
+
+    std::size_t i = 0;
+
+    for (; i + m - 1 + 32 <= n; i += 32) {
+        __m256i block_first = foldAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i)));
+        __m256i block_last = foldAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i + m - 1)));
+
+        std::uint32_t mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first),
+                             _mm256_cmpeq_epi8(block_last, last))));
+
+        while (mask != 0) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+
+            if (middleMatches(h + i + bit, needle, m)) {
+                return i + bit;
+            }
+
+            mask &= mask - 1;
+        }
+    }
+
+    // Finish the tail 16 bytes at a time before dropping to scalar.
+    std::size_t rest = findSse2(h + i, n - i, needle, m);
+    return rest == TextSearch::npos ? rest : i + rest;
+}
+
+#endif
+
+using Kernel = std::size_t (*)(const unsigned char*, std::size_t, const unsigned char*, std::size_t);
+
+struct Dispatch {
+    Kernel kernel;
+    const char* name;
+};
+
+Dispatch selectKernel() {
+#ifdef TEXTSEARCH_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) {
+        return {findAvx2, "avx2"};
+    }
+
+    return {findSse2, "sse2"};
+#else
+    return {[](const unsigned char* h, std::size_t n, const unsigned char* needle, std::size_t m) {
+                return scalarFrom(h, n, needle, m, 0);
+            },
+            "scalar"};
+#endif
+}
+
+const Dispatch& dispatch() {
+    static const Dispatch selected = selectKernel();
+    return selected;
+}
+
+} // namespace
+
+std::size_t TextSearch::findIgnoreCase(std::string_view haystack, std::string_view needle) {
+    if (needle.empty()) {
+        return 0;
+    }
+
+    if (needle.size() > haystack.size()) {
+        return npos;
+    }
+
+    return dispatch().kernel(reinterpret_cast<const unsigned char*>(haystack.data()), haystack.size(),
+                             reinterpret_cast<const unsigned char*>(needle.data()), needle.size());
+}
+
+std::size_t TextSearch::findIgnoreCaseScalar(std::string_view haystack, std::string_view needle) {
+    if (needle.empty()) {
+        return 0;
+    }
+
+    if (needle.size() > haystack.size()) {
+        return npos;
+    }
+
+    return scalarFrom(reinterpret_cast<const unsigned char*>(haystack.data()), haystack.size(),
+                      reinterpret_cast<const unsigned char*>(needle.data()), needle.size(), 0);
+}
+
+const char* TextSearch::implementationName() {
+    return dispatch().name;
+}
@@ -0,0 +1,29 @@
+#ifndef TEXTSEARCH_H
+#define TEXTSEARCH_H
+
+#include <cstddef>
+#include <string_view>
+
+// ASCII case-insensitive substring search that works on the original bytes,
+// with no lowercased copy of either string. On x86 the kernel compares 16
+// (SSE2) or 32 (AVX2) candidate positions per step, picked once at runtime
+// from the CPU's features; other targets use a scalar loop.
+class TextSearch {
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    // Offset of the first case-insensitive occurrence of `needle`, or npos.
+    static std::size_t findIgnoreCase(std::string_view haystack, std::string_view needle);
+
+    static bool containsIgnoreCase(std::string_view haystack, std::string_view needle) {
+        return findIgnoreCase(haystack, needle) != npos;
+    }
+
+    // "avx2", "sse2" or "scalar".
+    static const char* implementationName();
+
+    // Reference implementation, exposed for comparison.
+    static std::size_t findIgnoreCaseScalar(std::string_view haystack, std::string_view needle);
+};
+
+#endif
@@ -0,0 +1,122 @@
+#include "ThreadPool.h"
+
+namespace {
+
+// Set on worker threads so that tasks submitted from inside a task land on
+// the submitting worker's own queue.
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local std::size_t current_index = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(std::size_t threads)
+    : queued(0), stopping(false), next_queue(0) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (std::size_t i = 0; i < threads; i++) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    for (std::size_t i = 0; i < threads; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        stopping = true;
+    }
+
+    wake.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+std::size_t ThreadPool::currentQueue() {
+    if (current_pool == this) {
+        return current_index;
+    }
+
+    return next_queue.fetch_add(1) % queues.size();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    WorkerQueue& queue = *queues[currentQueue()];
+
+    // Counted before it is visible, so a thief can never take the count
+    // below zero.
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        queued++;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    wake.notify_one();
+}
+
+bool ThreadPool::runOne(std::size_t home) {
+    std::function<void()> task;
+
+    // Own queue from the back (most recent, still warm in cache), the others
+    // from the front.
+    for (std::size_t i = 0; i < queues.size() && !task; i++) {
+        WorkerQueue& queue = *queues[(home + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.tasks.empty()) {
+            continue;
+        }
+
+        if (i == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+
+    if (!task) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        queued--;
+    }
+
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(std::size_t index) {
+    current_pool = this;
+    current_index = index;
+
+    while (true) {
+        if (runOne(index)) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        wake.wait(lock, [this]() { return stopping || queued > 0; });
+
+        if (stopping && queued == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,133 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each with its own task deque. A worker takes
+// its newest task first and, when it runs dry, steals the oldest task of
+// another worker, so uneven chunks still keep every core busy.
+class ThreadPool {
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    std::size_t queued;
+    bool stopping;
+
+    std::atomic<std::size_t> next_queue;
+
+    void workerLoop(std::size_t index);
+
+    // Runs one queued task, preferring queue `home`. Returns false if every
+    // queue was empty.
+    bool runOne(std::size_t home);
+
+    // Queue of the calling thread if it is one of our workers.
+    std::size_t currentQueue();
+
+public:
+    // 0 means one worker per hardware thread.
+    explicit ThreadPool(std::size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const {
+        return workers.size();
+    }
+
+    void submit(std::function<void()> task);
+
+    // Splits [0, count) into chunks of `chunk_size` and calls
+    // fn(chunk, begin, end) for each, in parallel. Chunk boundaries depend
+    // only on `count` and `chunk_size`, never on the thread count, so a
+    // caller that merges per-chunk results in chunk order gets the same
+    // answer on every machine. The calling thread helps until all chunks are
+    // done; the first exception thrown by `fn` is rethrown here.
+    template<typename Fn>
+    void parallelFor(std::size_t count, std::size_t chunk_size, Fn&& fn);
+
+    // Process-wide pool sized to the hardware.
+    static ThreadPool& shared();
+};
+
+template<typename Fn>
+void ThreadPool::parallelFor(std::size_t count, std::size_t chunk_size, Fn&& fn) {
+    if (chunk_size == 0) {
+        chunk_size = 1;
+    }
+
+    const std::size_t chunks = (count + chunk_size - 1) / chunk_size;
+
+    if (chunks <= 1 || workers.empty()) {
+        for (std::size_t chunk = 0; chunk < chunks; chunk++) {
+            fn(chunk, chunk * chunk_size, std::min(count, (chunk + 1) * chunk_size));
+        }
+        return;
+    }
+
+    struct State {
+        std::atomic<std::size_t> remaining;
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+
+    auto state = std::make_shared<State>();
+    state->remaining = chunks;
+
+    for (std::size_t chunk = 0; chunk < chunks; chunk++) {
+        submit([state, &fn, chunk, chunk_size, count]() {
+            try {
+                fn(chunk, chunk * chunk_size, std::min(count, (chunk + 1) * chunk_size));
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->error) {
+                    state->error = std::current_exception();
+                }
+            }
+
+            if (state->remaining.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->done.notify_all();
+            }
+        });
+    }
+
+    // Help out rather than block; this also keeps a parallelFor issued from
+    // inside a worker from deadlocking. Once nothing is queued, every chunk
+    // has been picked up and it only remains to wait for the stragglers.
+    const std::size_t home = currentQueue();
+
+    while (state->remaining.load() > 0 && runOne(home)) {
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait(lock, [&]() { return state->remaining.load() == 0; });
+    }
+
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+#endif
@@ -0,0 +1,296 @@
+#include "TopK.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Count-Min dimensions: estimates within e / 2048 (0.13%) of the stream
+// total, except with probability e^-4 (under 2%). Fixed, so any two
+// summaries can merge.
+constexpr std::size_t kSketchWidth = 2048;
+constexpr std::size_t kSketchDepth = 4;
+
+bool largerFirst(const TopK::Entry& a, const TopK::Entry& b) {
+    return a.count > b.count || (a.count == b.count && a.key < b.key);
+}
+
+} // namespace
+
+TopK::TopK(std::size_t requested_capacity)
+    : capacity(std::max<std::size_t>(requested_capacity, 1)),
+      evicted(false),
+      unmonitored_bound(0),
+      total_count(0) {
+    // At most half full, so probe runs stay short.
+    std::size_t slot_count = 1;
+
+    while (slot_count < capacity * 2) {
+        slot_count <<= 1;
+    }
+
+    slots.assign(slot_count, 0);
+}
+
+std::uint64_t TopK::hash(std::string_view key) {
+    // FNV-1a, then MurmurHash3's finalizer: slots and the sketch index by
+    // the low bits, which FNV alone mixes poorly.
+    std::uint64_t h = 1469598103934665603ULL;
+
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+std::size_t TopK::findSlot(std::string_view key, std::uint64_t key_hash) const {
+    std::size_t mask = slots.size() - 1;
+    std::size_t slot = static_cast<std::size_t>(key_hash) & mask;
+
+    while (slots[slot] != 0) {
+        const Counter& counter = counters[slots[slot] - 1];
+
+        if (counter.hash == key_hash && counter.key == key) {
+            break;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+void TopK::eraseSlot(std::size_t slot) {
+    // Backward-shift deletion: pull later entries of the probe run into the
+    // hole when that keeps them reachable from their home slot.
+    std::size_t mask = slots.size() - 1;
+    std::size_t hole = slot;
+    slots[hole] = 0;
+
+    for (std::size_t next = (hole + 1) & mask; slots[next] != 0; next = (next + 1) & mask) {
+        std::size_t home = static_cast<std::size_t>(counters[slots[next] - 1].hash) & mask;
+
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            slots[hole] = slots[next];
+            slots[next] = 0;
+            hole = next;
+        }
+    }
+}
+
+void TopK::swapHeap(std::size_t a, std::size_t b) {
+    std::swap(heap[a], heap[b]);
+    heap_position[heap[a]] = static_cast<std::uint32_t>(a);
+    heap_position[heap[b]] = static_cast<std::uint32_t>(b);
+}
+
+void TopK::siftUp(std::size_t position) {
+    while (position > 0) {
+        std::size_t parent = (position - 1) / 2;
+
+        if (counters[heap[parent]].count <= counters[heap[position]].count) {
+            break;
+        }
+
+        swapHeap(parent, position);
+        position = parent;
+    }
+}
+
+void TopK::siftDown(std::size_t position) {
+    for (;;) {
+        std::size_t smallest = position;
+        std::size_t left = position * 2 + 1;
+        std::size_t right = left + 1;
+
+        if (left < heap.size() && counters[heap[left]].count < counters[heap[smallest]].count) {
+            smallest = left;
+        }
+
+        if (right < heap.size() && counters[heap[right]].count < counters[heap[smallest]].count) {
+            smallest = right;
+        }
+
+        if (smallest == position) {
+            return;
+        }
+
+        swapHeap(position, smallest);
+        position = smallest;
+    }
+}
+
+void TopK::insertCounter(Counter counter) {
+    std::uint32_t index = static_cast<std::uint32_t>(counters.size());
+
+    slots[findSlot(counter.key, counter.hash)] = index + 1;
+    counters.push_back(std::move(counter));
+    heap.push_back(index);
+    heap_position.push_back(static_cast<std::uint32_t>(heap.size() - 1));
+    siftUp(heap.size() - 1);
+}
+
+void TopK::startSketch() {
+    // Until now every count was exact, so the sketch can start from them.
+    sketch = CountMinSketch(kSketchWidth, kSketchDepth);
+
+    for (const auto& counter : counters) {
+        sketch.add(counter.hash, counter.count);
+    }
+}
+
+void TopK::add(std::string_view key, std::uint64_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    total_count += count;
+
+    std::uint64_t key_hash = hash(key);
+    std::size_t slot = findSlot(key, key_hash);
+
+    if (!sketch.empty()) {
+        sketch.add(key_hash, count);
+    }
+
+    if (slots[slot] != 0) {
+        std::uint32_t index = slots[slot] - 1;
+        counters[index].count += count;
+        siftDown(heap_position[index]);
+        return;
+    }
+
+    if (counters.size() < capacity) {
+        insertCounter(Counter{std::string(key), key_hash, count, 0});
+        return;
+    }
+
+    if (!evicted) {
+        startSketch();
+        sketch.add(key_hash, count);
+        evicted = true;
+    }
+
+    // Take over the least counted key's counter. The new key's earlier
+    // occurrences are bounded by every count evicted so far (not just this
+    // one: a sketch-capped counter can sit below an older eviction) and by
+    // the sketch; keep the tighter bound.
+    std::uint32_t index = heap[0];
+    Counter& counter = counters[index];
+
+    unmonitored_bound = std::max(unmonitored_bound, counter.count);
+    eraseSlot(findSlot(counter.key, counter.hash));
+
+    std::uint64_t estimate = std::min(unmonitored_bound + count, sketch.estimate(key_hash));
+
+    counter.key.assign(key.data(), key.size());
+    counter.hash = key_hash;
+    counter.count = estimate;
+    counter.error = estimate - count;
+
+    slots[findSlot(key, key_hash)] = index + 1;
+    siftDown(0);
+}
+
+void TopK::merge(const TopK& other) {
+    if (other.total_count == 0) {
+        return;
+    }
+
+    // A key missing from one summary occurred there at most that summary's
+    // unmonitored bound times (never, if it evicted nothing).
+    std::vector<Entry> merged;
+    merged.reserve(counters.size() + other.counters.size());
+
+    for (const auto& counter : counters) {
+        std::size_t slot = other.findSlot(counter.key, counter.hash);
+        std::uint64_t count = other.unmonitored_bound;
+        std::uint64_t error = other.unmonitored_bound;
+
+        if (other.slots[slot] != 0) {
+            const Counter& match = other.counters[other.slots[slot] - 1];
+            count = match.count;
+            error = match.error;
+        }
+
+        merged.push_back(Entry{counter.key, counter.count + count, counter.error + error});
+    }
+
+    for (const auto& counter : other.counters) {
+        if (slots[findSlot(counter.key, counter.hash)] == 0) {
+            merged.push_back(Entry{counter.key,
+                                   counter.count + unmonitored_bound,
+                                   counter.error + unmonitored_bound});
+        }
+    }
+
+    bool approximate = evicted || other.evicted || merged.size() > capacity;
+
+    if (approximate) {
+        if (sketch.empty()) {
+            startSketch();
+        }
+
+        if (other.sketch.empty()) {
+            for (const auto& counter : other.counters) {
+                sketch.add(counter.hash, counter.count);
+            }
+        } else {
+            sketch.merge(other.sketch);
+        }
+
+        // The merged sketch bounds every count too; tightening a count
+        // leaves its lower bound (count - error) where it was.
+        for (auto& entry : merged) {
+            std::uint64_t lower = entry.count - entry.error;
+            entry.count = std::min(entry.count, sketch.estimate(hash(entry.key)));
+            entry.error = entry.count - lower;
+        }
+    }
+
+    std::sort(merged.begin(), merged.end(), largerFirst);
+
+    std::uint64_t bound = unmonitored_bound + other.unmonitored_bound;
+
+    if (merged.size() > capacity) {
+        bound = std::max(bound, merged[capacity].count);
+        merged.resize(capacity);
+    }
+
+    counters.clear();
+    heap.clear();
+    heap_position.clear();
+    std::fill(slots.begin(), slots.end(), 0);
+
+    for (auto& entry : merged) {
+        std::uint64_t key_hash = hash(entry.key);
+        insertCounter(Counter{std::move(entry.key), key_hash, entry.count, entry.error});
+    }
+
+    evicted = approximate;
+    unmonitored_bound = bound;
+    total_count += other.total_count;
+}
+
+std::vector<TopK::Entry> TopK::top(std::size_t k) const {
+    std::vector<Entry> entries;
+    entries.reserve(counters.size());
+
+    for (const auto& counter : counters) {
+        entries.push_back(Entry{counter.key, counter.count, counter.error});
+    }
+
+    std::size_t keep = std::min(k, entries.size());
+    std::partial_sort(entries.begin(), entries.begin() + static_cast<std::ptrdiff_t>(keep), entries.end(), largerFirst);
+    entries.resize(keep);
+
+    return entries;
+}
@@ -0,0 +1,96 @@
+#ifndef TOPK_H
+#define TOPK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CountMinSketch.h"
+
+// The most frequent keys of a stream (companies, locations, technologies)
+// in memory bounded by `capacity`, however long the stream runs.
+//
+// Up to `capacity` distinct keys are counted exactly. Past that it runs
+// Space-Saving: a new key takes over the counter of the least counted one,
+// so every count becomes an upper bound and any key frequent enough stays
+// monitored. From that first eviction on, a Count-Min sketch (seeded with
+// the exact counts) also tracks the stream, and a returning key starts at
+// the sketch's estimate when that is lower than the evicted count.
+//
+// Summaries of separate streams merge into one for their union.
+class TopK {
+public:
+    struct Entry {
+        std::string key;
+        std::uint64_t count;   // never below the true count
+        std::uint64_t error;   // count - error is never above it
+    };
+
+    static constexpr std::size_t kDefaultCapacity = 1024;
+
+private:
+    struct Counter {
+        std::string key;
+        std::uint64_t hash;
+        std::uint64_t count;
+        std::uint64_t error;
+    };
+
+    std::size_t capacity;
+    std::vector<Counter> counters;
+
+    // Min-heap of counter indices by count, and each counter's place in it.
+    std::vector<std::uint32_t> heap;
+    std::vector<std::uint32_t> heap_position;
+
+    // Open addressing over key hashes, linear probing: counter index + 1,
+    // or 0 for an empty slot.
+    std::vector<std::uint32_t> slots;
+
+    CountMinSketch sketch;
+    bool evicted;
+
+    // The true count of any key not monitored is at most this.
+    std::uint64_t unmonitored_bound;
+    std::uint64_t total_count;
+
+    static std::uint64_t hash(std::string_view key);
+
+    // The slot holding `key`, or the empty slot where it would go.
+    std::size_t findSlot(std::string_view key, std::uint64_t key_hash) const;
+    void eraseSlot(std::size_t slot);
+
+    void siftUp(std::size_t position);
+    void siftDown(std::size_t position);
+    void swapHeap(std::size_t a, std::size_t b);
+
+    void insertCounter(Counter counter);
+    void startSketch();
+
+public:
+    explicit TopK(std::size_t capacity = kDefaultCapacity);
+
+    void add(std::string_view key, std::uint64_t count = 1);
+    void merge(const TopK& other);
+
+    // The `k` largest counts, largest first and ties by key.
+    std::vector<Entry> top(std::size_t k) const;
+
+    // True while no key has been evicted: all counts are exact.
+    bool exact() const {
+        return !evicted;
+    }
+
+    std::uint64_t total() const {
+        return total_count;
+    }
+
+    // Keys currently monitored.
+    std::size_t size() const {
+        return counters.size();
+    }
+};
+
+#endif
@@ -1,12 +1,17 @@
+#include <chrono>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
-#include <map>
 #include <string>
 #include <vector>
 
 #include "JobParser.h"
+#include "JobQuery.h"
+#include "JobStore.h"
+#include "SalarySketch.h"
 #include "ApiClient.h"
+#include "ThreadPool.h"
+#include "TopK.h"
 #include "json.hpp"
 
 using json = nlohmann::json;
@@ -27,45 +32,104 @@ void displayJob(const Job& job) {
     std::cout << "----------------------------------------\n";
 }
 
-void displayStatistics(const std::vector<Job>& jobs) {
-    if (jobs.empty()) {
+void printStatistics(std::size_t total_jobs,
+                     const TopK& companies,
+                     const SalarySketch& salaries) {
+    std::cout << "\n=== JOB MARKET STATISTICS ===\n";
+    std::cout << "Total jobs found: " << total_jobs << '\n';
+
+    std::cout << "\nTop companies:\n";
+
+    // Past TopK's capacity counts are upper bounds; say so.
+    const char* about = companies.exact() ? "" : "~";
+
+    for (const auto& company : companies.top(5)) {
+        std::cout << "  " << company.key << ": " << about << company.count << " job(s)\n";
+    }
+
+    if (!salaries.empty()) {
+        std::cout << std::fixed << std::setprecision(0);
+        std::cout << "Average minimum salary: $" << salaries.mean()
+                  << " (std dev $" << salaries.stddev() << ")\n";
+        std::cout << "Median minimum salary: $" << salaries.quantile(0.5) << '\n';
+        std::cout << "Middle 80%: $" << salaries.quantile(0.1)
+                  << " - $" << salaries.quantile(0.9) << '\n';
+    }
+}
+
+void displayStatistics(const JobStore& store) {
+    if (store.empty()) {
         std::cout << "No jobs found.\n";
         return;
     }
 
-    std::cout << "\n=== JOB MARKET STATISTICS ===\n";
-    std::cout << "Total jobs found: " << jobs.size() << '\n';
+    const StringInterner& company_names = store.companyNames();
+    TopK companies;
+    SalarySketch salaries;
 
-    std::map<std::string, int> company_counts;
-    double total_salary = 0.0;
-    int salary_count = 0;
+    for (std::size_t i = 0; i < store.size(); i++) {
+        const std::string& company = company_names.str(store.companyId(i));
 
-    for (const auto& job : jobs) {
-        if (!job.company.display_name.empty()) {
-            company_counts[job.company.display_name]++;
+        if (!company.empty()) {
+            companies.add(company);
         }
+    }
 
-        if (job.salary_min > 0) {
-            total_salary += job.salary_min;
-            salary_count++;
+    for (double salary : store.salaryMins()) {
+        if (salary > 0) {
+            salaries.add(salary);
         }
     }
 
-    std::cout << "\nCompanies found:\n";
-    int shown = 0;
+    printStatistics(store.size(), companies, salaries);
+}
 
-    for (const auto& [company, count] : company_counts) {
-        if (shown >= 5) break;
+void displayStatistics(const std::vector<Job>& jobs) {
+    displayStatistics(JobStore(jobs));
+}
 
-        std::cout << "  " << company << ": " << count << " job(s)\n";
-        shown++;
+// Per-chunk company and salary summaries, merged in chunk order so the
+// results do not depend on scheduling.
+void displayStatistics(const std::vector<Job>& jobs, ThreadPool& pool) {
+    if (jobs.empty()) {
+        std::cout << "No jobs found.\n";
+        return;
     }
 
-    if (salary_count > 0) {
-        std::cout << "Average minimum salary: $"
-                  << std::fixed << std::setprecision(0)
-                  << total_salary / salary_count << '\n';
+    struct Partial {
+        TopK companies;
+        SalarySketch salaries;
+    };
+
+    const std::size_t chunk_size = 4096;
+    std::vector<Partial> partials((jobs.size() + chunk_size - 1) / chunk_size);
+
+    pool.parallelFor(jobs.size(), chunk_size,
+                     [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+        Partial& partial = partials[chunk];
+
+        for (std::size_t i = begin; i < end; i++) {
+            const Job& job = jobs[i];
+
+            if (!job.company.display_name.empty()) {
+                partial.companies.add(job.company.display_name);
+            }
+
+            if (job.salary_min > 0) {
+                partial.salaries.add(job.salary_min);
+            }
+        }
+    });
+
+    TopK companies;
+    SalarySketch salaries;
+
+    for (const auto& partial : partials) {
+        companies.merge(partial.companies);
+        salaries.merge(partial.salaries);
     }
+
+    printStatistics(jobs.size(), companies, salaries);
 }
 
 int main() {
@@ -99,6 +163,22 @@ int main() {
 
     ApiClient client(app_id, app_key);
 
+    // Repeated searches are answered from disk until the TTL runs out; an
+    // empty "response_cache_dir" turns the cache off.
+    std::string cache_dir = config.value("response_cache_dir", ".cache/adzuna");
+    int cache_ttl = config.value("response_cache_ttl_seconds", 900);
+
+    if (!cache_dir.empty()) {
+        client.enableResponseCache(cache_dir, std::chrono::seconds(cache_ttl));
+    }
+
+    // Keep under the account's quota; 0 leaves requests unthrottled.
+    double requests_per_second = config.value("requests_per_second", 0.0);
+
+    if (requests_per_second > 0) {
+        client.setRateLimit(requests_per_second);
+    }
+
     std::string query;
     std::string location;
     std::string salary_input;
@@ -157,19 +237,39 @@ int main() {
 
     std::cout << "\nSearching jobs...\n";
 
-    std::vector<Job> jobs = client.searchJobs(query, location, min_salary, max_pages);
+    std::vector<HttpResponse> responses;
+    std::vector<Job> jobs = client.searchJobs(query, location, min_salary, max_pages, &responses);
+
+    if (!responses.empty() && !responses.back().ok()) {
+        std::cout << "Warning: page " << responses.back().page
+                  << " could not be fetched; results may be incomplete.\n";
+    }
+
+    // Results are views into `jobs`; nothing below copies a Job.
+    JobQuery results(jobs);
 
     if (remote_only == "y" || remote_only == "Y") {
-        jobs = JobParser::filterRemoteJobs(jobs);
+        results = results.remote();
     }
 
+    ThreadPool pool;
+    std::vector<std::size_t> shown = results.indices(pool);
+
     std::cout << "\n=== SEARCH RESULTS ===\n";
 
-    for (const auto& job : jobs) {
-        displayJob(job);
+    for (std::size_t i : shown) {
+        displayJob(jobs[i]);
+    }
+
+    // Keep only the jobs shown, in order, by moving them forward.
+    for (std::size_t k = 0; k < shown.size(); k++) {
+        if (shown[k] != k) {
+            jobs[k] = std::move(jobs[shown[k]]);
+        }
     }
 
-    displayStatistics(jobs);
+    jobs.resize(shown.size());
+    displayStatistics(jobs, pool);
 
     return 0;
 }
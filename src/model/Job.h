@@ -1,6 +1,7 @@
 #ifndef JOB_H
 #define JOB_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -20,11 +21,23 @@ struct Job {
     std::string description;
     std::string redirect_url;
     std::vector<std::string> technologies;
+    std::string category;
     std::string created;
 
+    // MinHash::signature of the job; empty until computed at ingest.
+    std::vector<std::uint32_t> minhash;
+
+    // SimHash::fingerprint of the job; 0 until computed at ingest.
+    std::uint64_t simhash;
+
+    // Id of the earlier posting this one near-duplicates, if it was flagged
+    // as a repost.
+    std::string duplicate_of;
+
     Job()
         : salary_min(0.0),
-          salary_max(0.0) {}
+          salary_max(0.0),
+          simhash(0) {}
 
     bool isValid() const {
         return !title.empty() && company.isValid();
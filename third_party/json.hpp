@@ -1,104 +1,931 @@
-// third_party/json.hpp - Basic functional version
+// third_party/json.hpp - Compact subset of the nlohmann/json API
+//
+// Provides the parts of nlohmann::json this project uses: a DOM value type,
+// a strict RFC 8259 parser, serialization via dump(), and SAX parsing through
+// nlohmann::json_sax so callers can consume documents without building a DOM.
 #ifndef NLOHMANN_JSON_HPP
 #define NLOHMANN_JSON_HPP
 
+#include <cerrno>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <istream>
+#include <iterator>
 #include <map>
-#include <vector>
-#include <string>
+#include <ostream>
 #include <stdexcept>
-#include <iostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace nlohmann {
 
-class json {
+namespace detail {
+
+class exception : public std::exception {
+public:
+    const int id;
+
+    const char* what() const noexcept override {
+        return m.what();
+    }
+
+protected:
+    exception(int id_, const std::string& what_arg)
+        : id(id_), m(what_arg) {}
+
+    static std::string name(const std::string& ename, int id_) {
+        return "[json.exception." + ename + "." + std::to_string(id_) + "] ";
+    }
+
 private:
-    enum class value_type {
-        null, object, array, string, boolean, number_integer, number_float
+    std::runtime_error m;
+};
+
+class parse_error : public exception {
+public:
+    const std::size_t byte;
+
+    static parse_error create(int id_, std::size_t byte_, const std::string& what_arg) {
+        std::string w = exception::name("parse_error", id_) + "parse error at byte " +
+                        std::to_string(byte_) + ": " + what_arg;
+        return parse_error(id_, byte_, w);
+    }
+
+private:
+    parse_error(int id_, std::size_t byte_, const std::string& what_arg)
+        : exception(id_, what_arg), byte(byte_) {}
+};
+
+class type_error : public exception {
+public:
+    static type_error create(int id_, const std::string& what_arg) {
+        return type_error(id_, exception::name("type_error", id_) + what_arg);
+    }
+
+private:
+    type_error(int id_, const std::string& what_arg)
+        : exception(id_, what_arg) {}
+};
+
+class out_of_range : public exception {
+public:
+    static out_of_range create(int id_, const std::string& what_arg) {
+        return out_of_range(id_, exception::name("out_of_range", id_) + what_arg);
+    }
+
+private:
+    out_of_range(int id_, const std::string& what_arg)
+        : exception(id_, what_arg) {}
+};
+
+} // namespace detail
+
+// SAX interface, same shape as upstream nlohmann::json_sax. Every callback
+// returns false to abort parsing.
+template<typename BasicJsonType>
+struct json_sax {
+    using number_integer_t = typename BasicJsonType::number_integer_t;
+    using number_unsigned_t = typename BasicJsonType::number_unsigned_t;
+    using number_float_t = typename BasicJsonType::number_float_t;
+    using string_t = typename BasicJsonType::string_t;
+
+    virtual bool null() = 0;
+    virtual bool boolean(bool val) = 0;
+    virtual bool number_integer(number_integer_t val) = 0;
+    virtual bool number_unsigned(number_unsigned_t val) = 0;
+    virtual bool number_float(number_float_t val, const string_t& s) = 0;
+    virtual bool string(string_t& val) = 0;
+    virtual bool start_object(std::size_t elements) = 0;
+    virtual bool key(string_t& val) = 0;
+    virtual bool end_object() = 0;
+    virtual bool start_array(std::size_t elements) = 0;
+    virtual bool end_array() = 0;
+    virtual bool parse_error(std::size_t position,
+                             const std::string& last_token,
+                             const detail::exception& ex) = 0;
+
+    virtual ~json_sax() = default;
+};
+
+class json {
+public:
+    using number_integer_t = std::int64_t;
+    using number_unsigned_t = std::uint64_t;
+    using number_float_t = double;
+    using string_t = std::string;
+    using object_t = std::map<std::string, json>;
+    using array_t = std::vector<json>;
+
+    using exception = detail::exception;
+    using parse_error = detail::parse_error;
+    using type_error = detail::type_error;
+    using out_of_range = detail::out_of_range;
+
+    enum class value_t : std::uint8_t {
+        null, object, array, string, boolean,
+        number_integer, number_unsigned, number_float
     };
-    
-    value_type type = value_type::null;
-    std::map<std::string, json> object_value;
-    std::vector<json> array_value;
-    std::string string_value;
+
+private:
+    value_t type_ = value_t::null;
+    object_t object_value;
+    array_t array_value;
+    string_t string_value;
     bool bool_value = false;
-    long integer_value = 0;
-    double float_value = 0.0;
+    number_integer_t integer_value = 0;
+    number_unsigned_t unsigned_value = 0;
+    number_float_t float_value = 0.0;
+
+    template<typename T>
+    using enable_if_integer_t = typename std::enable_if<
+        std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type;
+
+    template<typename T>
+    using enable_if_float_t = typename std::enable_if<
+        std::is_floating_point<T>::value, int>::type;
 
 public:
     json() = default;
-    json(const char* val) : type(value_type::string), string_value(val) {}
-    json(const std::string& val) : type(value_type::string), string_value(val) {}
-    json(bool val) : type(value_type::boolean), bool_value(val) {}
-    json(int val) : type(value_type::number_integer), integer_value(val) {}
-    json(long val) : type(value_type::number_integer), integer_value(val) {}
-    json(double val) : type(value_type::number_float), float_value(val) {}
+    json(std::nullptr_t) {}
+    json(const char* val) : type_(value_t::string), string_value(val) {}
+    json(const string_t& val) : type_(value_t::string), string_value(val) {}
+    json(string_t&& val) : type_(value_t::string), string_value(std::move(val)) {}
+    json(bool val) : type_(value_t::boolean), bool_value(val) {}
+
+    template<typename T, enable_if_integer_t<T> = 0>
+    json(T val) {
+        if (std::is_signed<T>::value) {
+            type_ = value_t::number_integer;
+            integer_value = static_cast<number_integer_t>(val);
+        } else {
+            type_ = value_t::number_unsigned;
+            unsigned_value = static_cast<number_unsigned_t>(val);
+        }
+    }
+
+    template<typename T, enable_if_float_t<T> = 0>
+    json(T val) : type_(value_t::number_float), float_value(static_cast<double>(val)) {}
+
+    template<typename T>
+    json(const std::vector<T>& values) : type_(value_t::array) {
+        array_value.reserve(values.size());
+        for (const auto& v : values) {
+            array_value.emplace_back(v);
+        }
+    }
+
+    template<typename T>
+    json(const std::map<std::string, T>& values) : type_(value_t::object) {
+        for (const auto& [k, v] : values) {
+            object_value.emplace(k, json(v));
+        }
+    }
+
+    static json array() {
+        json j;
+        j.type_ = value_t::array;
+        return j;
+    }
+
+    static json object() {
+        json j;
+        j.type_ = value_t::object;
+        return j;
+    }
+
+    // Type inspection
+    value_t type() const { return type_; }
+    bool is_null() const { return type_ == value_t::null; }
+    bool is_object() const { return type_ == value_t::object; }
+    bool is_array() const { return type_ == value_t::array; }
+    bool is_string() const { return type_ == value_t::string; }
+    bool is_boolean() const { return type_ == value_t::boolean; }
+    bool is_number_integer() const {
+        return type_ == value_t::number_integer || type_ == value_t::number_unsigned;
+    }
+    bool is_number_unsigned() const { return type_ == value_t::number_unsigned; }
+    bool is_number_float() const { return type_ == value_t::number_float; }
+    bool is_number() const { return is_number_integer() || is_number_float(); }
+    bool is_primitive() const { return !is_object() && !is_array(); }
+
+    const char* type_name() const {
+        switch (type_) {
+            case value_t::null: return "null";
+            case value_t::object: return "object";
+            case value_t::array: return "array";
+            case value_t::string: return "string";
+            case value_t::boolean: return "boolean";
+            default: return "number";
+        }
+    }
 
     // Object access
-    json& operator[](const std::string& key) {
-        type = value_type::object;
+    json& operator[](const string_t& key) {
+        if (is_null()) {
+            type_ = value_t::object;
+        }
+        if (!is_object()) {
+            throw type_error::create(305, std::string("cannot use operator[] with a string argument with ") + type_name());
+        }
         return object_value[key];
     }
 
-    json& operator[](size_t index) {
-        type = value_type::array;
-        if (index >= array_value.size()) array_value.resize(index + 1);
+    const json& operator[](const string_t& key) const {
+        static const json null_value;
+        if (!is_object()) {
+            throw type_error::create(305, std::string("cannot use operator[] with a string argument with ") + type_name());
+        }
+        auto it = object_value.find(key);
+        return it != object_value.end() ? it->second : null_value;
+    }
+
+    // Template on T* so literal keys beat the built-in `int[ptr]` candidate
+    // and an index of 0 does not collide with a null pointer.
+    template<typename T>
+    json& operator[](T* key) {
+        return operator[](string_t(key));
+    }
+
+    template<typename T>
+    const json& operator[](T* key) const {
+        return operator[](string_t(key));
+    }
+
+    // Array access
+    json& operator[](std::size_t index) {
+        if (is_null()) {
+            type_ = value_t::array;
+        }
+        if (!is_array()) {
+            throw type_error::create(305, std::string("cannot use operator[] with a numeric argument with ") + type_name());
+        }
+        if (index >= array_value.size()) {
+            array_value.resize(index + 1);
+        }
+        return array_value[index];
+    }
+
+    const json& operator[](std::size_t index) const {
+        if (!is_array()) {
+            throw type_error::create(305, std::string("cannot use operator[] with a numeric argument with ") + type_name());
+        }
+        return array_value[index];
+    }
+
+    json& at(const string_t& key) {
+        return const_cast<json&>(static_cast<const json&>(*this).at(key));
+    }
+
+    const json& at(const string_t& key) const {
+        if (!is_object()) {
+            throw type_error::create(304, std::string("cannot use at() with ") + type_name());
+        }
+        auto it = object_value.find(key);
+        if (it == object_value.end()) {
+            throw out_of_range::create(403, "key '" + key + "' not found");
+        }
+        return it->second;
+    }
+
+    json& at(std::size_t index) {
+        return const_cast<json&>(static_cast<const json&>(*this).at(index));
+    }
+
+    const json& at(std::size_t index) const {
+        if (!is_array()) {
+            throw type_error::create(304, std::string("cannot use at() with ") + type_name());
+        }
+        if (index >= array_value.size()) {
+            throw out_of_range::create(401, "array index " + std::to_string(index) + " is out of range");
+        }
         return array_value[index];
     }
 
+    bool contains(const string_t& key) const {
+        return is_object() && object_value.find(key) != object_value.end();
+    }
+
     // Value getters
-    template<typename T> T value(const char* key, T default_val) const {
+    template<typename ValueType>
+    ValueType value(const string_t& key, const ValueType& default_value) const {
+        if (!is_object()) {
+            throw type_error::create(306, std::string("cannot use value() with ") + type_name());
+        }
         auto it = object_value.find(key);
-        return (it != object_value.end()) ? (T)it->second : default_val;
+        return it != object_value.end() ? it->second.template get<ValueType>() : default_value;
+    }
+
+    string_t value(const string_t& key, const char* default_value) const {
+        return value(key, string_t(default_value));
+    }
+
+    template<typename ValueType>
+    ValueType get() const {
+        using T = typename std::decay<ValueType>::type;
+
+        if constexpr (std::is_same<T, json>::value) {
+            return *this;
+        } else if constexpr (std::is_same<T, string_t>::value) {
+            if (!is_string()) {
+                throw type_error::create(302, std::string("type must be string, but is ") + type_name());
+            }
+            return string_value;
+        } else if constexpr (std::is_same<T, bool>::value) {
+            if (!is_boolean()) {
+                throw type_error::create(302, std::string("type must be boolean, but is ") + type_name());
+            }
+            return bool_value;
+        } else if constexpr (std::is_arithmetic<T>::value) {
+            switch (type_) {
+                case value_t::number_integer: return static_cast<T>(integer_value);
+                case value_t::number_unsigned: return static_cast<T>(unsigned_value);
+                case value_t::number_float: return static_cast<T>(float_value);
+                default:
+                    throw type_error::create(302, std::string("type must be number, but is ") + type_name());
+            }
+        } else {
+            static_assert(sizeof(T) == 0, "unsupported type for json::get");
+        }
     }
 
-    template<typename T> T value(const std::string& key, T default_val) const {
-        return value(key.c_str(), default_val);
+    template<typename T>
+    void get_to(std::vector<T>& out) const {
+        if (!is_array()) {
+            throw type_error::create(302, std::string("type must be array, but is ") + type_name());
+        }
+        out.clear();
+        out.reserve(array_value.size());
+        for (const auto& v : array_value) {
+            out.push_back(v.template get<T>());
+        }
     }
 
-    // Type checks
-    bool contains(const std::string& key) const { return object_value.count(key) > 0; }
-    bool is_array() const { return type == value_type::array; }
-    bool is_object() const { return type == value_type::object; }
-    bool is_string() const { return type == value_type::string; }
-    bool is_number() const { return type == value_type::number_integer || type == value_type::number_float; }
+    template<typename ValueType,
+             typename std::enable_if<std::is_same<ValueType, string_t>::value ||
+                                     std::is_arithmetic<ValueType>::value, int>::type = 0>
+    operator ValueType() const {
+        return get<ValueType>();
+    }
 
     // Size
-    size_t size() const {
-        switch(type) {
-            case value_type::object: return object_value.size();
-            case value_type::array: return array_value.size();
-            default: return 0;
-        }
-    }
-
-    // Conversion operators
-    operator std::string() const { return string_value; }
-    operator bool() const { return bool_value; }
-    operator int() const { return integer_value; }
-    operator long() const { return integer_value; }
-    operator double() const { return float_value; }
-
-    // Array iteration
-    auto begin() { return array_value.begin(); }
-    auto end() { return array_value.end(); }
-    auto begin() const { return array_value.begin(); }
-    auto end() const { return array_value.end(); }
-
-    // Static parse method
-    static json parse(const std::string& str) {
-        json result;
-        // Simple parser - handles basic objects and arrays
-        if (!str.empty() && str[0] == '{') {
-            result.type = value_type::object;
-            // Basic object parsing (simplified)
-        } else if (!str.empty() && str[0] == '[') {
-            result.type = value_type::array;
-            // Basic array parsing (simplified)
-        }
-        return result;
+    std::size_t size() const {
+        switch (type_) {
+            case value_t::null: return 0;
+            case value_t::object: return object_value.size();
+            case value_t::array: return array_value.size();
+            default: return 1;
+        }
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    void push_back(json val) {
+        if (is_null()) {
+            type_ = value_t::array;
+        }
+        if (!is_array()) {
+            throw type_error::create(308, std::string("cannot use push_back() with ") + type_name());
+        }
+        array_value.push_back(std::move(val));
+    }
+
+    // Array iteration (objects expose their members through items())
+    array_t::iterator begin() { return array_value.begin(); }
+    array_t::iterator end() { return array_value.end(); }
+    array_t::const_iterator begin() const { return array_value.begin(); }
+    array_t::const_iterator end() const { return array_value.end(); }
+
+    const object_t& items() const { return object_value; }
+
+    // Serialization
+    string_t dump(int indent = -1) const {
+        string_t out;
+        dump_to(out, indent, 0);
+        return out;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const json& j) {
+        return os << j.dump();
+    }
+
+    // Parsing
+    static json parse(const string_t& input);
+    static json parse(std::istream& input);
+    static bool accept(const string_t& input);
+
+    template<typename SAX>
+    static bool sax_parse(const string_t& input, SAX* sax);
+
+    friend std::istream& operator>>(std::istream& is, json& j) {
+        j = parse(is);
+        return is;
+    }
+
+private:
+    class sax_dom_parser;
+
+    template<typename SAX>
+    class parser;
+
+    static void dump_string(string_t& out, const string_t& s) {
+        static const char hex[] = "0123456789abcdef";
+        out += '"';
+        for (unsigned char c : s) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\b': out += "\\b"; break;
+                case '\f': out += "\\f"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (c < 0x20) {
+                        out += "\\u00";
+                        out += hex[c >> 4];
+                        out += hex[c & 0x0F];
+                    } else {
+                        out += static_cast<char>(c);
+                    }
+            }
+        }
+        out += '"';
+    }
+
+    static void dump_float(string_t& out, double value) {
+        if (!std::isfinite(value)) {
+            out += "null";
+            return;
+        }
+
+        // Shortest representation that round-trips; plain notation for
+        // moderate magnitudes so 100.0 prints as "100.0", not "1e+02".
+        char buf[32];
+        int precision = 1;
+        for (; precision <= 17; precision++) {
+            std::snprintf(buf, sizeof(buf), "%.*g", precision, value);
+            if (std::strtod(buf, nullptr) == value) {
+                break;
+            }
+        }
+
+        double magnitude = std::fabs(value);
+        if (magnitude >= 1.0 && magnitude < 1e15) {
+            int digits = static_cast<int>(std::log10(magnitude)) + 1;
+            if (digits > precision) {
+                std::snprintf(buf, sizeof(buf), "%.*g", digits, value);
+            }
+        }
+
+        string_t text(buf);
+        if (text.find_first_of(".eE") == string_t::npos) {
+            text += ".0";
+        }
+        out += text;
+    }
+
+    void dump_to(string_t& out, int indent, int level) const {
+        auto newline = [&](int lvl) {
+            if (indent >= 0) {
+                out += '\n';
+                out.append(static_cast<std::size_t>(indent * lvl), ' ');
+            }
+        };
+
+        switch (type_) {
+            case value_t::null:
+                out += "null";
+                break;
+            case value_t::boolean:
+                out += bool_value ? "true" : "false";
+                break;
+            case value_t::number_integer:
+                out += std::to_string(integer_value);
+                break;
+            case value_t::number_unsigned:
+                out += std::to_string(unsigned_value);
+                break;
+            case value_t::number_float:
+                dump_float(out, float_value);
+                break;
+            case value_t::string:
+                dump_string(out, string_value);
+                break;
+            case value_t::array: {
+                out += '[';
+                bool first = true;
+                for (const auto& v : array_value) {
+                    if (!first) out += ',';
+                    newline(level + 1);
+                    v.dump_to(out, indent, level + 1);
+                    first = false;
+                }
+                if (!array_value.empty()) newline(level);
+                out += ']';
+                break;
+            }
+            case value_t::object: {
+                out += '{';
+                bool first = true;
+                for (const auto& [k, v] : object_value) {
+                    if (!first) out += ',';
+                    newline(level + 1);
+                    dump_string(out, k);
+                    out += indent >= 0 ? ": " : ":";
+                    v.dump_to(out, indent, level + 1);
+                    first = false;
+                }
+                if (!object_value.empty()) newline(level);
+                out += '}';
+                break;
+            }
+        }
     }
 };
 
+// Recursive-descent parser over a complete buffer that reports everything it
+// reads to a SAX consumer.
+template<typename SAX>
+class json::parser {
+private:
+    const char* cur;
+    const char* begin;
+    const char* end;
+    SAX* sax;
+    string_t token;
+
+    std::size_t position() const {
+        return static_cast<std::size_t>(cur - begin);
+    }
+
+    bool fail(const std::string& message) {
+        auto ex = parse_error::create(101, position() + 1, "syntax error - " + message);
+        string_t last = cur < end ? string_t(1, *cur) : string_t("<end of input>");
+        sax->parse_error(position(), last, ex);
+        return false;
+    }
+
+    void skip_whitespace() {
+        while (cur < end && (*cur == ' ' || *cur == '\t' || *cur == '\n' || *cur == '\r')) {
+            ++cur;
+        }
+    }
+
+    bool expect_literal(const char* literal) {
+        for (const char* p = literal; *p; ++p, ++cur) {
+            if (cur >= end || *cur != *p) {
+                return fail(std::string("invalid literal; expected '") + literal + "'");
+            }
+        }
+        return true;
+    }
+
+    static void append_utf8(string_t& out, std::uint32_t cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool read_hex4(std::uint32_t& value) {
+        value = 0;
+        for (int i = 0; i < 4; i++, ++cur) {
+            if (cur >= end) return false;
+            char c = *cur;
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= static_cast<std::uint32_t>(c - '0');
+            else if (c >= 'a' && c <= 'f') value |= static_cast<std::uint32_t>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') value |= static_cast<std::uint32_t>(c - 'A' + 10);
+            else return false;
+        }
+        return true;
+    }
+
+    // Reads a string body into `token`; `cur` is on the opening quote.
+    bool read_string() {
+        token.clear();
+        ++cur;
+
+        while (true) {
+            const char* run = cur;
+            while (cur < end && *cur != '"' && *cur != '\\' &&
+                   static_cast<unsigned char>(*cur) >= 0x20) {
+                ++cur;
+            }
+            token.append(run, cur);
+
+            if (cur >= end) {
+                return fail("missing closing quote");
+            }
+
+            char c = *cur;
+            if (c == '"') {
+                ++cur;
+                return true;
+            }
+            if (c != '\\') {
+                return fail("control character must be escaped");
+            }
+
+            ++cur;
+            if (cur >= end) {
+                return fail("incomplete escape sequence");
+            }
+
+            switch (*cur++) {
+                case '"': token += '"'; break;
+                case '\\': token += '\\'; break;
+                case '/': token += '/'; break;
+                case 'b': token += '\b'; break;
+                case 'f': token += '\f'; break;
+                case 'n': token += '\n'; break;
+                case 'r': token += '\r'; break;
+                case 't': token += '\t'; break;
+                case 'u': {
+                    std::uint32_t cp = 0;
+                    if (!read_hex4(cp)) {
+                        return fail("'\\u' must be followed by 4 hex digits");
+                    }
+                    if (cp >= 0xD800 && cp <= 0xDBFF) {
+                        std::uint32_t low = 0;
+                        if (end - cur < 6 || cur[0] != '\\' || cur[1] != 'u') {
+                            return fail("surrogate U+D800..U+DBFF must be followed by U+DC00..U+DFFF");
+                        }
+                        cur += 2;
+                        if (!read_hex4(low) || low < 0xDC00 || low > 0xDFFF) {
+                            return fail("surrogate U+D800..U+DBFF must be followed by U+DC00..U+DFFF");
+                        }
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                        return fail("surrogate U+DC00..U+DFFF must follow U+D800..U+DBFF");
+                    }
+                    append_utf8(token, cp);
+                    break;
+                }
+                default:
+                    --cur;
+                    return fail("invalid escape sequence");
+            }
+        }
+    }
+
+    bool parse_number() {
+        const char* start = cur;
+        bool is_float = false;
+
+        if (cur < end && *cur == '-') ++cur;
+
+        if (cur < end && *cur == '0') {
+            ++cur;
+        } else if (cur < end && *cur >= '1' && *cur <= '9') {
+            while (cur < end && *cur >= '0' && *cur <= '9') ++cur;
+        } else {
+            return fail("invalid number");
+        }
+
+        if (cur < end && *cur == '.') {
+            is_float = true;
+            ++cur;
+            if (cur >= end || *cur < '0' || *cur > '9') {
+                return fail("invalid number; expected digit after '.'");
+            }
+            while (cur < end && *cur >= '0' && *cur <= '9') ++cur;
+        }
+
+        if (cur < end && (*cur == 'e' || *cur == 'E')) {
+            is_float = true;
+            ++cur;
+            if (cur < end && (*cur == '+' || *cur == '-')) ++cur;
+            if (cur >= end || *cur < '0' || *cur > '9') {
+                return fail("invalid number; expected digit after exponent");
+            }
+            while (cur < end && *cur >= '0' && *cur <= '9') ++cur;
+        }
+
+        token.assign(start, cur);
+
+        if (!is_float) {
+            errno = 0;
+            if (token[0] == '-') {
+                long long v = std::strtoll(token.c_str(), nullptr, 10);
+                if (errno != ERANGE) {
+                    return sax->number_integer(static_cast<number_integer_t>(v));
+                }
+            } else {
+                unsigned long long v = std::strtoull(token.c_str(), nullptr, 10);
+                if (errno != ERANGE) {
+                    return sax->number_unsigned(static_cast<number_unsigned_t>(v));
+                }
+            }
+        }
+
+        return sax->number_float(std::strtod(token.c_str(), nullptr), token);
+    }
+
+    bool parse_value() {
+        skip_whitespace();
+        if (cur >= end) {
+            return fail("unexpected end of input; expected value");
+        }
+
+        switch (*cur) {
+            case '{': {
+                ++cur;
+                if (!sax->start_object(static_cast<std::size_t>(-1))) return false;
+                skip_whitespace();
+                if (cur < end && *cur == '}') {
+                    ++cur;
+                    return sax->end_object();
+                }
+                while (true) {
+                    skip_whitespace();
+                    if (cur >= end || *cur != '"') {
+                        return fail("expected string literal for object key");
+                    }
+                    if (!read_string() || !sax->key(token)) return false;
+                    skip_whitespace();
+                    if (cur >= end || *cur != ':') {
+                        return fail("expected ':' after object key");
+                    }
+                    ++cur;
+                    if (!parse_value()) return false;
+                    skip_whitespace();
+                    if (cur < end && *cur == ',') {
+                        ++cur;
+                        continue;
+                    }
+                    if (cur < end && *cur == '}') {
+                        ++cur;
+                        return sax->end_object();
+                    }
+                    return fail("expected ',' or '}' in object");
+                }
+            }
+            case '[': {
+                ++cur;
+                if (!sax->start_array(static_cast<std::size_t>(-1))) return false;
+                skip_whitespace();
+                if (cur < end && *cur == ']') {
+                    ++cur;
+                    return sax->end_array();
+                }
+                while (true) {
+                    if (!parse_value()) return false;
+                    skip_whitespace();
+                    if (cur < end && *cur == ',') {
+                        ++cur;
+                        continue;
+                    }
+                    if (cur < end && *cur == ']') {
+                        ++cur;
+                        return sax->end_array();
+                    }
+                    return fail("expected ',' or ']' in array");
+                }
+            }
+            case '"':
+                return read_string() && sax->string(token);
+            case 't':
+                return expect_literal("true") && sax->boolean(true);
+            case 'f':
+                return expect_literal("false") && sax->boolean(false);
+            case 'n':
+                return expect_literal("null") && sax->null();
+            default:
+                return parse_number();
+        }
+    }
+
+public:
+    parser(const char* first, const char* last, SAX* handler)
+        : cur(first), begin(first), end(last), sax(handler) {}
+
+    bool parse() {
+        if (!parse_value()) {
+            return false;
+        }
+        skip_whitespace();
+        if (cur != end) {
+            return fail("unexpected trailing input");
+        }
+        return true;
+    }
+};
+
+// Builds a DOM from SAX events.
+class json::sax_dom_parser : public json_sax<json> {
+private:
+    json& root;
+    std::vector<json*> stack;
+    json* key_target = nullptr;
+    bool allow_exceptions;
+    bool errored = false;
+
+    json* place(json&& value) {
+        if (stack.empty()) {
+            root = std::move(value);
+            return &root;
+        }
+
+        json* parent = stack.back();
+        if (parent->is_array()) {
+            parent->array_value.push_back(std::move(value));
+            return &parent->array_value.back();
+        }
+
+        *key_target = std::move(value);
+        return key_target;
+    }
+
+public:
+    sax_dom_parser(json& result, bool exceptions)
+        : root(result), allow_exceptions(exceptions) {}
+
+    bool null() override { place(json()); return true; }
+    bool boolean(bool val) override { place(json(val)); return true; }
+    bool number_integer(number_integer_t val) override { place(json(val)); return true; }
+    bool number_unsigned(number_unsigned_t val) override { place(json(val)); return true; }
+    bool number_float(number_float_t val, const string_t&) override { place(json(val)); return true; }
+    bool string(string_t& val) override { place(json(std::move(val))); return true; }
+
+    bool start_object(std::size_t) override {
+        stack.push_back(place(json::object()));
+        return true;
+    }
+
+    bool key(string_t& val) override {
+        key_target = &stack.back()->object_value[val];
+        return true;
+    }
+
+    bool end_object() override {
+        stack.pop_back();
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        stack.push_back(place(json::array()));
+        return true;
+    }
+
+    bool end_array() override {
+        stack.pop_back();
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const detail::exception& ex) override {
+        errored = true;
+        if (allow_exceptions) {
+            throw *static_cast<const detail::parse_error*>(&ex);
+        }
+        return false;
+    }
+
+    bool is_errored() const { return errored; }
+};
+
+template<typename SAX>
+inline bool json::sax_parse(const string_t& input, SAX* sax) {
+    parser<SAX> p(input.data(), input.data() + input.size(), sax);
+    return p.parse();
+}
+
+inline json json::parse(const string_t& input) {
+    json result;
+    sax_dom_parser builder(result, true);
+    sax_parse(input, &builder);
+    return result;
+}
+
+inline json json::parse(std::istream& input) {
+    string_t buffer((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    return parse(buffer);
+}
+
+inline bool json::accept(const string_t& input) {
+    json ignored;
+    sax_dom_parser builder(ignored, false);
+    return sax_parse(input, &builder) && !builder.is_errored();
+}
+
 } // namespace nlohmann
 
 #endif